@@ -7,7 +7,9 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPath.h"
+#include "include/core/SkSurface.h"
 #include "tools/ToolUtils.h"
 
 enum Align {
@@ -24,13 +26,18 @@ class BigPathBench : public Benchmark {
     SkString    fName;
     Align       fAlign;
     bool        fRound;
+    bool        fFill;
 
 public:
-    BigPathBench(Align align, bool round) : fAlign(align), fRound(round) {
+    BigPathBench(Align align, bool round, bool fill = false)
+        : fAlign(align), fRound(round), fFill(fill) {
         fName.printf("bigpath_%s", gAlignName[fAlign]);
         if (round) {
             fName.append("_round");
         }
+        if (fill) {
+            fName.append("_fill");
+        }
     }
 
 protected:
@@ -47,8 +54,10 @@ protected:
     void onDraw(int loops, SkCanvas* canvas) override {
         SkPaint paint;
         paint.setAntiAlias(true);
-        paint.setStyle(SkPaint::kStroke_Style);
-        paint.setStrokeWidth(2);
+        if (!fFill) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeWidth(2);
+        }
         if (fRound) {
             paint.setStrokeJoin(SkPaint::kRound_Join);
         }
@@ -82,3 +91,56 @@ DEF_BENCH( return new BigPathBench(kRight_Align,    false); )
 DEF_BENCH( return new BigPathBench(kLeft_Align,     true); )
 DEF_BENCH( return new BigPathBench(kMiddle_Align,   true); )
 DEF_BENCH( return new BigPathBench(kRight_Align,    true); )
+
+// Filling the same complex path measures scan conversion rather than stroking.
+DEF_BENCH( return new BigPathBench(kLeft_Align,     false, true); )
+DEF_BENCH( return new BigPathBench(kMiddle_Align,   false, true); )
+DEF_BENCH( return new BigPathBench(kRight_Align,    false, true); )
+
+// Fills the big path, stretched over a 1024x1024 raster surface. With threads > 0 the surface is
+// a threaded one, which scan converts such a big path in bands concurrently; compare against the
+// threads == 0 variant, which scan converts it in one go.
+class BigPathThreadsBench : public Benchmark {
+public:
+    explicit BigPathThreadsBench(int threads)
+        : fThreads(threads)
+        , fName(SkStringPrintf("bigpath_fill_threads%d", threads)) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        ToolUtils::make_big_path(fPath);
+        fPath.transform(SkMatrix::MakeRectToRect(fPath.getBounds(), SkRect::MakeWH(1024, 1024),
+                                                 SkMatrix::kFill_ScaleToFit));
+
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(1024, 1024);
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+            fSurface = SkSurface::MakeRasterThreaded(info, fExecutor.get());
+        } else {
+            fSurface = SkSurface::MakeRaster(info);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < loops; i++) {
+            fSurface->getCanvas()->drawPath(fPath, paint);
+        }
+        fSurface->flushAndSubmit();
+    }
+
+private:
+    int                         fThreads;
+    SkString                    fName;
+    SkPath                      fPath;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkSurface>            fSurface;
+};
+
+DEF_BENCH( return new BigPathThreadsBench(0); )
+DEF_BENCH( return new BigPathThreadsBench(2); )
+DEF_BENCH( return new BigPathThreadsBench(4); )
+DEF_BENCH( return new BigPathThreadsBench(8); )
@@ -8,6 +8,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
 #include "include/utils/SkRandom.h"
@@ -101,3 +102,47 @@ DEF_BENCH(return new BlurBench(REAL, kOuter_SkBlurStyle);)
 DEF_BENCH(return new BlurBench(REAL, kInner_SkBlurStyle);)
 
 DEF_BENCH(return new BlurBench(0, kNormal_SkBlurStyle);)
+
+// Blurs a 256x256 star, which unlike an oval can't be drawn as a nine-patch, so each draw runs the
+// full mask blur at that sigma.
+class BlurSigmaBench : public Benchmark {
+    SkScalar fSigma;
+    SkString fName;
+    SkPath   fStar;
+
+public:
+    explicit BlurSigmaBench(SkScalar sigma) : fSigma(sigma) {
+        fName.printf("blur_sigma_%d", SkScalarRoundToInt(sigma));
+
+        const int kPoints = 11;
+        for (int i = 0; i < kPoints; i++) {
+            SkScalar angle = 2 * SK_ScalarPI * 5 * i / kPoints;
+            SkPoint p = {128 + 128 * SkScalarCos(angle), 128 + 128 * SkScalarSin(angle)};
+            i == 0 ? fStar.moveTo(p) : fStar.lineTo(p);
+        }
+        fStar.close();
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, fSigma));
+        for (int i = 0; i < loops; i++) {
+            canvas->drawPath(fStar, paint);
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new BlurSigmaBench(1);)
+DEF_BENCH(return new BlurSigmaBench(3);)
+DEF_BENCH(return new BlurSigmaBench(10);)
+DEF_BENCH(return new BlurSigmaBench(30);)
+DEF_BENCH(return new BlurSigmaBench(100);)
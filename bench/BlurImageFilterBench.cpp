@@ -8,9 +8,11 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/utils/SkRandom.h"
 
@@ -160,3 +162,54 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+// Sigmas from 1 to 100 on the large source, to compare the costs of the box blur across them.
+DEF_BENCH(return new BlurImageFilterBench(3, 3, false, false, false);)
+DEF_BENCH(return new BlurImageFilterBench(30, 30, false, false, false);)
+DEF_BENCH(return new BlurImageFilterBench(100, 100, false, false, false);)
+
+// Blurs a 1024x1024 checkerboard into a raster surface of the same size. With threads > 0 the
+// surface is a threaded one, whose blurs split their rows and columns across its executor;
+// compare against the threads == 0 variant, which blurs on the calling thread.
+class BlurImageFilterThreadsBench : public Benchmark {
+public:
+    explicit BlurImageFilterThreadsBench(int threads)
+        : fThreads(threads)
+        , fName(SkStringPrintf("blur_image_filter_threads%d", threads)) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fCheckerboard = make_checkerboard(1024, 1024);
+
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(1024, 1024);
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+            fSurface = SkSurface::MakeRasterThreaded(info, fExecutor.get());
+        } else {
+            fSurface = SkSurface::MakeRaster(info);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPaint paint;
+        paint.setImageFilter(SkImageFilters::Blur(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, nullptr));
+        for (int i = 0; i < loops; i++) {
+            fSurface->getCanvas()->drawBitmap(fCheckerboard, 0, 0, &paint);
+        }
+        fSurface->flushAndSubmit();
+    }
+
+private:
+    int                         fThreads;
+    SkString                    fName;
+    SkBitmap                    fCheckerboard;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkSurface>            fSurface;
+};
+
+DEF_BENCH(return new BlurImageFilterThreadsBench(0);)
+DEF_BENCH(return new BlurImageFilterThreadsBench(2);)
+DEF_BENCH(return new BlurImageFilterThreadsBench(4);)
+DEF_BENCH(return new BlurImageFilterThreadsBench(8);)
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "tools/Resources.h"
+
+// Times creating an SkCodec from a file and decoding it, with the file either
+// mmapped (SkStream::MakeFromFile, which the codecs decode from in place) or
+// read through an SkFILEStream (which the codecs copy through their own
+// buffers). Compare the two with nanobench's maxrss, or under strace -c to
+// count read syscalls:
+//   nanobench --match CodecStream_
+class CodecStreamBench : public Benchmark {
+public:
+    CodecStreamBench(const char* filename, bool mmap)
+        : fFilename(filename)
+        , fMmap(mmap)
+        , fName(SkStringPrintf("CodecStream_%s_%s", filename, mmap ? "mmap" : "file")) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fPath = GetResourcePath(fFilename);
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(this->openStream());
+        SkAssertResult(codec);
+        fBitmap.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                            .makeAlphaType(kPremul_SkAlphaType));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(this->openStream());
+            SkAssertResult(codec && SkCodec::kSuccess == codec->getPixels(fBitmap.pixmap()));
+        }
+    }
+
+private:
+    std::unique_ptr<SkStream> openStream() const {
+        if (fMmap) {
+            return SkStream::MakeFromFile(fPath.c_str());
+        }
+        return std::make_unique<SkFILEStream>(fPath.c_str());
+    }
+
+    const char* fFilename;
+    const bool  fMmap;
+    SkString    fName;
+    SkString    fPath;
+    SkBitmap    fBitmap;
+
+    typedef Benchmark INHERITED;
+};
+
+#define CODEC_STREAM_BENCHES(filename)                          \
+    DEF_BENCH(return new CodecStreamBench(filename, true);)    \
+    DEF_BENCH(return new CodecStreamBench(filename, false);)
+
+CODEC_STREAM_BENCHES("images/mandrill_512.png")
+CODEC_STREAM_BENCHES("images/mandrill_512_q075.jpg")
+CODEC_STREAM_BENCHES("images/baby_tux.webp")
+CODEC_STREAM_BENCHES("images/test640x479.gif")
+
+#undef CODEC_STREAM_BENCHES
@@ -7,6 +7,8 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -22,10 +24,20 @@
 class EncodeBench : public Benchmark {
 public:
     using Encoder = bool (*)(SkWStream*, const SkPixmap&);
-    EncodeBench(const char* filename, Encoder encoder, const char* encoderName)
+    using ThreadedEncoder = bool (*)(SkWStream*, const SkPixmap&, SkExecutor*);
+    // The source image is repeated |tiles| times in each direction, to bench large images.
+    EncodeBench(const char* filename, Encoder encoder, const char* encoderName, int tiles = 1)
         : fSourceFilename(filename)
         , fEncoder(encoder)
-        , fName(SkStringPrintf("Encode_%s_%s", filename, encoderName)) {}
+        , fTiles(tiles)
+        , fName(tiles > 1 ? SkStringPrintf("Encode_%s_x%d_%s", filename, tiles, encoderName)
+                          : SkStringPrintf("Encode_%s_%s", filename, encoderName)) {}
+    // A threaded encoder is handed a thread pool owned by the bench.
+    EncodeBench(const char* filename, ThreadedEncoder encoder, const char* encoderName,
+                int tiles = 1)
+        : EncodeBench(filename, (Encoder)nullptr, encoderName, tiles) {
+        fThreadedEncoder = encoder;
+    }
 
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
 
@@ -33,6 +45,21 @@ public:
 
     void onDelayedSetup() override {
         SkAssertResult(GetResourceAsBitmap(fSourceFilename, &fBitmap));
+        if (fTiles > 1) {
+            SkBitmap tiled;
+            tiled.allocPixels(fBitmap.info().makeWH(fBitmap.width()  * fTiles,
+                                                    fBitmap.height() * fTiles));
+            SkCanvas canvas(tiled);
+            for (int y = 0; y < fTiles; y++) {
+                for (int x = 0; x < fTiles; x++) {
+                    canvas.drawBitmap(fBitmap, x * fBitmap.width(), y * fBitmap.height());
+                }
+            }
+            fBitmap = tiled;
+        }
+        if (fThreadedEncoder) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
@@ -40,7 +67,8 @@ public:
             SkPixmap pixmap;
             SkAssertResult(fBitmap.peekPixels(&pixmap));
             SkNullWStream dst;
-            SkAssertResult(fEncoder(&dst, pixmap));
+            SkAssertResult(fThreadedEncoder ? fThreadedEncoder(&dst, pixmap, fExecutor.get())
+                                            : fEncoder(&dst, pixmap));
             SkASSERT(dst.bytesWritten() > 0);
         }
     }
@@ -48,8 +76,11 @@ public:
 private:
     const char* fSourceFilename;
     Encoder     fEncoder;
+    ThreadedEncoder fThreadedEncoder = nullptr;
+    int         fTiles;
     SkString    fName;
     SkBitmap    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
 };
 
 static bool encode_jpeg(SkWStream* dst, const SkPixmap& src) {
@@ -85,6 +116,29 @@ static bool encode_png(SkWStream* dst,
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
+static bool encode_png_fast_filters(SkWStream* dst, const SkPixmap& src, int zlibLevel) {
+    SkPngEncoder::Options opts;
+    opts.fZLibLevel = zlibLevel;
+    opts.fFastFilterSelection = true;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
+#define PNG_FAST(ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
+           return encode_png_fast_filters(d, s, ZLIBLEVEL); }
+
+static bool encode_png_threaded(SkWStream* dst,
+                                const SkPixmap& src,
+                                SkExecutor* executor,
+                                int zlibLevel) {
+    SkPngEncoder::Options opts;
+    opts.fZLibLevel = zlibLevel;
+    opts.fExecutor = executor;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
+#define PNG_MT(ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s, SkExecutor* e) { \
+           return encode_png_threaded(d, s, e, ZLIBLEVEL); }
+
 static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
@@ -122,4 +176,21 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+// kAll, but with each row's filter picked by Skia from a sample of the row.
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_FAST(6), "PNG_fast"));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_FAST(1), "PNG_1_fast"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_FAST(6), "PNG_fast"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_FAST(1), "PNG_1_fast"));
+
+// Large images, where splitting rows across threads pays off.
+DEF_BENCH(return new EncodeBench(srcs[0], PNG(kAll, 6), "PNG", 4));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG(kAll, 1), "PNG_1", 4));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_MT(6), "PNG_MT", 4));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_MT(1), "PNG_1_MT", 4));
+
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_MT(6), "PNG_MT"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_MT(6), "PNG_MT"));
+
+#undef PNG_MT
+#undef PNG_FAST
 #undef PNG
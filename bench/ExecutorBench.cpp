@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <atomic>
+
+// Fans out many tiny tasks with SkTaskGroup::batch(), the pattern that makes a single shared
+// work list a contention point.
+class ExecutorBatchBench : public Benchmark {
+public:
+    enum class Pool { kFIFO, kLIFO, kWorkStealing };
+
+    ExecutorBatchBench(Pool pool, int tasks) : fPool(pool), fTasks(tasks) {
+        static const char* kNames[] = { "fifo", "lifo", "workstealing" };
+        fName.printf("executor_batch_%s_%d", kNames[(int)pool], tasks);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        switch (fPool) {
+            case Pool::kFIFO:         fExecutor = SkExecutor::MakeFIFOThreadPool();         break;
+            case Pool::kLIFO:         fExecutor = SkExecutor::MakeLIFOThreadPool();         break;
+            case Pool::kWorkStealing: fExecutor = SkExecutor::MakeWorkStealingThreadPool(); break;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkTaskGroup tasks(*fExecutor);
+            tasks.batch(fTasks, [this](int j) {
+                fSum.fetch_add(j, std::memory_order_relaxed);
+            });
+            tasks.wait();
+        }
+    }
+
+private:
+    const Pool                  fPool;
+    const int                   fTasks;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::atomic<int>            fSum{0};
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new ExecutorBatchBench(ExecutorBatchBench::Pool::kFIFO,         100); )
+DEF_BENCH( return new ExecutorBatchBench(ExecutorBatchBench::Pool::kLIFO,         100); )
+DEF_BENCH( return new ExecutorBatchBench(ExecutorBatchBench::Pool::kWorkStealing, 100); )
+DEF_BENCH( return new ExecutorBatchBench(ExecutorBatchBench::Pool::kFIFO,         10000); )
+DEF_BENCH( return new ExecutorBatchBench(ExecutorBatchBench::Pool::kLIFO,         10000); )
+DEF_BENCH( return new ExecutorBatchBench(ExecutorBatchBench::Pool::kWorkStealing, 10000); )
@@ -11,8 +11,14 @@
 #include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkString.h"
+#include "include/core/SkTypeface.h"
 #include "include/private/SkChecksum.h"
 #include "include/private/SkTemplates.h"
+#include "include/utils/SkRandom.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeSpec.h"
+#include "tools/Resources.h"
+#include "tools/ToolUtils.h"
 
 #include "bench/gUniqueGlyphIDs.h"
 
@@ -197,3 +203,67 @@ private:
 };
 DEF_BENCH( return new FontPathBench(true); )
 DEF_BENCH( return new FontPathBench(false); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Prepares the images for a long run of mostly distinct glyphs, like a page of CJK text, in a
+// strike that starts out empty. The glyphs are asked for one at a time, or as a single batch.
+class FontCachePrepareImagesBench : public Benchmark {
+    static constexpr int kRunLength = 1024;
+
+    const bool fBatch;
+    std::unique_ptr<SkStrikeSpec> fStrikeSpec;
+    SkPackedGlyphID fPackedIDs[kRunLength];
+    const SkGlyph* fGlyphs[kRunLength];
+
+public:
+    FontCachePrepareImagesBench(bool batch) : fBatch(batch) {}
+
+protected:
+    const char* onGetName() override {
+        return fBatch ? "fontcache_prepare_images_batch"
+                      : "fontcache_prepare_images_glyph_by_glyph";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+        if (!typeface) {
+            typeface = ToolUtils::create_portable_typeface();
+        }
+        SkFont font(typeface, 24);
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        fStrikeSpec = std::make_unique<SkStrikeSpec>(SkStrikeSpec::MakeMask(
+                font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I()));
+
+        // Most glyphs appear once or twice, as in running CJK text.
+        SkRandom random;
+        uint32_t glyphCount = std::max(typeface->countGlyphs() - 1, 1);
+        for (SkPackedGlyphID& packedID : fPackedIDs) {
+            packedID = SkPackedGlyphID{SkTo<SkGlyphID>(1 + random.nextULessThan(glyphCount))};
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkStrikeCache cache;
+            sk_sp<SkStrike> strike = fStrikeSpec->findOrCreateStrike(&cache);
+            if (fBatch) {
+                strike->prepareImages(SkMakeSpan(fPackedIDs), fGlyphs);
+            } else {
+                for (int j = 0; j < kRunLength; j++) {
+                    strike->prepareImages(SkMakeSpan(&fPackedIDs[j], 1), &fGlyphs[j]);
+                }
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+DEF_BENCH( return new FontCachePrepareImagesBench(false); )
+DEF_BENCH( return new FontCachePrepareImagesBench(true); )
@@ -9,6 +9,7 @@
 
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkStream.h"
@@ -154,14 +155,16 @@ private:
 };
 
 /** Test calling DEFLATE on a 78k PDF command stream. Used for measuring
-    alternate zlib settings, usage, and library versions. */
+    alternate zlib settings, usage, and library versions.  Bytes/sec is the
+    stream length over the time per loop. */
 class PDFCompressionBench : public Benchmark {
 public:
-    PDFCompressionBench() {}
+    using Level = SkPDF::Metadata::CompressionLevel;
+    PDFCompressionBench(Level level, const char* name) : fLevel(level), fName(name) {}
     ~PDFCompressionBench() override {}
 
 protected:
-    const char* onGetName() override { return "PDFCompression"; }
+    const char* onGetName() override { return fName; }
     bool isSuitableFor(Backend backend) override {
         return backend == kNonRendering_Backend;
     }
@@ -171,15 +174,19 @@ protected:
     void onDraw(int loops, SkCanvas*) override {
         SkASSERT(fAsset);
         if (!fAsset) { return; }
+        SkPDF::Metadata metadata;
+        metadata.fCompressionLevel = fLevel;
         while (loops-- > 0) {
             SkNullWStream wStream;
-            SkPDFDocument doc(&wStream, SkPDF::Metadata());
+            SkPDFDocument doc(&wStream, metadata);
             doc.beginPage(256, 256);
             (void)SkPDFStreamOut(nullptr, fAsset->duplicate(), &doc, true);
        }
     }
 
 private:
+    Level fLevel;
+    const char* fName;
     std::unique_ptr<SkStreamAsset> fAsset;
 };
 
@@ -301,14 +308,88 @@ struct PDFClipPathBenchmark : public Benchmark {
     }
 };
 
+/** Page throughput of a multi-page report: text, vector art and a distinct image on every
+    page. Each loop writes kPageCount pages, so pages/sec is kPageCount / (time per loop).
+    Compare the serial and threaded cases to see how well the executor pipelines content
+    stream compression, image encoding and font subsetting. */
+class PDFPagesBench : public Benchmark {
+public:
+    PDFPagesBench(bool threaded) : fThreaded(threaded) {}
+
+protected:
+    static constexpr int kPageCount = 32;
+
+    const char* onGetName() override {
+        return fThreaded ? "PDFPages_threaded" : "PDFPages_serial";
+    }
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+    void onDelayedSetup() override {
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+        }
+        SkRandom random;
+        for (int i = 0; i < kPageCount; ++i) {
+            SkAutoPixmapStorage pixmap;
+            pixmap.alloc(SkImageInfo::MakeN32Premul(128, 128));
+            for (int y = 0; y < pixmap.height(); ++y) {
+                for (int x = 0; x < pixmap.width(); ++x) {
+                    *pixmap.writable_addr32(x, y) = random.nextU() | 0xFF000000;
+                }
+            }
+            fImages.push_back(SkImage::MakeRasterCopy(pixmap));
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        SkFont font;
+        font.setSize(10);
+        SkPaint paint;
+        paint.setStyle(SkPaint::kStroke_Style);
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            SkPDF::Metadata metadata;
+            metadata.fExecutor = fExecutor.get();
+            SkPDFDocument doc(&wStream, metadata);
+            for (int page = 0; page < kPageCount; ++page) {
+                SkCanvas* canvas = doc.beginPage(612, 792);
+                for (int line = 0; line < 60; ++line) {
+                    canvas->drawString("The quick brown fox jumps over the lazy dog.",
+                                       36, 36 + 12 * line, font, SkPaint());
+                }
+                for (int i = 0; i < 100; ++i) {
+                    canvas->drawCircle(400 + i, 500, 50 + i * 0.5f, paint);
+                }
+                canvas->drawImage(fImages[page], 400, 36);
+                doc.endPage();
+            }
+            doc.close();
+        }
+    }
+
+private:
+    bool fThreaded;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::vector<sk_sp<SkImage>> fImages;
+};
+
 }  // namespace
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
-DEF_BENCH(return new PDFCompressionBench;)
+DEF_BENCH(return new PDFCompressionBench(PDFCompressionBench::Level::Default,
+                                         "PDFCompression");)
+DEF_BENCH(return new PDFCompressionBench(PDFCompressionBench::Level::LowButFast,
+                                         "PDFCompression_LowButFast");)
+DEF_BENCH(return new PDFCompressionBench(PDFCompressionBench::Level::Average,
+                                         "PDFCompression_Average");)
+DEF_BENCH(return new PDFCompressionBench(PDFCompressionBench::Level::HighButSlow,
+                                         "PDFCompression_HighButSlow");)
 DEF_BENCH(return new PDFColorComponentBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
 DEF_BENCH(return new PDFClipPathBenchmark;)
+DEF_BENCH(return new PDFPagesBench(false);)
+DEF_BENCH(return new PDFPagesBench(true);)
 
 #ifdef SK_PDF_ENABLE_SLOW_TESTS
 #include "include/core/SkExecutor.h"
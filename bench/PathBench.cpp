@@ -225,6 +225,26 @@ private:
     typedef PathBench INHERITED;
 };
 
+// Test Analytic AA coverage accumulation for complex paths whose contours overlap
+class AAAOverlapPathBench : public PathBench {
+public:
+    AAAOverlapPathBench(Flags flags) : INHERITED(flags) {}
+
+    void appendName(SkString* name) override {
+        name->append("overlap_aaa");
+    }
+
+    void makePath(SkPath* path) override {
+        for (int i = 0; i < 8; i++) {
+            path->addCircle(10 + 5 * i, 20 + 2 * (i & 1), 8);
+        }
+        path->addRect(SkRect::MakeLTRB(5, 15, 55, 25));
+    }
+
+private:
+    typedef PathBench INHERITED;
+};
+
 class SawToothPathBench : public PathBench {
 public:
     SawToothPathBench(Flags flags) : INHERITED(flags) {}
@@ -704,6 +724,58 @@ private:
 };
 
 
+// Draws a small set of icon- or glyph-sized paths over and over at scattered positions. Unless
+// the paths are volatile, their coverage masks come from the cache after the first few draws.
+class PathIconsBench : public Benchmark {
+public:
+    PathIconsBench(bool isVolatile) : fVolatile(isVolatile) {
+        fName.printf("path_icons_%s", isVolatile ? "volatile" : "cached");
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        SkRandom rand;
+        for (SkPath& path : fPaths) {
+            // A star with a hole in it, about 24 pixels across.
+            const int points = 5 + rand.nextULessThan(6);
+            for (int i = 0; i < 2 * points; i++) {
+                SkScalar angle  = i * SK_ScalarPI / points,
+                         radius = (i & 1) ? rand.nextRangeScalar(5, 8) : 12;
+                SkPoint pt = {12 + radius * SkScalarCos(angle), 12 + radius * SkScalarSin(angle)};
+                i == 0 ? path.moveTo(pt) : path.lineTo(pt);
+            }
+            path.close();
+            path.addCircle(12, 12, 3, SkPathDirection::kCCW);
+            path.setIsVolatile(fVolatile);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        SkRandom rand;
+        for (int i = 0; i < loops; ++i) {
+            canvas->save();
+            canvas->translate(rand.nextUScalar1() * 600, rand.nextUScalar1() * 440);
+            canvas->drawPath(fPaths[i % kPathCount], paint);
+            canvas->restore();
+        }
+    }
+
+private:
+    static constexpr int kPathCount = 16;
+
+    SkString    fName;
+    bool        fVolatile;
+    SkPath      fPaths[kPathCount];
+
+    typedef Benchmark INHERITED;
+};
+
 // Chrome creates its own round rects with each corner possibly being different.
 // In its "zero radius" incarnation it creates degenerate round rects.
 // Note: PathTest::test_arb_round_rect_is_convex and
@@ -1146,6 +1218,8 @@ DEF_BENCH( return new AAAConcavePathBench(FLAGS00); )
 DEF_BENCH( return new AAAConcavePathBench(FLAGS10); )
 DEF_BENCH( return new AAAConvexPathBench(FLAGS00); )
 DEF_BENCH( return new AAAConvexPathBench(FLAGS10); )
+DEF_BENCH( return new AAAOverlapPathBench(FLAGS00); )
+DEF_BENCH( return new AAAOverlapPathBench(FLAGS10); )
 
 DEF_BENCH( return new SawToothPathBench(FLAGS00); )
 DEF_BENCH( return new SawToothPathBench(FLAGS01); )
@@ -1169,6 +1243,8 @@ DEF_BENCH( return new SkBench_AddPathTest(SkBench_AddPathTest::kReversePathTo_Ad
 
 DEF_BENCH( return new CirclesBench(FLAGS00); )
 DEF_BENCH( return new CirclesBench(FLAGS01); )
+DEF_BENCH( return new PathIconsBench(false); )
+DEF_BENCH( return new PathIconsBench(true); )
 DEF_BENCH( return new ArbRoundRectBench(false); )
 DEF_BENCH( return new ArbRoundRectBench(true); )
 DEF_BENCH( return new ConservativelyContainsBench(ConservativelyContainsBench::kRect_Type); )
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkString.h"
+#include "include/utils/SkRandom.h"
+
+// Times loading a serialized picture and drawing it once, as a renderer of cached .skps would,
+// either with SkPicture::MakeFromData(), which re-records the picture, or with
+// SkPicture::MakeFromMappedData(), which plays it back in place from the serialized data.
+class PictureLoadBench : public Benchmark {
+public:
+    explicit PictureLoadBench(bool mapped)
+        : fMapped(mapped)
+        , fName(SkStringPrintf("picture_load_%s", mapped ? "mapped" : "copied")) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(1024, 1024);
+            SkRandom rand;
+            for (int i = 0; i < 20000; i++) {
+                SkPaint paint;
+                paint.setColor(rand.nextU());
+                paint.setAntiAlias(true);
+                const SkRect r = SkRect::MakeXYWH(rand.nextRangeScalar(0, 1024),
+                                                  rand.nextRangeScalar(0, 1024),
+                                                  rand.nextRangeScalar(0, 64),
+                                                  rand.nextRangeScalar(0, 64));
+                if (i % 4) {
+                    canvas->drawRect(r, paint);
+                } else {
+                    SkPath path;
+                    path.addOval(r);
+                    canvas->drawPath(path, paint);
+                }
+            }
+        fData = recorder.finishRecordingAsPicture()->serialize();
+
+        // Small, so that drawing doesn't swamp loading.
+        fBitmap.allocN32Pixels(64, 64);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas canvas(fBitmap);
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkPicture> picture = fMapped ? SkPicture::MakeFromMappedData(fData)
+                                               : SkPicture::MakeFromData(fData.get());
+            canvas.drawPicture(picture);
+        }
+    }
+
+private:
+    bool          fMapped;
+    SkString      fName;
+    sk_sp<SkData> fData;
+    SkBitmap      fBitmap;
+};
+
+DEF_BENCH( return new PictureLoadBench(true ); )
+DEF_BENCH( return new PictureLoadBench(false); )
@@ -5,8 +5,11 @@
  * found in the LICENSE file.
  */
 #include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
@@ -95,3 +98,169 @@ DEF_BENCH( return new TiledPlaybackBench(kNone,     kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kNone,     kTiled ); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kTiled ); )
+
+// Draws a whole picture into a raster target with SkPicture::playbackTiled(), splitting the
+// target into 256x256 tiles. With threads > 0 the tiles are drawn concurrently; compare against
+// the threads == 0 variant, which draws the same tiles one after another.
+class ParallelPlaybackBench : public Benchmark {
+public:
+    explicit ParallelPlaybackBench(int threads)
+        : fThreads(threads)
+        , fName(SkStringPrintf("parallel_playback_threads%d", threads)) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(1024, 1024, &factory);
+            SkRandom rand;
+            for (int i = 0; i < 10000; i++) {
+                SkScalar x = rand.nextRangeScalar(0, 1024),
+                         y = rand.nextRangeScalar(0, 1024),
+                         w = rand.nextRangeScalar(0, 128),
+                         h = rand.nextRangeScalar(0, 128);
+                SkPaint paint;
+                paint.setColor(rand.nextU());
+                paint.setAntiAlias(true);
+                canvas->drawOval(SkRect::MakeXYWH(x,y,w,h), paint);
+            }
+        fPic = recorder.finishRecordingAsPicture();
+
+        fBitmap.allocN32Pixels(1024, 1024);
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            fBitmap.eraseColor(SK_ColorWHITE);
+            SkAssertResult(fPic->playbackTiled(fBitmap.pixmap(), nullptr, fExecutor.get()));
+        }
+    }
+
+private:
+    int                         fThreads;
+    SkString                    fName;
+    sk_sp<SkPicture>            fPic;
+    SkBitmap                    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH( return new ParallelPlaybackBench(0); )
+DEF_BENCH( return new ParallelPlaybackBench(2); )
+DEF_BENCH( return new ParallelPlaybackBench(4); )
+DEF_BENCH( return new ParallelPlaybackBench(8); )
+
+// Plays back a grid of sprites drawn with drawImageRect(). When batched, the picture is recorded
+// with kBatchDraws_RecordFlag, which merges the sprites into image sets; otherwise each one stays
+// a separate DrawImageRect.
+class SpritePlaybackBench : public Benchmark {
+public:
+    explicit SpritePlaybackBench(bool batched)
+        : fBatched(batched)
+        , fName(SkStringPrintf("sprite_playback_%s", batched ? "batched" : "unbatched")) {}
+
+    const char* onGetName() override { return fName.c_str(); }
+    SkIPoint onGetSize() override { return { 1024, 1024 }; }
+
+    void onDelayedSetup() override {
+        SkBitmap atlas;
+        atlas.allocN32Pixels(256, 256);
+        SkRandom rand;
+        for (int y = 0; y < 256; y += 16)
+        for (int x = 0; x < 256; x += 16) {
+            atlas.erase(rand.nextU() | 0xFF000000, SkIRect::MakeXYWH(x, y, 16, 16));
+        }
+        sk_sp<SkImage> image = SkImage::MakeFromBitmap(atlas);
+
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(
+                SkRect::MakeWH(1024, 1024), nullptr,
+                fBatched ? SkPictureRecorder::kBatchDraws_RecordFlag : 0);
+            for (int y = 0; y < 1024; y += 16)
+            for (int x = 0; x < 1024; x += 16) {
+                SkPaint paint;
+                const SkRect src = SkRect::MakeXYWH(rand.nextULessThan(16) * 16,
+                                                    rand.nextULessThan(16) * 16, 16, 16);
+                canvas->drawImageRect(image, src, SkRect::MakeXYWH(x, y, 16, 16), &paint);
+            }
+        fPic = recorder.finishRecordingAsPicture();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            fPic->playback(canvas);
+        }
+    }
+
+private:
+    bool             fBatched;
+    SkString         fName;
+    sk_sp<SkPicture> fPic;
+};
+
+DEF_BENCH( return new SpritePlaybackBench(true ); )
+DEF_BENCH( return new SpritePlaybackBench(false); )
+
+// Redraws a picture over the previous frame, a re-recording of it with one oval recolored.
+// With damage, only that oval's bounds are cleared and redrawn with SkPicture::playbackDamage();
+// otherwise the whole frame is cleared and redrawn.
+class DamagePlaybackBench : public Benchmark {
+public:
+    explicit DamagePlaybackBench(bool damage)
+        : fDamage(damage)
+        , fName(SkStringPrintf("damage_playback_%s", damage ? "partial" : "full")) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        auto record = [](SkColor changed) {
+            SkRTreeFactory factory;
+            SkPictureRecorder recorder;
+            SkCanvas* canvas = recorder.beginRecording(1024, 1024, &factory);
+                SkRandom rand;
+                for (int i = 0; i < 10000; i++) {
+                    SkScalar x = rand.nextRangeScalar(0, 1024),
+                             y = rand.nextRangeScalar(0, 1024),
+                             w = rand.nextRangeScalar(0, 128),
+                             h = rand.nextRangeScalar(0, 128);
+                    SkPaint paint;
+                    paint.setColor(i == 5000 ? changed : rand.nextU());
+                    paint.setAntiAlias(true);
+                    canvas->drawOval(SkRect::MakeXYWH(x,y,w,h), paint);
+                }
+            return recorder.finishRecordingAsPicture();
+        };
+        fPrevious = record(SK_ColorBLUE);
+        fPic      = record(SK_ColorRED);
+
+        fBitmap.allocN32Pixels(1024, 1024);
+        fBitmap.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas(fBitmap).drawPicture(fPrevious);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            if (fDamage) {
+                fPic->playbackDamage(fBitmap.pixmap(), nullptr, *fPrevious);
+            } else {
+                fBitmap.eraseColor(SK_ColorTRANSPARENT);
+                SkCanvas(fBitmap).drawPicture(fPic);
+            }
+        }
+    }
+
+private:
+    bool             fDamage;
+    SkString         fName;
+    sk_sp<SkPicture> fPrevious,
+                     fPic;
+    SkBitmap         fBitmap;
+};
+
+DEF_BENCH( return new DamagePlaybackBench(true ); )
+DEF_BENCH( return new DamagePlaybackBench(false); )
@@ -9,21 +9,31 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkString.h"
 #include "include/utils/SkRandom.h"
+#include "src/core/SkPackedRTree.h"
 #include "src/core/SkRTree.h"
 
 // confine rectangles to a smallish area, so queries generally hit something, and overlap occurs:
 static const SkScalar GENERATE_EXTENTS = 1000.0f;
 static const int NUM_BUILD_RECTS = 500;
 static const int NUM_QUERY_RECTS = 5000;
+static const int NUM_LARGE_RECTS = 200000;  // Like an SKP with a couple hundred thousand ops.
 static const int GRID_WIDTH = 100;
 
 typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
 
+static const char* tree_name(const SkRTree*)       { return "rtree"; }
+static const char* tree_name(const SkPackedRTree*) { return "packedrtree"; }
+
 // Time how long it takes to build an R-Tree.
+template <typename Tree>
 class RTreeBuildBench : public Benchmark {
 public:
-    RTreeBuildBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_build", name);
+    RTreeBuildBench(const char* name, MakeRectProc proc, int numRects = NUM_BUILD_RECTS)
+            : fProc(proc), fNumRects(numRects) {
+        fName.printf("%s_%s_build", tree_name((Tree*)nullptr), name);
+        if (numRects != NUM_BUILD_RECTS) {
+            fName.appendf("_%d", numRects);
+        }
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -36,28 +46,34 @@ protected:
     }
     void onDraw(int loops, SkCanvas* canvas) override {
         SkRandom rand;
-        SkAutoTMalloc<SkRect> rects(NUM_BUILD_RECTS);
-        for (int i = 0; i < NUM_BUILD_RECTS; ++i) {
-            rects[i] = fProc(rand, i, NUM_BUILD_RECTS);
+        SkAutoTMalloc<SkRect> rects(fNumRects);
+        for (int i = 0; i < fNumRects; ++i) {
+            rects[i] = fProc(rand, i, fNumRects);
         }
 
         for (int i = 0; i < loops; ++i) {
-            SkRTree tree;
-            tree.insert(rects.get(), NUM_BUILD_RECTS);
+            Tree tree;
+            tree.insert(rects.get(), fNumRects);
             SkASSERT(rects != nullptr);  // It'd break this bench if the tree took ownership of rects.
         }
     }
 private:
     MakeRectProc fProc;
+    int fNumRects;
     SkString fName;
     typedef Benchmark INHERITED;
 };
 
 // Time how long it takes to perform queries on an R-Tree.
+template <typename Tree>
 class RTreeQueryBench : public Benchmark {
 public:
-    RTreeQueryBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_query", name);
+    RTreeQueryBench(const char* name, MakeRectProc proc, int numRects = NUM_QUERY_RECTS)
+            : fProc(proc), fNumRects(numRects) {
+        fName.printf("%s_%s_query", tree_name((Tree*)nullptr), name);
+        if (numRects != NUM_QUERY_RECTS) {
+            fName.appendf("_%d", numRects);
+        }
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -69,11 +85,11 @@ protected:
     }
     void onDelayedSetup() override {
         SkRandom rand;
-        SkAutoTMalloc<SkRect> rects(NUM_QUERY_RECTS);
-        for (int i = 0; i < NUM_QUERY_RECTS; ++i) {
-            rects[i] = fProc(rand, i, NUM_QUERY_RECTS);
+        SkAutoTMalloc<SkRect> rects(fNumRects);
+        for (int i = 0; i < fNumRects; ++i) {
+            rects[i] = fProc(rand, i, fNumRects);
         }
-        fTree.insert(rects.get(), NUM_QUERY_RECTS);
+        fTree.insert(rects.get(), fNumRects);
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -89,8 +105,9 @@ protected:
         }
     }
 private:
-    SkRTree fTree;
+    Tree fTree;
     MakeRectProc fProc;
+    int fNumRects;
     SkString fName;
     typedef Benchmark INHERITED;
 };
@@ -127,12 +144,20 @@ static inline SkRect make_concentric_rects(SkRandom&, int index, int numRects) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DEF_BENCH(return new RTreeBuildBench("XY", &make_XYordered_rects));
-DEF_BENCH(return new RTreeBuildBench("YX", &make_YXordered_rects));
-DEF_BENCH(return new RTreeBuildBench("random", &make_random_rects));
-DEF_BENCH(return new RTreeBuildBench("concentric", &make_concentric_rects));
-
-DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
-DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
-DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
-DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+#define RTREE_BENCHES(Tree)                                                                       \
+    DEF_BENCH(return new RTreeBuildBench<Tree>("XY", &make_XYordered_rects);)                     \
+    DEF_BENCH(return new RTreeBuildBench<Tree>("YX", &make_YXordered_rects);)                     \
+    DEF_BENCH(return new RTreeBuildBench<Tree>("random", &make_random_rects);)                    \
+    DEF_BENCH(return new RTreeBuildBench<Tree>("concentric", &make_concentric_rects);)            \
+    DEF_BENCH(return new RTreeBuildBench<Tree>("random", &make_random_rects, NUM_LARGE_RECTS);)   \
+                                                                                                  \
+    DEF_BENCH(return new RTreeQueryBench<Tree>("XY", &make_XYordered_rects);)                     \
+    DEF_BENCH(return new RTreeQueryBench<Tree>("YX", &make_YXordered_rects);)                     \
+    DEF_BENCH(return new RTreeQueryBench<Tree>("random", &make_random_rects);)                    \
+    DEF_BENCH(return new RTreeQueryBench<Tree>("concentric", &make_concentric_rects);)            \
+    DEF_BENCH(return new RTreeQueryBench<Tree>("random", &make_random_rects, NUM_LARGE_RECTS);)
+
+RTREE_BENCHES(SkRTree)
+RTREE_BENCHES(SkPackedRTree)
+
+#undef RTREE_BENCHES
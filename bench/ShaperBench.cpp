@@ -9,6 +9,7 @@
 #include "tools/Resources.h"
 
 #include <cfloat>
+#include <vector>
 
 namespace {
 struct ShaperBench : public Benchmark {
@@ -74,4 +75,56 @@ SHAPER_BENCH(tifnagh)
 SHAPER_BENCH(vai)
 #undef SHAPER_BENCH
 
+namespace {
+// Shapes the same few dozen short labels over and over, as a chart or map renders its labels
+// every frame, with or without a shaping cache.
+struct ShaperLabelsBench : public Benchmark {
+    static constexpr int kLabelCount = 32;
+
+    ShaperLabelsBench(bool cached) : fCached(cached) {}
+    const bool fCached;
+    std::unique_ptr<SkShaper> fShaper;
+    std::vector<SkString> fLabels;
+    const char* onGetName() override {
+        return fCached ? "shaper_labels_cached" : "shaper_labels";
+    }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        fShaper = SkShaper::Make();
+        if (fCached) {
+            fShaper = SkShaper::MakeCached(std::move(fShaper), SkShaperCache::Make());
+        }
+
+        // Labels of two words each, from the English sample text.
+        sk_sp<SkData> data = GetResourceAsData("text/english.txt");
+        if (!data) { return; }
+        const char* text = (const char*)data->data();
+        const char* end = text + data->size();
+        while (text < end && (int)fLabels.size() < kLabelCount) {
+            const char* labelEnd = text;
+            int spaces = 0;
+            while (labelEnd < end && !((*labelEnd == ' ' || *labelEnd == '\n') && ++spaces == 2)) {
+                labelEnd++;
+            }
+            fLabels.emplace_back(text, labelEnd - text);
+            text = labelEnd + 1;
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fShaper) { return; }
+        SkFont font;
+        while (loops-- > 0) {
+            for (const SkString& label : fLabels) {
+                SkTextBlobBuilderRunHandler rh(label.c_str(), {0, 0});
+                fShaper->shape(label.c_str(), label.size(), font, true, FLT_MAX, &rh);
+                (void)rh.makeBlob();
+            }
+        }
+    }
+};
+}  // namespace
+
+DEF_BENCH(return new ShaperLabelsBench(false);)
+DEF_BENCH(return new ShaperLabelsBench(true);)
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
@@ -9,8 +9,11 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
+#include "src/core/SkGlyphStore.h"
 #include "src/core/SkRemoteGlyphCache.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
@@ -19,6 +22,8 @@
 #include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <cstdio>
+
 static void do_font_stuff(SkFont* font) {
     SkPaint defaultPaint;
     for (SkScalar i = 8; i < 64; i++) {
@@ -117,6 +122,243 @@ DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
 
+// Many threads drawing text at once, as a multi-threaded rasterizer does: each looks up strikes
+// and the metrics of a few glyphs, in a warm cache with the given number of shards. Compare the
+// shards1 variants, which are the unsharded cache, against the others as threads are added.
+class SkGlyphCacheContentionBench : public Benchmark {
+public:
+    SkGlyphCacheContentionBench(int threads, int shards)
+        : fThreads(threads)
+        , fShards(shards)
+        , fName(SkStringPrintf("SkGlyphCacheContention_threads%d_shards%d", threads, shards)) {}
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        sk_sp<SkTypeface> typefaces[] = {
+                ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()),
+                ToolUtils::create_portable_typeface("sans-serif", SkFontStyle::Italic())};
+
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        SkPaint defaultPaint;
+        for (const sk_sp<SkTypeface>& typeface : typefaces) {
+            font.setTypeface(typeface);
+            for (SkScalar size = 8; size < 40; size++) {
+                font.setSize(size);
+                fStrikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                        font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                        SkScalerContextFlags::kNone, SkMatrix::I()));
+            }
+        }
+
+        static const char kText[] = "Contention";
+        fGlyphCount = font.textToGlyphs(kText, strlen(kText), SkTextEncoding::kUTF8,
+                                        fGlyphIDs, SK_ARRAY_COUNT(fGlyphIDs));
+
+        fCache = std::make_unique<SkStrikeCache>(fShards);
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+
+        // Start warm, so we measure finding strikes and glyphs rather than making them.
+        const SkGlyph* glyphs[SK_ARRAY_COUNT(fGlyphIDs)];
+        for (const SkStrikeSpec& spec : fStrikeSpecs) {
+            spec.findOrCreateStrike(fCache.get())->metrics(this->glyphIDs(), glyphs);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup(*fExecutor).batch(fThreads, [&](int thread) {
+            const SkGlyph* glyphs[SK_ARRAY_COUNT(fGlyphIDs)];
+            const int specCount = SkToInt(fStrikeSpecs.size());
+            for (int i = 0; i < loops; i++) {
+                const SkStrikeSpec& spec = fStrikeSpecs[(thread * 13 + i) % specCount];
+                spec.findOrCreateStrike(fCache.get())->metrics(this->glyphIDs(), glyphs);
+            }
+        });
+    }
+
+private:
+    SkSpan<const SkGlyphID> glyphIDs() const {
+        return SkSpan<const SkGlyphID>{fGlyphIDs, SkToSizeT(fGlyphCount)};
+    }
+
+    const int                      fThreads;
+    const int                      fShards;
+    SkString                       fName;
+    std::vector<SkStrikeSpec>      fStrikeSpecs;
+    SkGlyphID                      fGlyphIDs[16];
+    int                            fGlyphCount{0};
+    std::unique_ptr<SkStrikeCache> fCache;
+    std::unique_ptr<SkExecutor>    fExecutor;
+};
+
+DEF_BENCH( return new SkGlyphCacheContentionBench(1, 1); )
+DEF_BENCH( return new SkGlyphCacheContentionBench(8, 1); )
+DEF_BENCH( return new SkGlyphCacheContentionBench(8, 8); )
+DEF_BENCH( return new SkGlyphCacheContentionBench(32, 1); )
+DEF_BENCH( return new SkGlyphCacheContentionBench(32, 8); )
+DEF_BENCH( return new SkGlyphCacheContentionBench(32, 32); )
+
+// Many threads rasterizing glyphs of one font at once, each with its own scaler context, as
+// happens when threads draw the same font at different sizes. Nothing is cached, so this measures
+// how much of glyph generation in the font backend can run in parallel.
+class GlyphGenerationThreadsBench : public Benchmark {
+public:
+    explicit GlyphGenerationThreadsBench(int threads)
+        : fThreads(threads)
+        , fName(SkStringPrintf("GlyphGeneration_threads%d", threads)) {}
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fTypeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+        if (!fTypeface) {
+            fTypeface = ToolUtils::create_portable_typeface();
+        }
+        fGlyphCount = std::min(fTypeface->countGlyphs(), 256);
+
+        SkFont font(fTypeface);
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        SkPaint defaultPaint;
+        for (int thread = 0; thread < fThreads; thread++) {
+            font.setSize(12 + thread);
+            SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I());
+            fScalerContexts.push_back(fTypeface->createScalerContext(SkScalerContextEffects{},
+                                                                     &strikeSpec.descriptor()));
+        }
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup(*fExecutor).batch(fThreads, [&](int thread) {
+            SkScalerContext* scalerContext = fScalerContexts[thread].get();
+            SkArenaAlloc alloc{4096};
+            for (int i = 0; i < loops; i++) {
+                for (int id = 0; id < fGlyphCount; id++) {
+                    SkGlyph glyph{SkPackedGlyphID{SkTo<SkGlyphID>(id)}};
+                    scalerContext->getMetrics(&glyph);
+                    glyph.setImage(&alloc, scalerContext);
+                }
+                alloc.reset();
+            }
+        });
+    }
+
+private:
+    const int                                     fThreads;
+    SkString                                      fName;
+    sk_sp<SkTypeface>                             fTypeface;
+    int                                           fGlyphCount{0};
+    std::vector<std::unique_ptr<SkScalerContext>> fScalerContexts;
+    std::unique_ptr<SkExecutor>                   fExecutor;
+};
+
+DEF_BENCH( return new GlyphGenerationThreadsBench(1); )
+DEF_BENCH( return new GlyphGenerationThreadsBench(2); )
+DEF_BENCH( return new GlyphGenerationThreadsBench(4); )
+DEF_BENCH( return new GlyphGenerationThreadsBench(8); )
+
+// The first frame of text after the process starts: a cold cache makes a handful of strikes and
+// rasterizes their glyphs. With a glyph store, the glyphs come from the store's file instead; the
+// time includes mapping the file and reading its index.
+class GlyphStoreStartupBench : public Benchmark {
+public:
+    explicit GlyphStoreStartupBench(bool useGlyphStore)
+        : fUseGlyphStore(useGlyphStore)
+        , fName(SkStringPrintf("GlyphStoreStartup_%s", useGlyphStore ? "stored" : "cold")) {}
+
+    ~GlyphStoreStartupBench() override {
+        if (fUseGlyphStore) {
+            std::remove(kPath);
+        }
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        SkFont font(MakeResourceAsTypeface("fonts/Roboto-Regular.ttf"));
+        if (!font.getTypeface()) {
+            font.setTypeface(ToolUtils::create_portable_typeface());
+        }
+        font.setEdging(SkFont::Edging::kAntiAlias);
+
+        static const char kText[] = "The quick brown fox jumps over the lazy dog.";
+        SkGlyphID glyphIDs[SK_ARRAY_COUNT(kText)];
+        int glyphCount = font.textToGlyphs(kText, strlen(kText), SkTextEncoding::kUTF8,
+                                           glyphIDs, SK_ARRAY_COUNT(glyphIDs));
+        for (int i = 0; i < glyphCount; i++) {
+            fGlyphIDs.push_back(SkPackedGlyphID{glyphIDs[i]});
+        }
+
+        SkPaint defaultPaint;
+        for (SkScalar size : {10, 12, 14, 16, 18, 24, 32, 48}) {
+            font.setSize(size);
+            fStrikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+        }
+
+        if (fUseGlyphStore) {
+            // A previous run, which saves its glyphs as it exits.
+            std::remove(kPath);
+            SkStrikeCache cache;
+            cache.setGlyphStore(SkGlyphStore::Make(kPath));
+            this->drawFirstFrame(&cache);
+            cache.purgeAll();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkStrikeCache cache;
+            if (fUseGlyphStore) {
+                cache.setGlyphStore(SkGlyphStore::Make(kPath));
+            }
+            this->drawFirstFrame(&cache);
+        }
+    }
+
+private:
+#if defined(SK_BUILD_FOR_ANDROID)
+    static constexpr char kPath[] = "/data/local/tmp/glyph_store_startup_bench";
+#else
+    static constexpr char kPath[] = "/tmp/glyph_store_startup_bench";
+#endif
+
+    void drawFirstFrame(SkStrikeCache* cache) {
+        std::vector<const SkGlyph*> glyphs(fGlyphIDs.size());
+        for (const SkStrikeSpec& spec : fStrikeSpecs) {
+            spec.findOrCreateStrike(cache)->prepareImages(SkMakeSpan(fGlyphIDs), glyphs.data());
+        }
+    }
+
+    const bool                   fUseGlyphStore;
+    SkString                     fName;
+    std::vector<SkStrikeSpec>    fStrikeSpecs;
+    std::vector<SkPackedGlyphID> fGlyphIDs;
+};
+
+DEF_BENCH( return new GlyphStoreStartupBench(false); )
+DEF_BENCH( return new GlyphStoreStartupBench(true); )
+
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
                            public SkStrikeClient::DiscardableHandleManager {
@@ -8,6 +8,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkFont.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
@@ -109,3 +110,53 @@ class TextBlobMakeBench : public SkTextBlobBench {
     }
 };
 DEF_BENCH( return new TextBlobMakeBench(); )
+
+/*
+ * Draws a blob of many distinct glyphs, like a page of CJK text, with the font cache purged
+ * first so that every glyph is rasterized.
+ */
+class TextBlobUncachedBench : public Benchmark {
+    static constexpr int kGlyphsPerLine = 32;
+    static constexpr int kLines = 16;
+
+    sk_sp<SkTextBlob> fBlob;
+
+    const char* onGetName() override {
+        return "TextBlobUncachedBench";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kRaster_Backend;
+    }
+
+    void onDelayedSetup() override {
+        sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+        if (!typeface) {
+            typeface = ToolUtils::create_portable_typeface();
+        }
+        SkFont font(typeface, 16);
+        int glyphCount = typeface->countGlyphs();
+
+        SkTextBlobBuilder builder;
+        SkGlyphID glyph = 1;
+        for (int line = 0; line < kLines; line++) {
+            const SkTextBlobBuilder::RunBuffer& run =
+                    builder.allocRunPosH(font, kGlyphsPerLine, 20.0f * (line + 1));
+            for (int i = 0; i < kGlyphsPerLine; i++) {
+                run.glyphs[i] = glyph;
+                run.pos[i] = 20.0f * i;
+                glyph = glyph + 1 < glyphCount ? glyph + 1 : 1;
+            }
+        }
+        fBlob = builder.make();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+            canvas->drawTextBlob(fBlob, 0, 0, paint);
+        }
+    }
+};
+DEF_BENCH( return new TextBlobUncachedBench(); )
@@ -147,6 +147,8 @@ static DEFINE_bool(dryRun, false,
 static DEFINE_string(images, "",
                      "List of images and/or directories to decode. A directory with no images"
                      " is treated as a fatal error.");
+static DEFINE_int(codecThreads, 0,
+                  "If >0, time JPEG SkCodec decodes with an executor of this many threads.");
 static DEFINE_bool(simpleCodec, false,
                    "Runs of a subset of the codec tests, always N32, Premul or Opaque");
 
@@ -935,9 +937,13 @@ public:
                         info, storage.get(), rowBytes);
                 switch (result) {
                     case SkCodec::kSuccess:
-                    case SkCodec::kIncompleteInput:
+                    case SkCodec::kIncompleteInput: {
+                        const int threads =
+                                SkEncodedImageFormat::kJPEG == codec->getEncodedFormat()
+                                        ? FLAGS_codecThreads : 0;
                         return new CodecBench(SkOSPath::Basename(path.c_str()),
-                                              encoded.get(), colorType, alphaType);
+                                              encoded.get(), colorType, alphaType, threads);
+                    }
                     case SkCodec::kInvalidConversion:
                         // This is okay. Not all conversions are valid.
                         break;
@@ -26,6 +26,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkPngChunkReader;
 class SkSampler;
@@ -287,6 +288,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -330,6 +332,15 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may split the decode across this executor's threads.
+         *
+         *  Currently only used by JPEG, for memory backed baseline images with restart
+         *  markers; other images are decoded serially.  Ignored by scanline and incremental
+         *  decodes.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -380,6 +391,23 @@ public:
         return this->getPixels(pm.info(), pm.writable_addr(), pm.rowBytes(), opts);
     }
 
+    /**
+     *  Decode into pm, which may be any size, typically a thumbnail much smaller than
+     *  dimensions().
+     *
+     *  The image is decoded at the smallest size the codec supports natively (see
+     *  getScaledDimensions()) that still covers pm, and each decoded scanline is
+     *  area-averaged into pm as it arrives. Only a few rows of that intermediate size are
+     *  held in memory at once. Codecs that do not support scanline decoding (and frames
+     *  other than the first) decode the intermediate image in full first.
+     *
+     *  pm must be kRGBA_8888 or kBGRA_8888, and opaque or premul. Subsets are not
+     *  supported.
+     *
+     *  If a scanline decode is in progress, scanline mode will end.
+     */
+    Result getResampledPixels(const SkPixmap& pm, const Options* opts = nullptr);
+
     /**
      *  If decoding to YUV is supported, this returns true.  Otherwise, this
      *  returns false and does not modify any of the parameters.
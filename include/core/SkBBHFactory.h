@@ -52,4 +52,13 @@ public:
     sk_sp<SkBBoxHierarchy> operator()() const override;
 };
 
+/**
+ *  Like SkRTreeFactory, but the R-Tree uses wider nodes whose child bounds are stored for
+ *  SIMD compares. Queries are faster on large pictures; builds cost about the same.
+ */
+class SK_API SkPackedRTreeFactory : public SkBBHFactory {
+public:
+    sk_sp<SkBBoxHierarchy> operator()() const override;
+};
+
 #endif
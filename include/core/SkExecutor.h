@@ -22,6 +22,12 @@ public:
     static std::unique_ptr<SkExecutor> MakeLIFOThreadPool(int threads = 0,
                                                           bool allowBorrowing = true);
 
+    // Create a work-stealing thread pool. Each thread owns its own work queues, taking its newest
+    // work first and stealing the oldest from other threads when it runs out, so adding and
+    // running many small tasks does not contend on a single lock. Honors addWithPriority().
+    static std::unique_ptr<SkExecutor> MakeWorkStealingThreadPool(int threads = 0,
+                                                                  bool allowBorrowing = true);
+
     // There is always a default SkExecutor available by calling SkExecutor::GetDefault().
     static SkExecutor& GetDefault();
     static void SetDefault(SkExecutor*);  // Does not take ownership.  Not thread safe.
@@ -29,6 +35,15 @@ public:
     // Add work to execute.
     virtual void add(std::function<void(void)>) = 0;
 
+    enum class Priority { kLow, kNormal, kHigh };
+    static constexpr int kPriorityCount = 3;
+
+    // Add work to execute, ahead of any waiting work of lower priority. add() is kNormal.
+    // Executors without priorities ignore it.
+    virtual void addWithPriority(Priority, std::function<void(void)> work) {
+        this->add(std::move(work));
+    }
+
     // If it makes sense for this executor, use this thread to execute work for a little while.
     virtual void borrow() {}
 };
@@ -97,6 +97,16 @@ public:
      */
     static void PurgeFontCache();
 
+    /**
+     *  Keep the glyphs of the font cache in the file at path between runs, so they need not be
+     *  rasterized again after the process starts. Glyphs saved in the file are used when their
+     *  strikes are created. The glyphs of strikes purged from the cache are saved, and written
+     *  to the file by PurgeFontCache(), which should be called before exiting to save the rest.
+     *
+     *  Pass nullptr to stop using the file.
+     */
+    static void SetFontCachePersistentPath(const char path[]);
+
     /**
      *  Scaling bitmaps with the kHigh_SkFilterQuality setting is
      *  expensive, so the result is saved in the global Scaled Image
@@ -16,8 +16,10 @@
 class SkCanvas;
 class SkData;
 struct SkDeserialProcs;
+class SkExecutor;
 class SkImage;
 class SkMatrix;
+class SkPixmap;
 struct SkSerialProcs;
 class SkShader;
 class SkStream;
@@ -80,6 +82,26 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture that was serialized into data, like MakeFromData(), but plays it
+        back in place: rather than re-recording the serialized drawing commands, the returned
+        SkPicture refs data and reads its commands straight from it each time it is drawn.
+
+        This makes loading faster and avoids holding a second copy of the commands, which
+        matters most for large pictures in data mapped from a file (see
+        SkData::MakeFromFileName()). In exchange, drawing such a picture can't skip commands
+        outside the clip using a bounding box hierarchy, and commands are decoded every time.
+        Paints, paths, images and other resources are still decoded once, at load.
+
+        Commands are read in place only from pictures serialized by this version of Skia or a
+        later one; others are loaded by copying their commands out of data.
+
+        @param data   container for serial data; referenced by the returned SkPicture
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture constructed from data
+    */
+    static sk_sp<SkPicture> MakeFromMappedData(sk_sp<SkData> data,
+                                               const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -130,6 +152,59 @@ public:
     */
     virtual void playback(SkCanvas* canvas, AbortCallback* callback = nullptr) const = 0;
 
+    /** Draws SkPicture into dst, split into tiles of tileSize pixels. Each tile is drawn by
+        its own raster SkCanvas clipped to the tile, so when SkPicture was recorded with an
+        SkBBHFactory, each tile replays only the commands whose bounds touch it.
+
+        If executor is not nullptr, tiles are drawn concurrently on executor; otherwise they
+        are drawn one after another on the calling thread. Either way, all tiles are drawn
+        when playbackTiled() returns.
+
+        Returns false, and draws nothing, if dst is empty, if its pixels can't be drawn into
+        by a raster SkCanvas, or if tileSize is empty.
+
+        @param dst       pixels to draw into
+        @param matrix    transform applied to SkPicture before drawing; may be nullptr
+        @param executor  runs tiles concurrently; may be nullptr
+        @param tileSize  dimensions of each tile; tiles on the right and bottom edges of dst
+                         may be smaller
+        @return          true if SkPicture was drawn into dst
+    */
+    bool playbackTiled(const SkPixmap& dst, const SkMatrix* matrix, SkExecutor* executor,
+                       SkISize tileSize = {256, 256}) const;
+
+    /** Returns bounds, in picture coordinates, of everything that drawing SkPicture may draw
+        differently than drawing previous, or an empty SkRect if they draw the same.
+
+        Both pictures' drawing commands are compared one by one from their starts and then
+        from their ends, so a picture re-recorded with a change in the middle (e.g. one UI
+        element drawn differently) is damaged only where the commands in between draw. When
+        either SkPicture can't be compared this way, e.g. because it holds only a single
+        command, or when their cull rects differ, returns the union of both cull rects.
+        SkDrawable drawn into either SkPicture is always damaged, even when previous is
+        SkPicture itself.
+
+        @param previous  SkPicture drawn before this one
+        @return          bounds that may differ between SkPicture and previous
+    */
+    SkRect computeDamage(const SkPicture& previous) const;
+
+    /** Updates dst, which holds previous drawn with matrix, to hold SkPicture drawn with
+        matrix, by clearing and redrawing only the pixels under computeDamage(previous).
+        Other pixels are left alone. When SkPicture was recorded with an SkBBHFactory, only
+        the commands touching the damage are replayed.
+
+        Like pixels drawn into dst by playbackTiled(), redrawn pixels may differ slightly
+        from drawing all of SkPicture at once, where antialiased edges cross the damage.
+
+        @param dst       pixels holding previous, cleared to transparent and drawn with matrix
+        @param matrix    transform applied to both pictures when drawing; may be nullptr
+        @param previous  SkPicture drawn into dst
+        @return          bounds of the pixels redrawn in dst; empty if none were
+    */
+    SkIRect playbackDamage(const SkPixmap& dst, const SkMatrix* matrix,
+                           const SkPicture& previous) const;
+
     /** Returns cull SkRect for this picture, passed in when SkPicture was created.
         Returned SkRect does not specify clipping SkRect for SkPicture; cull is hint
         of SkPicture bounds.
@@ -234,13 +309,15 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkMappedPicture;
     friend class SkPicturePriv;
     template <typename> friend class SkMiniPicture;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
         bool textBlobsOnly=false) const;
     static sk_sp<SkPicture> MakeFromStream(SkStream*, const SkDeserialProcs*,
-                                           class SkTypefacePlayback*);
+                                           class SkTypefacePlayback*,
+                                           const SkData* streamData = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
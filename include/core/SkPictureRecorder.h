@@ -35,6 +35,10 @@ public:
         // If you call drawPicture() or drawDrawable() on the recording canvas, this flag forces
         // that object to playback its contents immediately rather than reffing the object.
         kPlaybackDrawPicture_RecordFlag     = 1 << 0,
+        // Merges runs of drawImageRect() that share a paint into experimental_DrawEdgeAAImageSet(),
+        // and runs of drawTextBlob() that share a paint into one blob. A merged run would be a
+        // single entry in a bounding box hierarchy, so this is ignored when recording with one.
+        kBatchDraws_RecordFlag              = 1 << 1,
     };
 
     enum FinishFlags {
@@ -106,6 +110,9 @@ public:
 private:
     void reset();
 
+    // Runs the record optimizations that fFlags and fBBH allow.
+    void optimize();
+
     /** Replay the current (partially recorded) operation stream into
         canvas. This call doesn't close the current recording.
     */
@@ -25,6 +25,7 @@
 
 class SkCanvas;
 class SkDeferredDisplayList;
+class SkExecutor;
 class SkPaint;
 class SkSurfaceCharacterization;
 class GrBackendRenderTarget;
@@ -170,6 +171,32 @@ public:
     static sk_sp<SkSurface> MakeRasterN32Premul(int width, int height,
                                                 const SkSurfaceProps* surfaceProps = nullptr);
 
+    /** Allocates raster SkSurface whose SkCanvas rasterizes in parallel. Allocates and zeroes
+        pixel memory as MakeRaster() does; pixel memory is deleted when SkSurface is deleted.
+
+        Draws to the returned SkSurface are deferred and binned into bands of rows. Bands are
+        rasterized concurrently on executor when pixels are read, when an SkImage snapshot is
+        made, and on flushAndSubmit(). Output matches SkSurface returned by MakeRaster(), up to
+        rounding where an antialiased hairline crosses from one band into the next. Paths with
+        thousands of points are instead drawn immediately, their edges split into bands that
+        are scan converted concurrently; edges crossing those bands may round slightly differently.
+        Large blur image filters split their rows and columns across executor, with identical
+        output.
+
+        executor must outlive the returned SkSurface and any SkSurface made from it with
+        makeSurface().
+
+        @param imageInfo  width, height, SkColorType, SkAlphaType, SkColorSpace,
+                          of raster surface; width and height must be greater than zero
+        @param executor   runs rasterization work; if nullptr, SkExecutor::GetDefault() is used
+        @param props      LCD striping orientation and setting for device independent fonts;
+                          may be nullptr
+        @return           SkSurface if all parameters are valid; otherwise, nullptr
+    */
+    static sk_sp<SkSurface> MakeRasterThreaded(const SkImageInfo& imageInfo,
+                                               SkExecutor* executor,
+                                               const SkSurfaceProps* props = nullptr);
+
     /** Caller data passed to RenderTarget/TextureReleaseProc; may be nullptr. */
     typedef void* ReleaseContext;
 
@@ -196,15 +196,50 @@ struct Metadata {
     /** Executor to handle threaded work within PDF Backend. If this is nullptr,
         then all work will be done serially on the main thread. To have worker
         threads assist with various tasks, set this to a valid SkExecutor
-        instance. Currently used for executing Deflate algorithm in parallel.
+        instance. Currently used to compress content streams and form
+        XObjects, encode images and subset fonts in parallel.
 
-        If set, the PDF output will be non-reproducible in the order and
-        internal numbering of objects, but should render the same.
+        Objects are still written in the order they would be without an
+        executor. Only the internal numbering of image soft masks may vary
+        from run to run; the output should render the same.
 
         Experimental.
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** Streaming mode, for very long documents.  If nonzero, each page is
+        written out as soon as it ends instead of at close(), and the
+        document tries to keep the memory it holds on to between pages
+        under this many bytes:  work queued on fExecutor waits for earlier
+        jobs whenever their inputs and buffered output would exceed it,
+        and the caches that only share images, shaders and graphic states
+        between pages are dropped once they outgrow it (later pages then
+        write their own copies).
+
+        Fonts are still subset at close(), so the glyphs used from each
+        font are remembered for the whole document, as is the offset of
+        every object written.
+
+        If zero, pages are held until close() and nothing is bounded.
+
+        Experimental.
+    */
+    size_t fStreamingMemoryLimit = 0;
+
+    /** Compression level for the zlib deflate used on content streams,
+        images and fonts.  LowButFast is usually several times faster than
+        Default at a modest cost in file size; None skips compression of
+        streams entirely.
+    */
+    enum class CompressionLevel : int {
+        Default = -1,
+        None = 0,
+        LowButFast = 1,
+        Average = 6,
+        HighButSlow = 9,
+    };
+    CompressionLevel fCompressionLevel = CompressionLevel::Default;
+
     /** Preferred Subsetter. Only respected if both are compiled in.
 
         The Sfntly subsetter is deprecated.
@@ -49,7 +49,7 @@ public:
         , fConicWeights(std::move(weights))
     {
         fBoundsIsDirty = true;    // this also invalidates fIsFinite
-        fGenerationID = kEmptyGenID;
+        fGenerationID.store(kEmptyGenID, std::memory_order_relaxed);
         fSegmentMask = segmentMask;
         fIsOval = false;
         fIsRRect = false;
@@ -345,7 +345,7 @@ private:
 
     SkPathRef() {
         fBoundsIsDirty = true;    // this also invalidates fIsFinite
-        fGenerationID = kEmptyGenID;
+        fGenerationID.store(kEmptyGenID, std::memory_order_relaxed);
         fSegmentMask = 0;
         fIsOval = false;
         fIsRRect = false;
@@ -399,7 +399,7 @@ private:
         SkDEBUGCODE(this->validate();)
         this->callGenIDChangeListeners();
         fBoundsIsDirty = true;      // this also invalidates fIsFinite
-        fGenerationID = 0;
+        fGenerationID.store(0, std::memory_order_relaxed);
 
         fSegmentMask = 0;
         fIsOval = false;
@@ -486,7 +486,8 @@ private:
     enum {
         kEmptyGenID = 1, // GenID reserved for path ref with zero points and zero verbs.
     };
-    mutable uint32_t    fGenerationID;
+    // Assigned lazily by genID(), which may race with itself when threads play back one picture.
+    mutable std::atomic<uint32_t> fGenerationID;
     SkDEBUGCODE(std::atomic<int> fEditorsAttached;) // assert only one editor in use at any time.
 
     SkIDChangeListener::List fGenIDChangeListeners;
@@ -39,6 +39,7 @@
 
 class SkFont;
 class SkFontMgr;
+class SkShaperCache;
 
 /**
    Shapes text using HarfBuzz and places the shaped text into a
@@ -60,6 +61,13 @@ public:
 
     static std::unique_ptr<SkShaper> Make(sk_sp<SkFontMgr> = nullptr);
 
+    /** Returns a shaper which keeps the results of shaper in cache, and replays them when the
+        same text is shaped again with the same fonts, bidi levels, scripts, languages, features
+        and width. A cache may be shared by several shapers, on several threads, as long as they
+        would all shape the same way: made by the same factory, with the same font manager. */
+    static std::unique_ptr<SkShaper> MakeCached(std::unique_ptr<SkShaper> shaper,
+                                                sk_sp<SkShaperCache> cache);
+
     SkShaper();
     virtual ~SkShaper();
 
@@ -250,6 +258,35 @@ private:
     SkShaper& operator=(const SkShaper&) = delete;
 };
 
+/**
+ * A bounded cache of shaping results, for the shapers made by SkShaper::MakeCached().
+ *
+ * Once the results held add up to more than the byte limit, the least recently used are
+ * dropped. It is safe to use from several threads.
+ */
+class SKSHAPER_API SkShaperCache : public SkRefCnt {
+public:
+    static constexpr size_t kDefaultByteLimit = 1024 * 1024;
+
+    static sk_sp<SkShaperCache> Make(size_t byteLimit = kDefaultByteLimit);
+
+    struct Stats {
+        int    fHits;       // Shape calls answered from the cache.
+        int    fMisses;     // Shape calls passed on to the shaper.
+        int    fCount;      // Results held now.
+        size_t fBytesUsed;  // Approximate size of the results held now.
+    };
+    virtual Stats stats() const = 0;
+
+    /** Drops all the results held. The hit and miss counts are kept. */
+    virtual void purgeAll() = 0;
+
+private:
+    // The shapers made by SkShaper::MakeCached() rely on every cache coming from Make().
+    SkShaperCache() = default;
+    friend class SkShaperCacheImpl;
+};
+
 /**
  * Helper for shaping text directly into a SkTextBlob.
  */
@@ -0,0 +1,478 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkFont.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTHash.h"
+#include "modules/skshaper/include/SkShaper.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkTInternalLList.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Everything a shaper's result depends on, besides the shaper itself.
+struct ShapeKey {
+    struct FontRun     { size_t fEnd; SkFont fFont; };
+    struct BiDiRun     { size_t fEnd; uint8_t fLevel; };
+    struct ScriptRun   { size_t fEnd; SkFourByteTag fScript; };
+    struct LanguageRun { size_t fEnd; SkString fLanguage; };
+
+    SkString                  fText;
+    bool                      fFromIterators;  // Which shape() call, as they may differ.
+    std::vector<FontRun>      fFonts;
+    std::vector<BiDiRun>      fBiDi;
+    std::vector<ScriptRun>    fScripts;
+    std::vector<LanguageRun>  fLanguages;
+    std::vector<SkShaper::Feature> fFeatures;
+    SkScalar                  fWidth;
+    uint32_t                  fHash;
+
+    void computeHash() {
+        uint32_t hash = SkOpts::hash(fText.c_str(), fText.size());
+        auto mix = [&hash](const auto& value) {
+            hash = SkOpts::hash(&value, sizeof(value), hash);
+        };
+        mix(fFromIterators);
+        for (const FontRun& run : fFonts) {
+            mix(run.fEnd);
+            mix(SkTypeface::UniqueID(run.fFont.getTypeface()));
+            mix(run.fFont.getSize());
+            mix(run.fFont.getScaleX());
+            mix(run.fFont.getSkewX());
+        }
+        for (const BiDiRun& run : fBiDi) {
+            mix(run.fEnd);
+            mix(run.fLevel);
+        }
+        for (const ScriptRun& run : fScripts) {
+            mix(run.fEnd);
+            mix(run.fScript);
+        }
+        for (const LanguageRun& run : fLanguages) {
+            mix(run.fEnd);
+            hash = SkOpts::hash(run.fLanguage.c_str(), run.fLanguage.size(), hash);
+        }
+        for (const SkShaper::Feature& feature : fFeatures) {
+            mix(feature.tag);
+            mix(feature.value);
+            mix(feature.start);
+            mix(feature.end);
+        }
+        mix(fWidth);
+        fHash = hash;
+    }
+
+    size_t approximateBytesUsed() const {
+        size_t bytes = sizeof(*this) + fText.size()
+                     + fFonts.size()     * sizeof(FontRun)
+                     + fBiDi.size()      * sizeof(BiDiRun)
+                     + fScripts.size()   * sizeof(ScriptRun)
+                     + fLanguages.size() * sizeof(LanguageRun)
+                     + fFeatures.size()  * sizeof(SkShaper::Feature);
+        for (const LanguageRun& run : fLanguages) {
+            bytes += run.fLanguage.size();
+        }
+        return bytes;
+    }
+
+    bool operator==(const ShapeKey& that) const {
+        auto sameFeatures = [](const SkShaper::Feature& a, const SkShaper::Feature& b) {
+            return a.tag == b.tag && a.value == b.value && a.start == b.start && a.end == b.end;
+        };
+        return fHash == that.fHash
+            && fFromIterators == that.fFromIterators
+            && fWidth == that.fWidth
+            && fText.equals(that.fText)
+            && std::equal(fFonts.begin(), fFonts.end(), that.fFonts.begin(), that.fFonts.end(),
+                          [](const FontRun& a, const FontRun& b) {
+                              return a.fEnd == b.fEnd && a.fFont == b.fFont;
+                          })
+            && std::equal(fBiDi.begin(), fBiDi.end(), that.fBiDi.begin(), that.fBiDi.end(),
+                          [](const BiDiRun& a, const BiDiRun& b) {
+                              return a.fEnd == b.fEnd && a.fLevel == b.fLevel;
+                          })
+            && std::equal(fScripts.begin(), fScripts.end(),
+                          that.fScripts.begin(), that.fScripts.end(),
+                          [](const ScriptRun& a, const ScriptRun& b) {
+                              return a.fEnd == b.fEnd && a.fScript == b.fScript;
+                          })
+            && std::equal(fLanguages.begin(), fLanguages.end(),
+                          that.fLanguages.begin(), that.fLanguages.end(),
+                          [](const LanguageRun& a, const LanguageRun& b) {
+                              return a.fEnd == b.fEnd && a.fLanguage.equals(b.fLanguage);
+                          })
+            && std::equal(fFeatures.begin(), fFeatures.end(),
+                          that.fFeatures.begin(), that.fFeatures.end(), sameFeatures);
+    }
+};
+
+// The calls a shaper made to its RunHandler, with positions relative to the buffer's point.
+struct ShapeResult {
+    struct Run {
+        SkFont   fFont;
+        uint8_t  fBidiLevel;
+        SkVector fAdvance;
+        size_t   fGlyphCount;
+        SkShaper::RunHandler::Range fUtf8Range;
+
+        SkShaper::RunHandler::RunInfo info() const {
+            return {fFont, fBidiLevel, fAdvance, fGlyphCount, fUtf8Range};
+        }
+    };
+    struct RunBuffer {
+        Run                    fRun;
+        std::vector<SkGlyphID> fGlyphs;
+        std::vector<SkPoint>   fPositions;
+        std::vector<SkPoint>   fOffsets;
+        std::vector<uint32_t>  fClusters;
+    };
+    struct Line {
+        std::vector<Run>       fRunInfos;
+        std::vector<RunBuffer> fRunBuffers;
+    };
+
+    std::vector<Line> fLines;
+
+    size_t approximateBytesUsed() const {
+        size_t bytes = sizeof(*this);
+        for (const Line& line : fLines) {
+            bytes += sizeof(Line) + line.fRunInfos.size() * sizeof(Run);
+            for (const RunBuffer& buffer : line.fRunBuffers) {
+                bytes += sizeof(RunBuffer) + buffer.fRun.fGlyphCount * (sizeof(SkGlyphID) +
+                                                                        2 * sizeof(SkPoint) +
+                                                                        sizeof(uint32_t));
+            }
+        }
+        return bytes;
+    }
+
+    void replay(SkShaper::RunHandler* handler) const {
+        for (const Line& line : fLines) {
+            handler->beginLine();
+            for (const Run& run : line.fRunInfos) {
+                handler->runInfo(run.info());
+            }
+            handler->commitRunInfo();
+            for (const RunBuffer& recorded : line.fRunBuffers) {
+                const SkShaper::RunHandler::RunInfo info = recorded.fRun.info();
+                const auto buffer = handler->runBuffer(info);
+                size_t count = recorded.fGlyphs.size();
+                memcpy(buffer.glyphs, recorded.fGlyphs.data(), count * sizeof(SkGlyphID));
+                for (size_t i = 0; i < count; i++) {
+                    if (buffer.offsets) {
+                        buffer.positions[i] = recorded.fPositions[i] + buffer.point;
+                        buffer.offsets[i] = recorded.fOffsets[i];
+                    } else {
+                        buffer.positions[i] = recorded.fPositions[i] + buffer.point
+                                                                     + recorded.fOffsets[i];
+                    }
+                }
+                if (buffer.clusters) {
+                    memcpy(buffer.clusters, recorded.fClusters.data(), count * sizeof(uint32_t));
+                }
+                handler->commitRunBuffer(info);
+            }
+            handler->commitLine();
+        }
+    }
+};
+
+// Records everything the shaper hands it, asking for offsets and clusters so that the result
+// can be replayed to any handler.
+class RecordingRunHandler final : public SkShaper::RunHandler {
+public:
+    explicit RecordingRunHandler(ShapeResult* result) : fResult(result) {}
+
+    void beginLine() override { fResult->fLines.emplace_back(); }
+    void runInfo(const RunInfo& info) override {
+        fResult->fLines.back().fRunInfos.push_back(Record(info));
+    }
+    void commitRunInfo() override {}
+    Buffer runBuffer(const RunInfo& info) override {
+        fResult->fLines.back().fRunBuffers.emplace_back();
+        ShapeResult::RunBuffer& recorded = fResult->fLines.back().fRunBuffers.back();
+        recorded.fRun = Record(info);
+        // Not every shaper fills in the offsets.
+        recorded.fGlyphs.resize(info.glyphCount);
+        recorded.fPositions.resize(info.glyphCount);
+        recorded.fOffsets.resize(info.glyphCount, {0, 0});
+        recorded.fClusters.resize(info.glyphCount);
+        return {recorded.fGlyphs.data(),
+                recorded.fPositions.data(),
+                recorded.fOffsets.data(),
+                recorded.fClusters.data(),
+                {0, 0}};
+    }
+    void commitRunBuffer(const RunInfo&) override {}
+    void commitLine() override {}
+
+private:
+    static ShapeResult::Run Record(const RunInfo& info) {
+        return {info.fFont, info.fBidiLevel, info.fAdvance, info.glyphCount, info.utf8Range};
+    }
+
+    ShapeResult* fResult;
+};
+
+// Plays back the runs read from the caller's iterators to the wrapped shaper.
+template <typename Iterator, typename Run>
+class ReplayRunIterator : public Iterator {
+public:
+    explicit ReplayRunIterator(const std::vector<Run>& runs) : fRuns(runs) {}
+    void consume() override { SkASSERT(!this->atEnd()); fCurrent++; }
+    size_t endOfCurrentRun() const override { return fCurrent < 0 ? 0 : fRuns[fCurrent].fEnd; }
+    bool atEnd() const override { return fCurrent + 1 >= (int)fRuns.size(); }
+
+protected:
+    const Run& current() const { return fRuns[fCurrent]; }
+
+private:
+    const std::vector<Run>& fRuns;
+    int fCurrent = -1;
+};
+
+class ReplayFontRunIterator final
+        : public ReplayRunIterator<SkShaper::FontRunIterator, ShapeKey::FontRun> {
+public:
+    using ReplayRunIterator::ReplayRunIterator;
+    const SkFont& currentFont() const override { return this->current().fFont; }
+};
+class ReplayBiDiRunIterator final
+        : public ReplayRunIterator<SkShaper::BiDiRunIterator, ShapeKey::BiDiRun> {
+public:
+    using ReplayRunIterator::ReplayRunIterator;
+    uint8_t currentLevel() const override { return this->current().fLevel; }
+};
+class ReplayScriptRunIterator final
+        : public ReplayRunIterator<SkShaper::ScriptRunIterator, ShapeKey::ScriptRun> {
+public:
+    using ReplayRunIterator::ReplayRunIterator;
+    SkFourByteTag currentScript() const override { return this->current().fScript; }
+};
+class ReplayLanguageRunIterator final
+        : public ReplayRunIterator<SkShaper::LanguageRunIterator, ShapeKey::LanguageRun> {
+public:
+    using ReplayRunIterator::ReplayRunIterator;
+    const char* currentLanguage() const override { return this->current().fLanguage.c_str(); }
+};
+
+}  // namespace
+
+class SkShaperCacheImpl final : public SkShaperCache {
+public:
+    struct Entry : public SkNVRefCnt<Entry> {
+        Entry(ShapeKey key, ShapeResult result)
+            : fKey(std::move(key))
+            , fResult(std::move(result))
+            , fBytes(fKey.approximateBytesUsed() + fResult.approximateBytesUsed()) {}
+
+        const ShapeKey    fKey;
+        const ShapeResult fResult;
+        const size_t      fBytes;
+
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+    };
+
+    explicit SkShaperCacheImpl(size_t byteLimit) : fByteLimit(byteLimit) {}
+
+    ~SkShaperCacheImpl() override {
+        SkAutoMutexExclusive lock{fMutex};
+        this->purge(0);
+    }
+
+    Stats stats() const override {
+        SkAutoMutexExclusive lock{fMutex};
+        return {fHits, fMisses, fMap.count(), fBytesUsed};
+    }
+
+    void purgeAll() override {
+        SkAutoMutexExclusive lock{fMutex};
+        this->purge(0);
+    }
+
+    // Returns the result shaped for key before, counting a hit or a miss.
+    sk_sp<Entry> find(const ShapeKey& key) {
+        SkAutoMutexExclusive lock{fMutex};
+        Entry** found = fMap.find(key);
+        if (found == nullptr) {
+            fMisses++;
+            return nullptr;
+        }
+        fHits++;
+        Entry* entry = *found;
+        if (entry != fLRU.head()) {
+            fLRU.remove(entry);
+            fLRU.addToHead(entry);
+        }
+        return sk_ref_sp(entry);
+    }
+
+    void add(sk_sp<Entry> entry) {
+        // A result bigger than the whole budget would only push everything else out.
+        if (entry->fBytes > fByteLimit) {
+            return;
+        }
+        SkAutoMutexExclusive lock{fMutex};
+        // Another thread may have shaped the same text meanwhile.
+        if (fMap.find(entry->fKey) != nullptr) {
+            return;
+        }
+        this->purge(fByteLimit - entry->fBytes);
+        fBytesUsed += entry->fBytes;
+        fLRU.addToHead(entry.get());
+        fMap.set(entry.release());
+    }
+
+private:
+    struct EntryTraits {
+        static const ShapeKey& GetKey(const Entry* entry) { return entry->fKey; }
+        static uint32_t Hash(const ShapeKey& key) { return key.fHash; }
+    };
+
+    // Drops the least recently used results until no more than byteLimit bytes are held.
+    void purge(size_t byteLimit) SK_REQUIRES(fMutex) {
+        while (fBytesUsed > byteLimit) {
+            Entry* entry = fLRU.tail();
+            SkASSERT(entry);
+            fLRU.remove(entry);
+            fMap.remove(entry->fKey);
+            fBytesUsed -= entry->fBytes;
+            entry->unref();
+        }
+    }
+
+    const size_t fByteLimit;
+
+    mutable SkMutex fMutex;
+    SkTHashTable<Entry*, ShapeKey, EntryTraits> fMap SK_GUARDED_BY(fMutex);
+    SkTInternalLList<Entry> fLRU SK_GUARDED_BY(fMutex);
+    size_t fBytesUsed SK_GUARDED_BY(fMutex) {0};
+    int    fHits      SK_GUARDED_BY(fMutex) {0};
+    int    fMisses    SK_GUARDED_BY(fMutex) {0};
+};
+
+namespace {
+
+class SkShaperCaching final : public SkShaper {
+public:
+    SkShaperCaching(std::unique_ptr<SkShaper> shaper, sk_sp<SkShaperCache> cache)
+        : fShaper(std::move(shaper))
+        , fCache(std::move(cache)) {}
+
+private:
+    void shape(const char* utf8, size_t utf8Bytes,
+               const SkFont& srcFont,
+               bool leftToRight,
+               SkScalar width,
+               RunHandler* handler) const override {
+        ShapeKey key;
+        key.fText.set(utf8, utf8Bytes);
+        key.fFromIterators = false;
+        key.fFonts.push_back({utf8Bytes, srcFont});
+        key.fBiDi.push_back({utf8Bytes, (uint8_t)(leftToRight ? 0 : 1)});
+        key.fWidth = width;
+        key.computeHash();
+
+        this->shapeWithCache(std::move(key), handler, [&](const ShapeKey&, RunHandler* recorder) {
+            fShaper->shape(utf8, utf8Bytes, srcFont, leftToRight, width, recorder);
+        });
+    }
+
+    void shape(const char* utf8, size_t utf8Bytes,
+               FontRunIterator& font,
+               BiDiRunIterator& bidi,
+               ScriptRunIterator& script,
+               LanguageRunIterator& language,
+               SkScalar width,
+               RunHandler* handler) const override {
+        this->shape(utf8, utf8Bytes, font, bidi, script, language, nullptr, 0, width, handler);
+    }
+
+    void shape(const char* utf8, size_t utf8Bytes,
+               FontRunIterator& font,
+               BiDiRunIterator& bidi,
+               ScriptRunIterator& script,
+               LanguageRunIterator& language,
+               const Feature* features, size_t featuresSize,
+               SkScalar width,
+               RunHandler* handler) const override {
+        // The iterators are the only way to learn what the text will be shaped with, so read
+        // them all up front, and hand the shaper replays of what they said.
+        ShapeKey key;
+        key.fText.set(utf8, utf8Bytes);
+        key.fFromIterators = true;
+        while (!font.atEnd()) {
+            font.consume();
+            key.fFonts.push_back({font.endOfCurrentRun(), font.currentFont()});
+        }
+        while (!bidi.atEnd()) {
+            bidi.consume();
+            key.fBiDi.push_back({bidi.endOfCurrentRun(), bidi.currentLevel()});
+        }
+        while (!script.atEnd()) {
+            script.consume();
+            key.fScripts.push_back({script.endOfCurrentRun(), script.currentScript()});
+        }
+        while (!language.atEnd()) {
+            language.consume();
+            key.fLanguages.push_back({language.endOfCurrentRun(),
+                                      SkString(language.currentLanguage())});
+        }
+        key.fFeatures.assign(features, features + featuresSize);
+        key.fWidth = width;
+        key.computeHash();
+
+        this->shapeWithCache(std::move(key), handler, [&](const ShapeKey& runs,
+                                                          RunHandler* recorder) {
+            ReplayFontRunIterator     fontReplay{runs.fFonts};
+            ReplayBiDiRunIterator     bidiReplay{runs.fBiDi};
+            ReplayScriptRunIterator   scriptReplay{runs.fScripts};
+            ReplayLanguageRunIterator languageReplay{runs.fLanguages};
+            fShaper->shape(utf8, utf8Bytes, fontReplay, bidiReplay, scriptReplay, languageReplay,
+                           features, featuresSize, width, recorder);
+        });
+    }
+
+    template <typename ShapeFn>
+    void shapeWithCache(ShapeKey&& key, RunHandler* handler, ShapeFn&& shapeFn) const {
+        // Only SkShaperCache::Make() can make an SkShaperCache, so this is always its impl.
+        auto cache = static_cast<SkShaperCacheImpl*>(fCache.get());
+        sk_sp<SkShaperCacheImpl::Entry> entry = cache->find(key);
+        if (!entry) {
+            ShapeResult result;
+            RecordingRunHandler recorder{&result};
+            shapeFn(key, &recorder);
+            entry = sk_make_sp<SkShaperCacheImpl::Entry>(std::move(key), std::move(result));
+            cache->add(entry);
+        }
+        entry->fResult.replay(handler);
+    }
+
+    std::unique_ptr<SkShaper> fShaper;
+    sk_sp<SkShaperCache> fCache;
+};
+
+}  // namespace
+
+sk_sp<SkShaperCache> SkShaperCache::Make(size_t byteLimit) {
+    return sk_make_sp<SkShaperCacheImpl>(byteLimit);
+}
+
+std::unique_ptr<SkShaper> SkShaper::MakeCached(std::unique_ptr<SkShaper> shaper,
+                                               sk_sp<SkShaperCache> cache) {
+    if (!shaper || !cache) {
+        return shaper;
+    }
+    return std::make_unique<SkShaperCaching>(std::move(shaper), std::move(cache));
+}
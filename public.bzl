@@ -937,6 +937,7 @@ SKOTTIE_TOOL_SRCS = [
 SKSHAPER_HARFBUZZ_SRCS = [
     "modules/skshaper/include/SkShaper.h",
     "modules/skshaper/src/SkShaper.cpp",
+    "modules/skshaper/src/SkShaperCache.cpp",
     "modules/skshaper/src/SkShaper_harfbuzz.cpp",
     "modules/skshaper/src/SkShaper_primitive.cpp",
 ]
@@ -944,6 +945,7 @@ SKSHAPER_HARFBUZZ_SRCS = [
 SKSHAPER_PRIMITIVE_SRCS = [
     "modules/skshaper/include/SkShaper.h",
     "modules/skshaper/src/SkShaper.cpp",
+    "modules/skshaper/src/SkShaperCache.cpp",
     "modules/skshaper/src/SkShaper_primitive.cpp",
 ]
 
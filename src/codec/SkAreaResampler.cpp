@@ -0,0 +1,104 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkAreaResampler.h"
+
+#include "include/private/SkTo.h"
+
+#include <algorithm>
+
+// Coverage is computed exactly in integers by scaling both images to a common
+// width (and height): source pixel i spans [i * dstWidth, (i + 1) * dstWidth)
+// and destination pixel x spans [x * srcWidth, (x + 1) * srcWidth).
+
+SkAreaResampler::SkAreaResampler(int srcWidth, int srcHeight, const SkPixmap& dst,
+                                 bool bottomUp)
+    : fSrcWidth(srcWidth)
+    , fSrcHeight(srcHeight)
+    , fDst(dst)
+    , fBottomUp(bottomUp)
+    , fFirstSrcX(dst.width())
+    , fWeightStart(dst.width() + 1)
+    , fWeights(srcWidth + dst.width())
+    , fFiltered(dst.width())
+    , fAccum(dst.width())
+    , fSrcY(0)
+    , fDstY(0)
+{
+    SkASSERT(srcWidth > 0 && srcHeight > 0);
+    SkASSERT(4 == dst.info().bytesPerPixel());
+
+    const int64_t dstWidth = dst.width();
+    int weightCount = 0;
+    for (int x = 0; x < dst.width(); x++) {
+        const int64_t left  = x * (int64_t)srcWidth,
+                      right = left + srcWidth;
+        const int firstSrcX = SkToInt(left / dstWidth),
+                  lastSrcX  = SkToInt((right - 1) / dstWidth);
+        fFirstSrcX[x] = firstSrcX;
+        fWeightStart[x] = weightCount;
+        for (int i = firstSrcX; i <= lastSrcX; i++) {
+            const int64_t covered = std::min((i + 1) * dstWidth, right)
+                                  - std::max(i * dstWidth, left);
+            SkASSERT(weightCount < srcWidth + dst.width());
+            fWeights[weightCount++] = (float)covered / srcWidth;
+        }
+    }
+    fWeightStart[dst.width()] = weightCount;
+
+    std::fill_n(fAccum.get(), dst.width(), F4(0));
+}
+
+void SkAreaResampler::filterRow(const uint8_t* srcRow) {
+    for (int x = 0; x < fDst.width(); x++) {
+        const uint8_t* src = srcRow + 4 * fFirstSrcX[x];
+        F4 sum = 0;
+        for (int w = fWeightStart[x]; w < fWeightStart[x + 1]; w++) {
+            sum += skvx::cast<float>(skvx::Vec<4, uint8_t>::Load(src)) * fWeights[w];
+            src += 4;
+        }
+        fFiltered[x] = sum;
+    }
+}
+
+void SkAreaResampler::writeRow() {
+    const int y = fBottomUp ? fDst.height() - 1 - fDstY : fDstY;
+    uint8_t* dst = static_cast<uint8_t*>(fDst.writable_addr(0, y));
+    for (int x = 0; x < fDst.width(); x++) {
+        // The weights sum to one, up to rounding, so this only clamps rounding error.
+        skvx::cast<uint8_t>(min(fAccum[x] + 0.5f, 255.0f)).store(dst + 4 * x);
+        fAccum[x] = 0;
+    }
+    fDstY++;
+}
+
+void SkAreaResampler::accumulateRow(const void* srcRow) {
+    SkASSERT(fSrcY < fSrcHeight);
+    if (this->isComplete()) {
+        return;
+    }
+    this->filterRow(static_cast<const uint8_t*>(srcRow));
+
+    // This source row may finish one destination row and start the next, or, when
+    // upscaling, cover several destination rows.
+    const int64_t dstHeight = fDst.height();
+    int64_t top = fSrcY * dstHeight;
+    const int64_t bottom = top + dstHeight;
+    while (top < bottom && !this->isComplete()) {
+        const int64_t rowEnd = (fDstY + 1) * (int64_t)fSrcHeight;
+        const int64_t end = std::min(bottom, rowEnd);
+        const float weight = (float)(end - top) / fSrcHeight;
+        for (int x = 0; x < fDst.width(); x++) {
+            fAccum[x] += fFiltered[x] * weight;
+        }
+        top = end;
+        if (end == rowEnd) {
+            this->writeRow();
+        }
+    }
+    fSrcY++;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef SkAreaResampler_DEFINED
+#define SkAreaResampler_DEFINED
+
+#include "include/core/SkPixmap.h"
+#include "include/private/SkNoncopyable.h"
+#include "include/private/SkTemplates.h"
+#include "include/private/SkVx.h"
+
+/**
+ *  Resamples a stream of 4 byte per pixel rows to the size of a destination pixmap,
+ *  averaging each destination pixel over the area of the source it covers.
+ *
+ *  Rows are consumed one at a time, so only one row of the source and two rows of the
+ *  destination (both as floats) are held at once. This is meant for downscaling; it
+ *  works when upscaling, but then reduces to a nearest neighbor filter.
+ */
+class SkAreaResampler : SkNoncopyable {
+public:
+    /**
+     *  @param dst       Must have 4 bytes per pixel. Each channel is averaged independently,
+     *                   so the source should be premultiplied.
+     *  @param bottomUp  If true, source rows arrive bottom to top.
+     */
+    SkAreaResampler(int srcWidth, int srcHeight, const SkPixmap& dst, bool bottomUp);
+
+    /**
+     *  Adds the next source row, which must be srcWidth pixels wide. Destination rows
+     *  are written as soon as all of the source rows they cover have been added.
+     */
+    void accumulateRow(const void* srcRow);
+
+    bool isComplete() const { return fDstY == fDst.height(); }
+
+private:
+    using F4 = skvx::Vec<4, float>;
+
+    void filterRow(const uint8_t* srcRow);
+    void writeRow();
+
+    const int                     fSrcWidth;
+    const int                     fSrcHeight;
+    const SkPixmap                fDst;
+    const bool                    fBottomUp;
+
+    // For each destination column, the first source column it covers and where its
+    // weights start in fWeights. Column x's weights end where column x + 1's begin.
+    SkAutoTMalloc<int>            fFirstSrcX;
+    SkAutoTMalloc<int>            fWeightStart;
+    SkAutoTMalloc<float>          fWeights;
+
+    SkAutoTMalloc<F4>             fFiltered;  // The current source row, filtered horizontally.
+    SkAutoTMalloc<F4>             fAccum;     // The destination row being accumulated.
+
+    int                           fSrcY;
+    int                           fDstY;
+};
+
+#endif  // SkAreaResampler_DEFINED
@@ -9,6 +9,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/private/SkHalf.h"
+#include "src/codec/SkAreaResampler.h"
 #include "src/codec/SkBmpCodec.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkFrameHolder.h"
@@ -400,6 +401,70 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& info, void* pixels, size_t
     return result;
 }
 
+SkCodec::Result SkCodec::getResampledPixels(const SkPixmap& pm, const Options* options) {
+    const SkImageInfo& dstInfo = pm.info();
+    if (!pm.addr() || dstInfo.isEmpty()) {
+        return kInvalidParameters;
+    }
+    if (options && options->fSubset) {
+        return kUnimplemented;
+    }
+    if ((kRGBA_8888_SkColorType != dstInfo.colorType() &&
+         kBGRA_8888_SkColorType != dstInfo.colorType()) ||
+        kUnpremul_SkAlphaType == dstInfo.alphaType()) {
+        return kInvalidConversion;
+    }
+    if (dstInfo.dimensions() == this->dimensions()) {
+        return this->getPixels(pm, options);
+    }
+
+    // Find the smallest native size that covers pm. Codecs may round the scale down
+    // (e.g. JPEG's eighths), so step up until the size is large enough.
+    float scale = std::max((float)dstInfo.width()  / this->dimensions().width(),
+                           (float)dstInfo.height() / this->dimensions().height());
+    SkISize srcSize = this->getScaledDimensions(scale);
+    while (srcSize.width() < dstInfo.width() || srcSize.height() < dstInfo.height()) {
+        if (scale >= 1.0f) {
+            srcSize = this->dimensions();
+            break;
+        }
+        scale += 1.0f / 16;
+        srcSize = this->getScaledDimensions(scale);
+    }
+    const SkImageInfo srcInfo = dstInfo.makeDimensions(srcSize);
+
+    Result result = this->startScanlineDecode(srcInfo, options);
+    if (kSuccess == result) {
+        SkAreaResampler resampler(srcSize.width(), srcSize.height(), pm,
+                                  kBottomUp_SkScanlineOrder == this->getScanlineOrder());
+        SkAutoTMalloc<uint8_t> row(srcInfo.minRowBytes());
+        for (int y = 0; y < srcSize.height(); y++) {
+            // After a failure, getScanlines() has filled the row, so keep using it.
+            if (kSuccess == result && 1 != this->getScanlines(row.get(), 1, srcInfo.minRowBytes())) {
+                result = kIncompleteInput;
+            }
+            resampler.accumulateRow(row.get());
+        }
+        return result;
+    }
+    if (kUnimplemented != result) {
+        return result;
+    }
+
+    // No scanline decoder, so decode the intermediate image all at once.
+    const size_t rowBytes = srcInfo.minRowBytes();
+    SkAutoTMalloc<uint8_t> pixels(srcInfo.computeByteSize(rowBytes));
+    result = this->getPixels(srcInfo, pixels.get(), rowBytes, options);
+    if (kSuccess != result && kIncompleteInput != result && kErrorInInput != result) {
+        return result;
+    }
+    SkAreaResampler resampler(srcSize.width(), srcSize.height(), pm, false);
+    for (int y = 0; y < srcSize.height(); y++) {
+        resampler.accumulateRow(pixels.get() + y * rowBytes);
+    }
+    return result;
+}
+
 SkCodec::Result SkCodec::startIncrementalDecode(const SkImageInfo& info, void* pixels,
         size_t rowBytes, const SkCodec::Options* options) {
     fStartedIncrementalDecode = false;
@@ -8,6 +8,7 @@
 #include "src/codec/SkJpegCodec.h"
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
@@ -16,8 +17,12 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkParseEncodedOrigin.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkJpegInfo.h"
 
+#include <atomic>
+#include <vector>
+
 // stdio is needed for libjpeg-turbo
 #include <stdio.h>
 #include "src/codec/SkJpegUtility.h"
@@ -519,6 +524,286 @@ static inline bool needs_swizzler_to_convert_from_cmyk(J_COLOR_SPACE jpegColorTy
     return !hasCMYKColorSpace || !hasColorSpaceXform;
 }
 
+static int read_be16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+namespace {
+/*
+ * Where the restart intervals of a single scan, sequential jpeg begin.  A band of MCU rows that
+ * starts on a restart interval can be decoded on its own, by giving a decompress struct the
+ * header, with the image height patched, followed by that band's entropy coded data.
+ */
+struct JpegRestartLayout {
+    size_t              fHeaderSize;      // Everything up to the entropy coded data.
+    size_t              fHeightOffset;    // Offset of the image height in the SOF segment.
+    size_t              fScanEnd;         // Offset of the EOI marker which ends the scan.
+    int                 fHeight;
+    int                 fMCUHeight;       // In source rows.
+    int                 fMCURows;
+    std::vector<int>    fRestartRows;     // MCU rows that begin a restart interval, from 0.
+    std::vector<size_t> fRestartOffsets;  // Offset of the entropy coded data of each.
+};
+}  // namespace
+
+static bool parse_restart_layout(const uint8_t* data, size_t size, JpegRestartLayout* layout) {
+    if (!SkJpegCodec::IsJpeg(data, size)) {
+        return false;
+    }
+
+    int restartInterval = 0;
+    int width = 0, numComponents = 0, scanComponents = 0;
+    int maxH = 1, maxV = 1;
+    layout->fHeight = 0;
+    size_t pos = 2;
+    for (;;) {
+        if (pos + 4 > size || data[pos] != 0xFF) {
+            return false;
+        }
+        while (pos + 4 <= size && data[pos + 1] == 0xFF) {
+            pos++;  // Fill bytes.
+        }
+        const uint8_t marker = data[pos + 1];
+        const size_t length = read_be16(data + pos + 2);
+        const uint8_t* segment = data + pos + 4;
+        if (length < 2 || pos + 2 + length > size) {
+            return false;
+        }
+        const size_t segmentSize = length - 2;
+
+        if (marker == 0xC0 || marker == 0xC1) {
+            // Baseline or extended sequential, Huffman coded.
+            if (segmentSize < 6) {
+                return false;
+            }
+            layout->fHeightOffset = pos + 5;
+            layout->fHeight = read_be16(segment + 1);
+            width = read_be16(segment + 3);
+            numComponents = segment[5];
+            if (segmentSize < 6 + 3 * (size_t)numComponents) {
+                return false;
+            }
+            for (int i = 0; i < numComponents; i++) {
+                uint8_t sampling = segment[6 + 3 * i + 1];
+                maxH = std::max(maxH, sampling >> 4);
+                maxV = std::max(maxV, sampling & 0xF);
+            }
+        } else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+                   marker != 0xCC) {
+            // Progressive, lossless, hierarchical or arithmetic coded.
+            return false;
+        } else if (marker == 0xDD) {
+            if (segmentSize < 2) {
+                return false;
+            }
+            restartInterval = read_be16(segment);
+        } else if (marker == 0xDA) {
+            if (segmentSize < 1) {
+                return false;
+            }
+            scanComponents = segment[0];
+            layout->fHeaderSize = pos + 2 + length;
+            break;
+        }
+        pos += 2 + length;
+    }
+
+    if (restartInterval == 0 || layout->fHeight == 0 || width == 0) {
+        return false;
+    }
+
+    // An interleaved scan codes MCUs of maxH x maxV blocks; a single component scan codes blocks.
+    int mcuWidth;
+    if (scanComponents == numComponents && numComponents > 1) {
+        mcuWidth = 8 * maxH;
+        layout->fMCUHeight = 8 * maxV;
+    } else if (scanComponents == 1 && numComponents == 1) {
+        mcuWidth = 8;
+        layout->fMCUHeight = 8;
+    } else {
+        return false;
+    }
+    const int mcusPerRow = (width + mcuWidth - 1) / mcuWidth;
+    layout->fMCURows = (layout->fHeight + layout->fMCUHeight - 1) / layout->fMCUHeight;
+
+    layout->fRestartRows = { 0 };
+    layout->fRestartOffsets = { layout->fHeaderSize };
+    int64_t restarts = 0;
+    for (pos = layout->fHeaderSize; ; pos += 2) {
+        auto next = (const uint8_t*)memchr(data + pos, 0xFF, size - pos);
+        if (!next || next + 1 >= data + size) {
+            return false;  // Truncated; the serial decoder handles incomplete images.
+        }
+        pos = next - data;
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0x00) {
+            continue;  // A stuffed 0xFF data byte.
+        }
+        if (marker == 0xFF) {
+            pos--;     // A fill byte; look at the next one.
+            continue;
+        }
+        if (marker < 0xD0 || marker > 0xD7) {
+            // Only a single scan, with nothing like a DNL marker after it, is supported.
+            if (marker != 0xD9) {
+                return false;
+            }
+            layout->fScanEnd = pos;
+            break;
+        }
+        int64_t mcu = ++restarts * restartInterval;
+        if (mcu % mcusPerRow == 0 && mcu / mcusPerRow < layout->fMCURows) {
+            layout->fRestartRows.push_back(SkToInt(mcu / mcusPerRow));
+            layout->fRestartOffsets.push_back(pos + 2);
+        }
+    }
+    return true;
+}
+
+/*
+ * Builds a jpeg holding the source MCU rows [fRestartRows[first], fRestartRows[end]), or through
+ * the last row if end is past the last restart row.
+ */
+static sk_sp<SkData> make_band(const uint8_t* data, const JpegRestartLayout& layout,
+                               size_t first, size_t end) {
+    const size_t count = layout.fRestartRows.size();
+    const size_t begin = layout.fRestartOffsets[first];
+    // Drop the RST marker in front of the next band.
+    const size_t stop = end < count ? layout.fRestartOffsets[end] - 2 : layout.fScanEnd;
+    const int top = layout.fRestartRows[first] * layout.fMCUHeight;
+    const int bottom = end < count ? layout.fRestartRows[end] * layout.fMCUHeight
+                                   : layout.fHeight;
+
+    sk_sp<SkData> band = SkData::MakeUninitialized(layout.fHeaderSize + (stop - begin) + 2);
+    uint8_t* dst = (uint8_t*)band->writable_data();
+    memcpy(dst, data, layout.fHeaderSize);
+    dst[layout.fHeightOffset + 0] = (bottom - top) >> 8;
+    dst[layout.fHeightOffset + 1] = (bottom - top) & 0xFF;
+    dst += layout.fHeaderSize;
+    memcpy(dst, data + begin, stop - begin);
+
+    // The decoder expects restart markers to count up from RST0.
+    int restart = 0;
+    for (size_t i = 0; i + 1 < stop - begin; i++) {
+        if (dst[i] == 0xFF && dst[i + 1] >= 0xD0 && dst[i + 1] <= 0xD7) {
+            dst[i + 1] = 0xD0 + (restart++ & 7);
+            i++;
+        } else if (dst[i] == 0xFF && dst[i + 1] == 0x00) {
+            i++;
+        }
+    }
+    dst += stop - begin;
+    dst[0] = 0xFF;
+    dst[1] = 0xD9;
+    return band;
+}
+
+// Each band is at least this many restart rows, so the overlap decoded around it stays small.
+static constexpr size_t kMinRestartRowsPerBand = 4;
+static constexpr size_t kMaxBands = 32;
+
+bool SkJpegCodec::decodeInParallel(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                   SkExecutor* executor) {
+    SkStream* stream = this->stream();
+    if (!stream->hasLength() || !stream->getMemoryBase()) {
+        return false;
+    }
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (JCS_CMYK == dinfo->out_color_space) {
+        // CMYK needs the swizzler, which is not shared across threads.
+        return false;
+    }
+
+    const uint8_t* data = (const uint8_t*)stream->getMemoryBase();
+    JpegRestartLayout layout;
+    if (!parse_restart_layout(data, stream->getLength(), &layout) ||
+        layout.fHeight != this->dimensions().height()) {
+        return false;
+    }
+    const size_t restartRows = layout.fRestartRows.size();
+    const size_t numBands = std::min(kMaxBands, restartRows / kMinRestartRowsPerBand);
+    if (numBands < 2) {
+        return false;
+    }
+
+    // Scaled decodes only work if each MCU row still maps to whole output rows.
+    if ((layout.fMCUHeight * dinfo->scale_num) % dinfo->scale_denom) {
+        return false;
+    }
+    const int outRowsPerMCURow = layout.fMCUHeight * dinfo->scale_num / dinfo->scale_denom;
+
+    const J_COLOR_SPACE outColorSpace = dinfo->out_color_space;
+    const J_DITHER_MODE ditherMode = dinfo->dither_mode;
+    const unsigned int scaleNum = dinfo->scale_num, scaleDenom = dinfo->scale_denom;
+    const bool xformInPlace = this->colorXform() && sizeof(uint32_t) == dstInfo.bytesPerPixel();
+    const bool xformFromRow = this->colorXform() && !xformInPlace;
+    const int width = dstInfo.width();
+
+    std::atomic<bool> failed{false};
+    SkTaskGroup taskGroup(*executor);
+    taskGroup.batch(SkToInt(numBands), [&](int i) {
+        // This band outputs restart rows [first, end).  It decodes from one restart row earlier
+        // and through one restart row later, so upsampling sees the same neighboring rows as a
+        // serial decode, then drops the extra rows.
+        const size_t first = i * restartRows / numBands,
+                     end   = (i + 1) * restartRows / numBands;
+        const size_t decodeFirst = first > 0 ? first - 1 : 0,
+                     decodeEnd   = std::min(end + 1, restartRows);
+
+        SkMemoryStream bandStream(make_band(data, layout, decodeFirst, decodeEnd));
+        JpegDecoderMgr decoderMgr(&bandStream);
+        // Big enough for any output color space; allocated before setjmp() so it isn't leaked.
+        SkAutoTMalloc<uint8_t> row(width * sizeof(uint32_t));
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+        if (setjmp(jmp)) {
+            failed = true;
+            return;
+        }
+        decoderMgr.init();
+        jpeg_decompress_struct* band = decoderMgr.dinfo();
+        if (JPEG_HEADER_OK != jpeg_read_header(band, true)) {
+            failed = true;
+            return;
+        }
+        band->out_color_space = outColorSpace;
+        band->dither_mode = ditherMode;
+        band->scale_num = scaleNum;
+        band->scale_denom = scaleDenom;
+        if (!jpeg_start_decompress(band)) {
+            failed = true;
+            return;
+        }
+
+        const int skipRows = (layout.fRestartRows[first] - layout.fRestartRows[decodeFirst]) *
+                             outRowsPerMCURow;
+        for (int y = 0; y < skipRows; y++) {
+            JSAMPLE* rowPtr = row.get();
+            if (1 != jpeg_read_scanlines(band, &rowPtr, 1)) {
+                failed = true;
+                return;
+            }
+        }
+
+        const int top = layout.fRestartRows[first] * outRowsPerMCURow;
+        const int bottom = end < restartRows ? layout.fRestartRows[end] * outRowsPerMCURow
+                                             : dstInfo.height();
+        for (int y = top; y < bottom; y++) {
+            void* dstRow = SkTAddOffset<void>(dst, y * rowBytes);
+            JSAMPLE* rowPtr = xformFromRow ? row.get() : (JSAMPLE*)dstRow;
+            if (1 != jpeg_read_scanlines(band, &rowPtr, 1)) {
+                failed = true;
+                return;
+            }
+            if (xformInPlace || xformFromRow) {
+                this->applyColorXform(dstRow, rowPtr, width);
+            }
+        }
+    });
+    taskGroup.wait();
+
+    return !failed;
+}
+
 /*
  * Performs the jpeg decode
  */
@@ -534,6 +819,11 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
+    if (options.fExecutor &&
+        this->decodeInParallel(dstInfo, dst, dstRowBytes, options.fExecutor)) {
+        return kSuccess;
+    }
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
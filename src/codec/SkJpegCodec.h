@@ -109,6 +109,13 @@ private:
     bool SK_WARN_UNUSED_RESULT allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Decodes bands of MCU rows on |executor|, when the image has restart markers to split on.
+     * Returns false, possibly having written some rows, if the caller should decode serially.
+     */
+    bool decodeInParallel(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                          SkExecutor* executor);
+
     /*
      * Scanline decoding.
      */
@@ -135,6 +135,21 @@ static inline bool is_chunk(const png_byte* chunk, const char* tag) {
 
 static inline bool process_data(png_structp png_ptr, png_infop info_ptr,
         SkStream* stream, void* buffer, size_t bufferSize, size_t length) {
+    // When the encoded data is already in memory (e.g. an mmapped SkData), hand libpng a
+    // pointer into it rather than copying through the buffer. The stream is advanced first,
+    // matching the buffered path, in case libpng longjmps out partway through.
+    const void* base = stream->getMemoryBase();
+    if (base && stream->hasLength() && stream->hasPosition()) {
+        const size_t position = stream->getPosition();
+        const size_t bytesAvailable = std::min(length, stream->getLength() - position);
+        SkAssertResult(stream->skip(bytesAvailable) == bytesAvailable);
+        // libpng does not write to the input, despite the non-const signature.
+        png_process_data(png_ptr, info_ptr,
+                         const_cast<png_bytep>(static_cast<const png_byte*>(base) + position),
+                         bytesAvailable);
+        return bytesAvailable == length;
+    }
+
     while (length > 0) {
         const size_t bytesToProcess = std::min(bufferSize, length);
         const size_t bytesRead = stream->read(buffer, bytesToProcess);
@@ -72,7 +72,34 @@
 #define SK_WUFFS_INITIALIZE_FLAGS WUFFS_INITIALIZE__DEFAULT_OPTIONS
 #endif
 
+// When the whole GIF is already in memory (e.g. an mmapped SkData), the io_buffer
+// reads straight from the stream's memory instead of copying it, 4096 bytes at a
+// time, into SkWuffsCodec::fBuffer.
+static bool reads_from_memory(const wuffs_base__io_buffer* b, SkStream* s) {
+    const void* base = s->getMemoryBase();
+    return base && b->data.ptr == base;
+}
+
+static void reset_memory_buffer(wuffs_base__io_buffer* b, SkStream* s) {
+    // Wuffs only writes to the io_buffer's data in compact(), which fill_buffer
+    // never calls for memory backed streams.
+    b->data = wuffs_base__make_slice_u8(
+            const_cast<uint8_t*>(static_cast<const uint8_t*>(s->getMemoryBase())),
+            s->getLength());
+    b->meta = wuffs_base__empty_io_buffer_meta();
+    b->meta.wi = b->data.len;
+    b->meta.closed = true;
+}
+
+static bool can_read_from_memory(SkStream* s) {
+    return s->getMemoryBase() && s->hasLength() && s->hasPosition() && s->getPosition() == 0;
+}
+
 static bool fill_buffer(wuffs_base__io_buffer* b, SkStream* s) {
+    if (reads_from_memory(b, s)) {
+        // All of the data is already in the buffer.
+        return false;
+    }
     b->compact();
     size_t num_read = s->read(b->data.ptr + b->meta.wi, b->data.len - b->meta.wi);
     b->meta.wi += num_read;
@@ -88,7 +115,7 @@ static bool seek_buffer(wuffs_base__io_buffer* b, SkStream* s, uint64_t pos) {
         return true;
     }
     // Seek in the backing SkStream.
-    if ((pos > SIZE_MAX) || (!s->seek(pos))) {
+    if (reads_from_memory(b, s) || (pos > SIZE_MAX) || (!s->seek(pos))) {
         return false;
     }
     b->meta.wi = 0;
@@ -466,9 +493,17 @@ SkWuffsCodec::SkWuffsCodec(SkEncodedInfo&&
       } {
     fFrameHolder.init(this, imgcfg.pixcfg.width(), imgcfg.pixcfg.height());
 
-    // Initialize fIOBuffer's fields, copying any outstanding data from iobuf to
-    // fIOBuffer, as iobuf's backing array may not be valid for the lifetime of
-    // this SkWuffsCodec object, but fIOBuffer's backing array (fBuffer) is.
+    // A memory backed iobuf points into fStream's memory, which lives as long
+    // as this SkWuffsCodec object does.
+    if (reads_from_memory(&iobuf, fStream.get())) {
+        fIOBuffer = iobuf;
+        return;
+    }
+
+    // Otherwise, initialize fIOBuffer's fields, copying any outstanding data from
+    // iobuf to fIOBuffer, as iobuf's backing array may not be valid for the
+    // lifetime of this SkWuffsCodec object, but fIOBuffer's backing array
+    // (fBuffer) is.
     SkASSERT(iobuf.data.len == SK_WUFFS_CODEC_BUFFER_SIZE);
     memmove(fBuffer, iobuf.data.ptr, iobuf.meta.wi);
     fIOBuffer.data = wuffs_base__make_slice_u8(fBuffer, SK_WUFFS_CODEC_BUFFER_SIZE);
@@ -983,7 +1018,11 @@ SkCodec::Result SkWuffsCodec::resetDecoder(WhichDecoder which) {
     if (!fStream->rewind()) {
         return SkCodec::kInternalError;
     }
-    fIOBuffer.meta = wuffs_base__empty_io_buffer_meta();
+    if (reads_from_memory(&fIOBuffer, fStream.get())) {
+        reset_memory_buffer(&fIOBuffer, fStream.get());
+    } else {
+        fIOBuffer.meta = wuffs_base__empty_io_buffer_meta();
+    }
 
     SkCodec::Result result =
         reset_and_decode_image_config(fDecoders[which].get(), nullptr, &fIOBuffer, fStream.get());
@@ -1073,6 +1112,9 @@ std::unique_ptr<SkCodec> SkWuffsCodec_MakeFromStream(std::unique_ptr<SkStream> s
     wuffs_base__io_buffer iobuf =
         wuffs_base__make_io_buffer(wuffs_base__make_slice_u8(buffer, SK_WUFFS_CODEC_BUFFER_SIZE),
                                    wuffs_base__empty_io_buffer_meta());
+    if (can_read_from_memory(stream.get())) {
+        reset_memory_buffer(&iobuf, stream.get());
+    }
     wuffs_base__image_config imgcfg = wuffs_base__null_image_config();
 
     // Wuffs is primarily a C library, not a C++ one. Furthermore, outside of
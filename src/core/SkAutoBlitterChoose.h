@@ -45,6 +45,7 @@ public:
                                       draw.fRC->clipShader());
             fBlitter = fAlloc.make<SkPairBlitter>(fBlitter, coverageBlitter);
         }
+        fBlitter = draw.applyBlitBounds(fBlitter, &fAlloc);
         return fBlitter;
     }
 
@@ -6,12 +6,17 @@
  */
 
 #include "include/core/SkBBHFactory.h"
+#include "src/core/SkPackedRTree.h"
 #include "src/core/SkRTree.h"
 
 sk_sp<SkBBoxHierarchy> SkRTreeFactory::operator()() const {
     return sk_make_sp<SkRTree>();
 }
 
+sk_sp<SkBBoxHierarchy> SkPackedRTreeFactory::operator()() const {
+    return sk_make_sp<SkPackedRTree>();
+}
+
 void SkBBoxHierarchy::insert(const SkRect rects[], const Metadata[], int N) {
     // Ignore Metadata.
     this->insert(rects, N);
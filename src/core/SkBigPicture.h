@@ -56,9 +56,10 @@ public:
 // Used by GrRecordReplaceDraw
     const SkBBoxHierarchy* bbh() const { return fBBH.get(); }
     const SkRecord*     record() const { return fRecord.get(); }
+// Used by SkPicture::computeDamage
+    int drawableCount() const;
 
 private:
-    int drawableCount() const;
     SkPicture const* const* drawablePicts() const;
 
     const SkRect                         fCullRect;
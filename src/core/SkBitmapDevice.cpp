@@ -16,6 +16,7 @@
 #include "include/core/SkVertices.h"
 #include "src/core/SkBitmapDevice.h"
 #include "src/core/SkDraw.h"
+#include "src/core/SkDrawTiler.h"
 #include "src/core/SkGlyphRun.h"
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilter_Base.h"
@@ -25,154 +26,6 @@
 #include "src/core/SkTLazy.h"
 #include "src/image/SkImage_Base.h"
 
-struct Bounder {
-    SkRect  fBounds;
-    bool    fHasBounds;
-
-    Bounder(const SkRect& r, const SkPaint& paint) {
-        if ((fHasBounds = paint.canComputeFastBounds())) {
-            fBounds = paint.computeFastBounds(r, &fBounds);
-        }
-    }
-
-    bool hasBounds() const { return fHasBounds; }
-    const SkRect* bounds() const { return fHasBounds ? &fBounds : nullptr; }
-    operator const SkRect* () const { return this->bounds(); }
-};
-
-class SkDrawTiler {
-    enum {
-        // 8K is 1 too big, since 8K << supersample == 32768 which is too big for SkFixed
-        kMaxDim = 8192 - 1
-    };
-
-    SkBitmapDevice* fDevice;
-    SkPixmap        fRootPixmap;
-    SkIRect         fSrcBounds;
-
-    // Used for tiling and non-tiling
-    SkDraw          fDraw;
-
-    // fCurr... are only used if fNeedTiling
-    SkTLazy<SkPostTranslateMatrixProvider> fTileMatrixProvider;
-    SkRasterClip                           fTileRC;
-    SkIPoint                               fOrigin;
-
-    bool            fDone, fNeedsTiling;
-
-public:
-    static bool NeedsTiling(SkBitmapDevice* dev) {
-        return dev->width() > kMaxDim || dev->height() > kMaxDim;
-    }
-
-    SkDrawTiler(SkBitmapDevice* dev, const SkRect* bounds) : fDevice(dev) {
-        fDone = false;
-
-        // we need fDst to be set, and if we're actually drawing, to dirty the genID
-        if (!dev->accessPixels(&fRootPixmap)) {
-            // NoDrawDevice uses us (why?) so we have to catch this case w/ no pixels
-            fRootPixmap.reset(dev->imageInfo(), nullptr, 0);
-        }
-
-        // do a quick check, so we don't even have to process "bounds" if there is no need
-        const SkIRect clipR = dev->fRCStack.rc().getBounds();
-        fNeedsTiling = clipR.right() > kMaxDim || clipR.bottom() > kMaxDim;
-        if (fNeedsTiling) {
-            if (bounds) {
-                // Make sure we round first, and then intersect. We can't rely on promoting the
-                // clipR to floats (and then intersecting with devBounds) since promoting
-                // int --> float can make the float larger than the int.
-                // rounding(out) first runs the risk of clamping if the float is larger an intmax
-                // but our roundOut() is saturating, which is fine for this use case
-                //
-                // e.g. the older version of this code did this:
-                //    devBounds = mapRect(bounds);
-                //    if (devBounds.intersect(SkRect::Make(clipR))) {
-                //        fSrcBounds = devBounds.roundOut();
-                // The problem being that the promotion of clipR to SkRect was unreliable
-                //
-                fSrcBounds = dev->localToDevice().mapRect(*bounds).roundOut();
-                if (fSrcBounds.intersect(clipR)) {
-                    // Check again, now that we have computed srcbounds.
-                    fNeedsTiling = fSrcBounds.right() > kMaxDim || fSrcBounds.bottom() > kMaxDim;
-                } else {
-                    fNeedsTiling = false;
-                    fDone = true;
-                }
-            } else {
-                fSrcBounds = clipR;
-            }
-        }
-
-        if (fNeedsTiling) {
-            // fDraw.fDst and fMatrixProvider are reset each time in setupTileDraw()
-            fDraw.fRC = &fTileRC;
-            // we'll step/increase it before using it
-            fOrigin.set(fSrcBounds.fLeft - kMaxDim, fSrcBounds.fTop);
-        } else {
-            // don't reference fSrcBounds, as it may not have been set
-            fDraw.fDst = fRootPixmap;
-            fDraw.fMatrixProvider = dev;
-            fDraw.fRC = &dev->fRCStack.rc();
-            fOrigin.set(0, 0);
-
-            fDraw.fCoverage = dev->accessCoverage();
-        }
-    }
-
-    bool needsTiling() const { return fNeedsTiling; }
-
-    const SkDraw* next() {
-        if (fDone) {
-            return nullptr;
-        }
-        if (fNeedsTiling) {
-            do {
-                this->stepAndSetupTileDraw();  // might set the clip to empty and fDone to true
-            } while (!fDone && fTileRC.isEmpty());
-            // if we exit the loop and we're still empty, we're (past) done
-            if (fTileRC.isEmpty()) {
-                SkASSERT(fDone);
-                return nullptr;
-            }
-            SkASSERT(!fTileRC.isEmpty());
-        } else {
-            fDone = true;   // only draw untiled once
-        }
-        return &fDraw;
-    }
-
-private:
-    void stepAndSetupTileDraw() {
-        SkASSERT(!fDone);
-        SkASSERT(fNeedsTiling);
-
-        // We do fRootPixmap.width() - kMaxDim instead of fOrigin.fX + kMaxDim to avoid overflow.
-        if (fOrigin.fX >= fSrcBounds.fRight - kMaxDim) {    // too far
-            fOrigin.fX = fSrcBounds.fLeft;
-            fOrigin.fY += kMaxDim;
-        } else {
-            fOrigin.fX += kMaxDim;
-        }
-        // fDone = next origin will be invalid.
-        fDone = fOrigin.fX >= fSrcBounds.fRight - kMaxDim &&
-                fOrigin.fY >= fSrcBounds.fBottom - kMaxDim;
-
-        SkIRect bounds = SkIRect::MakeXYWH(fOrigin.x(), fOrigin.y(), kMaxDim, kMaxDim);
-        SkASSERT(!bounds.isEmpty());
-        bool success = fRootPixmap.extractSubset(&fDraw.fDst, bounds);
-        SkASSERT_RELEASE(success);
-        // now don't use bounds, since fDst has the clipped dimensions.
-
-        fDraw.fMatrixProvider = fTileMatrixProvider.init(fDevice->asMatrixProvider(),
-                                                         SkIntToScalar(-fOrigin.x()),
-                                                         SkIntToScalar(-fOrigin.y()));
-        fDevice->fRCStack.rc().translate(-fOrigin.x(), -fOrigin.y(), &fTileRC);
-        fTileRC.op(SkIRect::MakeWH(fDraw.fDst.width(), fDraw.fDst.height()),
-                   SkRegion::kIntersect_Op);
-    }
-};
-
 // Passing a bounds allows the tiler to only visit the dst-tiles that might intersect the
 // drawing. If null is passed, the tiler has to visit everywhere. The bounds is expected to be
 // in local coordinates, as the tiler itself will transform that into device coordinates.
@@ -394,11 +247,17 @@ void SkBitmapDevice::drawPath(const SkPath& path,
         bounds = &path.getBounds();
     }
     SkDrawTiler tiler(this, bounds ? Bounder(*bounds, paint).bounds() : nullptr);
+    SkDraw::CachePathMasks cacheMasks = SkDraw::CachePathMasks::kIfSeenRecently;
     if (tiler.needsTiling()) {
         pathIsMutable = false;
+        // Every tile draws the path, but that's still only one sighting of it.
+        cacheMasks = SkDraw::SeenPathRecently(path) ? SkDraw::CachePathMasks::kYes
+                                                    : SkDraw::CachePathMasks::kNo;
     }
-    while (const SkDraw* draw = tiler.next()) {
-        draw->drawPath(path, paint, nullptr, pathIsMutable);
+    while (const SkDraw* tileDraw = tiler.next()) {
+        SkDraw draw(*tileDraw);
+        draw.fCachePathMasks = cacheMasks;
+        draw.drawPath(path, paint, nullptr, pathIsMutable);
     }
 }
 
@@ -607,7 +466,7 @@ void SkBitmapDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPain
         const SkIRect clipBounds = fRCStack.rc().getBounds().makeOffset(-x, -y);
         sk_sp<SkImageFilterCache> cache(this->getImageFilterCache());
         SkImageFilter_Base::Context ctx(matrix, clipBounds, cache.get(), fBitmap.colorType(),
-                                        fBitmap.colorSpace(), src);
+                                        fBitmap.colorSpace(), src, this->imageFilterExecutor());
 
         filteredImage = as_IFB(filter)->filterImage(ctx).imageAndOffset(&offset);
         if (!filteredImage) {
@@ -130,8 +130,8 @@ protected:
     ClipType onGetClipType() const override;
     SkIRect onDevClipBounds() const override;
 
-    void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
-                    const SkPaint&);
+    virtual void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
+                            const SkPaint&);
 
 private:
     friend class SkCanvas;
@@ -140,6 +140,7 @@ private:
     friend class SkDrawIter;
     friend class SkDrawTiler;
     friend class SkSurface_Raster;
+    friend class SkThreadedBMPDevice;
 
     class BDDraw;
 
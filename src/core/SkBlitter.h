@@ -202,7 +202,7 @@ public:
         return fBlitter->allocBlitMemory(sz);
     }
 
-private:
+protected:
     SkBlitter*  fBlitter;
     SkIRect     fClipRect;
 };
@@ -1023,7 +1023,8 @@ void SkCanvas::DrawDeviceWithFilter(SkBaseDevice* src, const SkImageFilter* filt
     layerTargetBounds.offset(-layerInputBounds.fLeft, -layerInputBounds.fTop);
     SkMatrix filterCTM = layerMatrix;
     filterCTM.postTranslate(-layerInputBounds.fLeft, -layerInputBounds.fTop);
-    skif::Context ctx(filterCTM, layerTargetBounds, nullptr, colorType, colorSpace, special.get());
+    skif::Context ctx(filterCTM, layerTargetBounds, nullptr, colorType, colorSpace, special.get(),
+                      dst->imageFilterExecutor());
 
     SkIPoint offset;
     special = as_IFB(filter)->filterImage(ctx).imageAndOffset(&offset);
@@ -19,6 +19,7 @@
 #include "src/shaders/SkShaderBase.h"
 
 class SkBitmap;
+class SkExecutor;
 struct SkDrawShadowRec;
 class SkGlyphRun;
 class SkGlyphRunList;
@@ -319,6 +320,9 @@ protected:
     virtual GrContext* context() const { return nullptr; }
     virtual GrRecordingContext* recordingContext() const { return nullptr; }
 
+    // Raster image filters evaluated for this device may split their work across this executor.
+    virtual SkExecutor* imageFilterExecutor() const { return nullptr; }
+
     virtual sk_sp<SkSurface> makeSurface(const SkImageInfo&, const SkSurfaceProps&);
     virtual bool onPeekPixels(SkPixmap*) { return false; }
 
@@ -429,6 +433,7 @@ private:
 
     friend class SkNoPixelsDevice;
     friend class SkBitmapDevice;
+    friend class SkThreadedBMPDevice;
     void privateResize(int w, int h) {
         *const_cast<SkImageInfo*>(&fInfo) = fInfo.makeWH(w, h);
     }
@@ -15,6 +15,7 @@
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
 #include "include/core/SkStrokeRec.h"
+#include "include/private/SkChecksum.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkMacros.h"
 #include "include/private/SkTemplates.h"
@@ -25,6 +26,7 @@
 #include "src/core/SkBlitter.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkDrawProcs.h"
+#include "src/core/SkMaskCache.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkMatrixUtils.h"
 #include "src/core/SkPathPriv.h"
@@ -33,8 +35,11 @@
 #include "src/core/SkScan.h"
 #include "src/core/SkStroke.h"
 #include "src/core/SkTLazy.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkUtils.h"
 
+#include <algorithm>
+#include <atomic>
 #include <utility>
 
 static SkPaint make_paint_with_image(
@@ -67,6 +72,45 @@ bool SkDraw::computeConservativeLocalClipBounds(SkRect* localBounds) const {
     return true;
 }
 
+namespace {
+// Clips to SkDraw::fBlitBounds. Some of our fast paths ask for the destination pixels and write
+// to them directly, which would bypass the clipping, so we don't hand them out.
+class BlitBoundsBlitter final : public SkRectClipBlitter {
+public:
+    // Blitters may blend these pairs differently than blitAntiH(), so pass them through
+    // whenever we can. Only pairs straddling our bounds fall back to blitAntiH().
+    void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override {
+        if (fClipRect.contains(SkIRect::MakeXYWH(x, y, 2, 1))) {
+            fBlitter->blitAntiH2(x, y, a0, a1);
+        } else {
+            this->INHERITED::blitAntiH2(x, y, a0, a1);
+        }
+    }
+    void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override {
+        if (fClipRect.contains(SkIRect::MakeXYWH(x, y, 1, 2))) {
+            fBlitter->blitAntiV2(x, y, a0, a1);
+        } else {
+            this->INHERITED::blitAntiV2(x, y, a0, a1);
+        }
+    }
+
+    const SkPixmap* justAnOpaqueColor(uint32_t*) override { return nullptr; }
+
+private:
+    typedef SkRectClipBlitter INHERITED;
+};
+}  // namespace
+
+SkBlitter* SkDraw::applyBlitBounds(SkBlitter* blitter, SkArenaAlloc* alloc) const {
+    if (!fBlitBounds || !blitter) {
+        return blitter;
+    }
+    SkASSERT(!fBlitBounds->isEmpty());
+    auto wrapper = alloc->make<BlitBoundsBlitter>();
+    wrapper->init(blitter, *fBlitBounds);
+    return wrapper;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkDraw::drawPaint(const SkPaint& paint) const {
@@ -819,6 +863,11 @@ void SkDraw::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool drawC
     if (SkPathPriv::TooBigForMath(devPath)) {
         return;
     }
+    if (fExecutor && doFill && !customBlitter && !paint.getMaskFilter() &&
+            this->drawDevPathBanded(devPath, paint, drawCoverage)) {
+        return;
+    }
+
     SkBlitter* blitter = nullptr;
     SkAutoBlitterChoose blitterStorage;
     if (nullptr == customBlitter) {
@@ -880,6 +929,135 @@ void SkDraw::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool drawC
     proc(devPath, *fRC, blitter);
 }
 
+bool SkDraw::drawDevPathBanded(const SkPath& devPath, const SkPaint& paint,
+                               bool drawCoverage) const {
+    // Each band clips every edge of the path to its rows, so bands should be tall enough that
+    // walking their edges costs more than that.
+    static constexpr int kMinBandHeight = 32,
+                         kMaxBands      = 16;
+
+    if (devPath.countPoints() < kMinBandedPathPoints || devPath.isInverseFillType()) {
+        return false;
+    }
+
+    // The bands share devPath, so compute what it caches lazily before they race to.
+    SkIRect bounds = devPath.getBounds().roundOut();
+    (void)devPath.isConvex();
+    if (!bounds.intersect(fRC->getBounds())) {
+        return false;
+    }
+    const int bands = std::min(bounds.height() / kMinBandHeight, kMaxBands);
+    if (bands < 2) {
+        return false;
+    }
+
+    void (*proc)(const SkPath&, const SkRasterClip&, SkBlitter*);
+    if (paint.isAntiAlias()) {
+        proc = SkScan::AntiFillPath;
+    } else {
+        proc = SkScan::FillPath;
+    }
+    SkTaskGroup tasks(*fExecutor);
+    tasks.batch(bands, [&](int i) {
+        const SkIRect band = SkIRect::MakeLTRB(bounds.fLeft,
+                                               bounds.fTop + bounds.height() *  i      / bands,
+                                               bounds.fRight,
+                                               bounds.fTop + bounds.height() * (i + 1) / bands);
+        SkRasterClip rc(*fRC);
+        if (!rc.op(band, SkRegion::kIntersect_Op)) {
+            return;
+        }
+
+        SkDraw draw(*this);
+        draw.fRC = &rc;
+        draw.fExecutor = nullptr;
+        SkAutoBlitterChoose blitter(draw, nullptr, paint, drawCoverage);
+        proc(devPath, rc, blitter.get());
+    });
+    tasks.wait();
+    return true;
+}
+
+// Remembers the generation IDs of recently drawn paths. Colliding IDs just evict each other.
+bool SkDraw::SeenPathRecently(const SkPath& path) {
+    static std::atomic<uint32_t> gRecent[1024];
+    const uint32_t genID = path.getGenerationID();
+    std::atomic<uint32_t>& slot = gRecent[SkChecksum::CheapMix(genID) & 1023];
+    return slot.exchange(genID, std::memory_order_relaxed) == genID;
+}
+
+bool SkDraw::drawPathMaskCached(const SkPath& path, const SkMatrix& matrix,
+                                const SkPaint& paint) const {
+    // As with glyphs, masks are rasterized at a quarter pixel offset and blitted at whole pixels,
+    // so a path drawn at any translation shares one of 16 masks.
+    static constexpr int kSubpixelSteps = 4;
+    static constexpr SkScalar kMaxCachedMaskSize = 256;
+
+    if (!paint.isAntiAlias() || paint.getStyle() != SkPaint::kFill_Style ||
+            paint.getPathEffect() || paint.getMaskFilter() ||
+            path.isVolatile() || path.isInverseFillType() || matrix.hasPerspective()) {
+        return false;
+    }
+
+    // Keep the whole pixel part of the translation exact as a float and in range as an int.
+    const SkScalar tx = matrix.getTranslateX(),
+                   ty = matrix.getTranslateY();
+    if (!(SkScalarAbs(tx) < (1 << 22) && SkScalarAbs(ty) < (1 << 22))) {
+        return false;
+    }
+    const int ix = SkScalarFloorToInt(tx),
+              iy = SkScalarFloorToInt(ty);
+    SkMatrix maskMatrix = matrix;
+    maskMatrix.setTranslateX(SkScalarRoundToInt((tx - ix) * kSubpixelSteps) /
+                             (SkScalar)kSubpixelSteps);
+    maskMatrix.setTranslateY(SkScalarRoundToInt((ty - iy) * kSubpixelSteps) /
+                             (SkScalar)kSubpixelSteps);
+
+    const SkRect maskBounds = maskMatrix.mapRect(path.getBounds());
+    if (!(maskBounds.width()  <= kMaxCachedMaskSize &&
+          maskBounds.height() <= kMaxCachedMaskSize) ||
+            !SkIRect::Intersects(maskBounds.roundOut().makeOffset(ix, iy), fRC->getBounds())) {
+        return false;
+    }
+
+    // Many paths are built for a single draw, so by default we only cache a mask the second time
+    // we see its path. Until then we draw through an uncached mask, so that every draw of the path
+    // is rounded the same way, whether its mask is cached or not.
+    const bool cacheMask = fCachePathMasks == CachePathMasks::kIfSeenRecently
+                         ? SeenPathRecently(path)
+                         : fCachePathMasks == CachePathMasks::kYes;
+
+    SkMask mask;
+    SkCachedData* data = cacheMask ? SkMaskCache::FindAndRef(path, maskMatrix, &mask) : nullptr;
+    if (!data) {
+        SkPath maskPath;
+        path.transform(maskMatrix, &maskPath);
+        maskPath.setIsVolatile(true);
+        if (!DrawToMask(maskPath, nullptr, nullptr, nullptr, &mask,
+                        SkMask::kJustComputeBounds_CreateMode, SkStrokeRec::kFill_InitStyle)) {
+            return false;
+        }
+        mask.fFormat   = SkMask::kA8_Format;
+        mask.fRowBytes = mask.fBounds.width();
+        data = SkResourceCache::NewCachedData(mask.computeImageSize());
+        if (!data) {
+            return false;
+        }
+        mask.fImage = (uint8_t*)data->writable_data();
+        sk_bzero(mask.fImage, data->size());
+        DrawToMask(maskPath, nullptr, nullptr, nullptr, &mask,
+                   SkMask::kJustRenderImage_CreateMode, SkStrokeRec::kFill_InitStyle);
+        if (cacheMask) {
+            SkMaskCache::Add(path, maskMatrix, mask, data);
+        }
+    }
+
+    mask.fBounds.offset(ix, iy);
+    this->drawDevMask(mask, paint);
+    data->unref();
+    return true;
+}
+
 void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
                       const SkMatrix* prePathMatrix, bool pathIsMutable,
                       bool drawCoverage, SkBlitter* customBlitter) const {
@@ -941,6 +1119,11 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
         }
     }
 
+    if (!drawCoverage && !customBlitter &&
+            this->drawPathMaskCached(*pathPtr, matrixProvider->localToDevice(), *paint)) {
+        return;
+    }
+
     if (paint->getPathEffect() || paint->getStyle() != SkPaint::kFill_Style) {
         SkRect cullRect;
         const SkRect* cullRectPtr = nullptr;
@@ -1105,6 +1288,7 @@ void SkDraw::drawBitmap(const SkBitmap& bitmap, const SkMatrix& prematrix,
             SkBlitter* blitter = SkBlitter::ChooseSprite(fDst, *paint, pmap, ix, iy, &allocator,
                                                          fRC->clipShader());
             if (blitter) {
+                blitter = this->applyBlitBounds(blitter, &allocator);
                 SkScan::FillIRect(SkIRect::MakeXYWH(ix, iy, pmap.width(), pmap.height()),
                                   *fRC, blitter);
                 return;
@@ -1161,6 +1345,7 @@ void SkDraw::drawSprite(const SkBitmap& bitmap, int x, int y, const SkPaint& ori
         SkBlitter* blitter = SkBlitter::ChooseSprite(fDst, paint, pmap, x, y, &allocator,
                                                      fRC->clipShader());
         if (blitter) {
+            blitter = this->applyBlitBounds(blitter, &allocator);
             SkScan::FillIRect(bounds, *fRC, blitter);
             return;
         }
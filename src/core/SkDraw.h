@@ -17,8 +17,10 @@
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkMask.h"
 
+class SkArenaAlloc;
 class SkBitmap;
 class SkClipStack;
+class SkExecutor;
 class SkBaseDevice;
 class SkBlitter;
 class SkMatrix;
@@ -65,7 +67,7 @@ public:
                              SkGlyphRunListPainter* glyphPainter) const;
     void    drawVertices(const SkVertices*, SkBlendMode, const SkPaint&) const;
     void  drawAtlas(const SkImage*, const SkRSXform[], const SkRect[], const SkColor[], int count,
-                    SkBlendMode, const SkPaint&);
+                    SkBlendMode, const SkPaint&) const;
 
     /**
      *  Overwrite the target with the path's coverage (i.e. its mask).
@@ -123,6 +125,10 @@ public:
 
     static SkScalar ComputeResScaleForStroking(const SkMatrix& );
 
+    // Filled paths with at least this many points are scan converted in bands if we have an
+    // fExecutor. Fewer edges than this aren't worth a task per band.
+    static constexpr int kMinBandedPathPoints = 1 << 12;
+
 private:
     void drawBitmapAsMask(const SkBitmap&, const SkPaint&) const;
     void draw_fixed_vertices(const SkVertices*, SkBlendMode, const SkPaint&, const SkMatrix&,
@@ -144,6 +150,15 @@ private:
                      bool drawCoverage,
                      SkBlitter* customBlitter,
                      bool doFill) const;
+    // Draws a small antialiased filled path through a coverage mask rasterized at a quarter pixel
+    // translation, and kept in SkMaskCache as fCachePathMasks says, so redrawing the same path
+    // at another translation just blits the mask. Returns false if the path and paint aren't
+    // suitable, and should be drawn as usual.
+    bool drawPathMaskCached(const SkPath& path, const SkMatrix& matrix,
+                            const SkPaint& paint) const;
+    // Fills devPath in horizontal bands, concurrently on fExecutor. Returns false if the path
+    // isn't worth splitting, and should be drawn as usual.
+    bool drawDevPathBanded(const SkPath& devPath, const SkPaint& paint, bool drawCoverage) const;
     /**
      *  Return the current clip bounds, in local coordinates, with slop to account
      *  for antialiasing or hairlines (i.e. device-bounds outset by 1, and then
@@ -162,6 +177,30 @@ public:
     // optional, will be same dimensions as fDst if present
     const SkPixmap* fCoverage{nullptr};
 
+    // optional, if present every blit is clipped to it. Unlike fRC this does not change how the
+    // geometry is rasterized, so splitting a draw across disjoint fBlitBounds produces exactly
+    // the pixels of a single draw.
+    const SkIRect*  fBlitBounds{nullptr};
+
+    // optional, if present very large filled paths are split into bands of rows, each clipping
+    // the path's edges to its rows and scan converting them with its own blitter on fExecutor.
+    // Edges are chopped at band boundaries, so their coverage can round slightly differently
+    // than in a single scan conversion.
+    SkExecutor*     fExecutor{nullptr};
+
+    // Whether drawPath() keeps the masks of the small antialiased fills it draws through them in
+    // SkMaskCache. By default it does once SeenPathRecently(), i.e. from the second draw of a
+    // path on. Callers replaying one draw several times, e.g. once per fBlitBounds, ask once and
+    // pass the answer on. This never changes the pixels drawn.
+    enum class CachePathMasks { kIfSeenRecently, kYes, kNo };
+    CachePathMasks  fCachePathMasks{CachePathMasks::kIfSeenRecently};
+
+    // Returns whether path was drawn recently, and remembers that it was drawn now.
+    static bool SeenPathRecently(const SkPath& path);
+
+    // Returns blitter, wrapped (in alloc) to respect fBlitBounds if we have one.
+    SkBlitter* applyBlitBounds(SkBlitter* blitter, SkArenaAlloc* alloc) const;
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
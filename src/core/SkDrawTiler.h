@@ -0,0 +1,200 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDrawTiler_DEFINED
+#define SkDrawTiler_DEFINED
+
+#include "include/core/SkPaint.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkDraw.h"
+#include "src/core/SkMatrixProvider.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkTLazy.h"
+
+struct Bounder {
+    SkRect  fBounds;
+    bool    fHasBounds;
+
+    Bounder(const SkRect& r, const SkPaint& paint) {
+        if ((fHasBounds = paint.canComputeFastBounds())) {
+            fBounds = paint.computeFastBounds(r, &fBounds);
+        }
+    }
+
+    bool hasBounds() const { return fHasBounds; }
+    const SkRect* bounds() const { return fHasBounds ? &fBounds : nullptr; }
+    operator const SkRect* () const { return this->bounds(); }
+};
+
+class SkDrawTiler {
+    enum {
+        // 8K is 1 too big, since 8K << supersample == 32768 which is too big for SkFixed
+        kMaxDim = 8192 - 1
+    };
+
+    SkPixmap                fRootPixmap;
+    const SkMatrixProvider* fMatrixProvider;
+    const SkRasterClip*     fRC;
+    SkIRect                 fSrcBounds;
+
+    // Used for tiling and non-tiling
+    SkDraw          fDraw;
+
+    // fCurr... are only used if fNeedTiling
+    SkTLazy<SkPostTranslateMatrixProvider> fTileMatrixProvider;
+    SkRasterClip                           fTileRC;
+    SkIPoint                               fOrigin;
+
+    // Optional, in root pixmap coordinates. fTileBlitBounds is the same rect relative to fOrigin.
+    const SkIRect*  fBlitBounds;
+    SkIRect         fTileBlitBounds;
+
+    bool            fDone, fNeedsTiling;
+
+public:
+    static bool NeedsTiling(SkBitmapDevice* dev) {
+        return dev->width() > kMaxDim || dev->height() > kMaxDim;
+    }
+
+    SkDrawTiler(SkBitmapDevice* dev, const SkRect* bounds)
+            : SkDrawTiler(root_pixmap(dev), *dev, dev->fRCStack.rc(), bounds, nullptr) {
+        if (!fNeedsTiling) {
+            fDraw.fCoverage = dev->accessCoverage();
+        }
+    }
+
+    // Tiles a draw against an explicit pixmap, matrix and clip instead of a device's current
+    // state. If blitBounds is not null, each SkDraw we return only blits inside of it, and tiles
+    // that don't touch it are skipped.
+    SkDrawTiler(const SkPixmap& root, const SkMatrixProvider& matrixProvider,
+                const SkRasterClip& rc, const SkRect* bounds, const SkIRect* blitBounds)
+            : fRootPixmap(root)
+            , fMatrixProvider(&matrixProvider)
+            , fRC(&rc)
+            , fBlitBounds(blitBounds) {
+        fDone = false;
+
+        // do a quick check, so we don't even have to process "bounds" if there is no need
+        const SkIRect clipR = rc.getBounds();
+        fNeedsTiling = clipR.right() > kMaxDim || clipR.bottom() > kMaxDim;
+        if (fNeedsTiling) {
+            if (bounds) {
+                // Make sure we round first, and then intersect. We can't rely on promoting the
+                // clipR to floats (and then intersecting with devBounds) since promoting
+                // int --> float can make the float larger than the int.
+                // rounding(out) first runs the risk of clamping if the float is larger an intmax
+                // but our roundOut() is saturating, which is fine for this use case
+                //
+                // e.g. the older version of this code did this:
+                //    devBounds = mapRect(bounds);
+                //    if (devBounds.intersect(SkRect::Make(clipR))) {
+                //        fSrcBounds = devBounds.roundOut();
+                // The problem being that the promotion of clipR to SkRect was unreliable
+                //
+                fSrcBounds = matrixProvider.localToDevice().mapRect(*bounds).roundOut();
+                if (fSrcBounds.intersect(clipR)) {
+                    // Check again, now that we have computed srcbounds.
+                    fNeedsTiling = fSrcBounds.right() > kMaxDim || fSrcBounds.bottom() > kMaxDim;
+                } else {
+                    fNeedsTiling = false;
+                    fDone = true;
+                }
+            } else {
+                fSrcBounds = clipR;
+            }
+        }
+
+        if (fNeedsTiling) {
+            // fDraw.fDst and fMatrixProvider are reset each time in setupTileDraw()
+            fDraw.fRC = &fTileRC;
+            fDraw.fBlitBounds = fBlitBounds ? &fTileBlitBounds : nullptr;
+            // we'll step/increase it before using it
+            fOrigin.set(fSrcBounds.fLeft - kMaxDim, fSrcBounds.fTop);
+        } else {
+            // don't reference fSrcBounds, as it may not have been set
+            fDraw.fDst = fRootPixmap;
+            fDraw.fMatrixProvider = fMatrixProvider;
+            fDraw.fRC = fRC;
+            fDraw.fBlitBounds = fBlitBounds;
+            fOrigin.set(0, 0);
+        }
+    }
+
+    bool needsTiling() const { return fNeedsTiling; }
+
+    const SkDraw* next() {
+        if (fDone) {
+            return nullptr;
+        }
+        if (fNeedsTiling) {
+            do {
+                this->stepAndSetupTileDraw();  // might set the clip to empty and fDone to true
+            } while (!fDone && this->tileIsEmpty());
+            // if we exit the loop and we're still empty, we're (past) done
+            if (this->tileIsEmpty()) {
+                SkASSERT(fDone);
+                return nullptr;
+            }
+            SkASSERT(!fTileRC.isEmpty());
+        } else {
+            fDone = true;   // only draw untiled once
+        }
+        return &fDraw;
+    }
+
+private:
+    static SkPixmap root_pixmap(SkBitmapDevice* dev) {
+        SkPixmap pm;
+        // we need fDst to be set, and if we're actually drawing, to dirty the genID
+        if (!dev->accessPixels(&pm)) {
+            // NoDrawDevice uses us (why?) so we have to catch this case w/ no pixels
+            pm.reset(dev->imageInfo(), nullptr, 0);
+        }
+        return pm;
+    }
+
+    bool tileIsEmpty() const {
+        return fTileRC.isEmpty() ||
+               (fBlitBounds && !SkIRect::Intersects(fTileRC.getBounds(), fTileBlitBounds));
+    }
+
+    void stepAndSetupTileDraw() {
+        SkASSERT(!fDone);
+        SkASSERT(fNeedsTiling);
+
+        // We do fRootPixmap.width() - kMaxDim instead of fOrigin.fX + kMaxDim to avoid overflow.
+        if (fOrigin.fX >= fSrcBounds.fRight - kMaxDim) {    // too far
+            fOrigin.fX = fSrcBounds.fLeft;
+            fOrigin.fY += kMaxDim;
+        } else {
+            fOrigin.fX += kMaxDim;
+        }
+        // fDone = next origin will be invalid.
+        fDone = fOrigin.fX >= fSrcBounds.fRight - kMaxDim &&
+                fOrigin.fY >= fSrcBounds.fBottom - kMaxDim;
+
+        SkIRect bounds = SkIRect::MakeXYWH(fOrigin.x(), fOrigin.y(), kMaxDim, kMaxDim);
+        SkASSERT(!bounds.isEmpty());
+        bool success = fRootPixmap.extractSubset(&fDraw.fDst, bounds);
+        SkASSERT_RELEASE(success);
+        // now don't use bounds, since fDst has the clipped dimensions.
+
+        fDraw.fMatrixProvider = fTileMatrixProvider.init(*fMatrixProvider,
+                                                         SkIntToScalar(-fOrigin.x()),
+                                                         SkIntToScalar(-fOrigin.y()));
+        fRC->translate(-fOrigin.x(), -fOrigin.y(), &fTileRC);
+        fTileRC.op(SkIRect::MakeWH(fDraw.fDst.width(), fDraw.fDst.height()),
+                   SkRegion::kIntersect_Op);
+        if (fBlitBounds) {
+            fTileBlitBounds = fBlitBounds->makeOffset(-fOrigin.x(), -fOrigin.y());
+        }
+    }
+};
+
+#endif
@@ -47,7 +47,8 @@ static void load_color(SkRasterPipeline_UniformColorCtx* ctx, const float rgba[]
 }
 
 void SkDraw::drawAtlas(const SkImage* atlas, const SkRSXform xform[], const SkRect textures[],
-                       const SkColor colors[], int count, SkBlendMode bmode, const SkPaint& paint) {
+                       const SkColor colors[], int count, SkBlendMode bmode,
+                       const SkPaint& paint) const {
     sk_sp<SkShader> atlasShader = atlas->makeShader();
     if (!atlasShader) {
         return;
@@ -101,8 +102,9 @@ void SkDraw::drawAtlas(const SkImage* atlas, const SkRSXform xform[], const SkRe
         isOpaque = false;
     }
 
-    if (auto blitter = SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, &alloc,
-                                                     fRC->clipShader())) {
+    if (auto blitter = this->applyBlitBounds(
+                SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, &alloc,
+                                              fRC->clipShader()), &alloc)) {
         SkPath scratchPath;
 
         for (int i = 0; i < count; ++i) {
@@ -47,6 +47,8 @@ void SkDraw::paintMasks(SkDrawableGlyphBuffer* drawables, const SkPaint& paint)
                         *fCoverage, *fMatrixProvider, SkPaint(), &alloc, true, fRC->clipShader()));
     }
 
+    blitter = this->applyBlitBounds(blitter, &alloc);
+
     SkAAClipBlitterWrapper wrapper{*fRC, blitter};
     blitter = wrapper.getBlitter();
 
@@ -330,8 +330,9 @@ void SkDraw::draw_fixed_vertices(const SkVertices* vertices, SkBlendMode bmode,
     p.setShader(sk_ref_sp(shader));
 
     if (!textures) {    // only tricolor shader
-        if (auto blitter = SkCreateRasterPipelineBlitter(fDst, p, *fMatrixProvider, outerAlloc,
-                                                         this->fRC->clipShader())) {
+        if (auto blitter = this->applyBlitBounds(
+                    SkCreateRasterPipelineBlitter(fDst, p, *fMatrixProvider, outerAlloc,
+                                                  this->fRC->clipShader()), outerAlloc)) {
             while (vertProc(&state)) {
                 if (triShader &&
                     !triShader->update(ctmInv, positions, dstColors,
@@ -363,8 +364,9 @@ void SkDraw::draw_fixed_vertices(const SkVertices* vertices, SkBlendMode bmode,
             }
         }
 
-        if (auto blitter = SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, outerAlloc,
-                                                         fRC->clipShader())) {
+        if (auto blitter = this->applyBlitBounds(
+                    SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, outerAlloc,
+                                                  fRC->clipShader()), outerAlloc)) {
             while (vertProc(&state)) {
                 if (triShader && !triShader->update(ctmInv, positions, dstColors,
                                                     state.f0, state.f1, state.f2)) {
@@ -399,8 +401,9 @@ void SkDraw::draw_fixed_vertices(const SkVertices* vertices, SkBlendMode bmode,
                 matrixProvider = preConcatMatrixProvider.init(*matrixProvider, localM);
             }
 
-            if (auto blitter = SkCreateRasterPipelineBlitter(fDst, p, *matrixProvider, &innerAlloc,
-                                                             this->fRC->clipShader())) {
+            if (auto blitter = this->applyBlitBounds(
+                        SkCreateRasterPipelineBlitter(fDst, p, *matrixProvider, &innerAlloc,
+                                                      this->fRC->clipShader()), &innerAlloc)) {
                 fill_triangle(state, blitter, *fRC, dev2, dev3);
             }
         }
@@ -10,6 +10,7 @@
 #include "include/private/SkSemaphore.h"
 #include "include/private/SkSpinlock.h"
 #include "include/private/SkTArray.h"
+#include <atomic>
 #include <deque>
 #include <thread>
 
@@ -141,6 +142,132 @@ private:
     bool                  fAllowBorrowing;
 };
 
+// An SkWorkStealingThreadPool gives each of its threads its own lists of work, one per priority.
+// Threads add to and pop from the back of their own lists, and steal from the front of the others.
+// Work added from outside the pool is dealt out round-robin.
+class SkWorkStealingThreadPool final : public SkExecutor {
+public:
+    explicit SkWorkStealingThreadPool(int threads, bool allowBorrowing)
+            : fWorkers(new Worker[threads])
+            , fWorkerCount(threads)
+            , fAllowBorrowing(allowBorrowing) {
+        for (int i = 0; i < threads; i++) {
+            fThreads.emplace_back(&Loop, this, i);
+        }
+    }
+
+    ~SkWorkStealingThreadPool() override {
+        // Each thread runs until it's woken up and finds no work left to do.
+        fShuttingDown.store(true, std::memory_order_release);
+        fWorkAvailable.signal(fThreads.count());
+        for (int i = 0; i < fThreads.count(); i++) {
+            fThreads[i].join();
+        }
+    }
+
+    void add(std::function<void(void)> work) override {
+        this->addWithPriority(Priority::kNormal, std::move(work));
+    }
+
+    void addWithPriority(Priority priority, std::function<void(void)> work) override {
+        const int p = (int)priority;
+        Worker& worker = fWorkers[gCurrentPool == this
+                                  ? gCurrentIndex
+                                  : fNextWorker.fetch_add(1, std::memory_order_relaxed)
+                                            % fWorkerCount];
+        {
+            SkAutoSpinlock lock(worker.fLock);
+            worker.fWork[p].emplace_back(std::move(work));
+            fPending[p].fetch_add(1, std::memory_order_relaxed);
+        }
+        fWorkAvailable.signal(1);
+    }
+
+    void borrow() override {
+        // If there is work waiting and we're allowed to borrow work, do it.
+        if (fAllowBorrowing && fWorkAvailable.try_wait()) {
+            if (!this->do_work(gCurrentPool == this ? gCurrentIndex : 0)) {
+                // We took one of the destructor's wake ups; give it back to a Loop() thread.
+                fWorkAvailable.signal(1);
+            }
+        }
+    }
+
+private:
+    struct Worker {
+        SkSpinlock                           fLock;
+        std::deque<std::function<void(void)>> fWork[kPriorityCount];
+    };
+
+    // Take the highest priority work we can find, preferring our own. Returns false if there was
+    // none, which can happen while someone else is still adding the work we were signaled for.
+    bool take_work(int index, std::function<void(void)>* work) {
+        for (int p = kPriorityCount - 1; p >= 0; p--) {
+            if (fPending[p].load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            for (int i = 0; i < fWorkerCount; i++) {
+                Worker& worker = fWorkers[(index + i) % fWorkerCount];
+                SkAutoSpinlock lock(worker.fLock);
+                std::deque<std::function<void(void)>>& list = worker.fWork[p];
+                if (list.empty()) {
+                    continue;
+                }
+                if (i == 0) {
+                    *work = std::move(list.back());
+                    list.pop_back();
+                } else {
+                    *work = std::move(list.front());
+                    list.pop_front();
+                }
+                fPending[p].fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // This method should be called only when fWorkAvailable indicates there's work to do.
+    // Returns false when there is no work and the pool is shutting down.
+    bool do_work(int index) {
+        // Every wake up from fWorkAvailable beyond the destructor's is matched by work that was
+        // added before it, so if we don't find any yet it's on its way.
+        std::function<void(void)> work;
+        while (!this->take_work(index, &work)) {
+            if (fShuttingDown.load(std::memory_order_acquire)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        work();
+        return true;
+    }
+
+    static void Loop(SkWorkStealingThreadPool* pool, int index) {
+        gCurrentPool  = pool;
+        gCurrentIndex = index;
+        do {
+            pool->fWorkAvailable.wait();
+        } while (pool->do_work(index));
+    }
+
+    // Which pool and worker the current thread belongs to, if any.
+    static thread_local SkWorkStealingThreadPool* gCurrentPool;
+    static thread_local int                       gCurrentIndex;
+
+    std::unique_ptr<Worker[]> fWorkers;
+    const int                 fWorkerCount;
+    std::atomic<unsigned>     fNextWorker{0};
+    std::atomic<int>          fPending[kPriorityCount] = {};
+    std::atomic<bool>         fShuttingDown{false};
+    SkTArray<std::thread>     fThreads;
+    SkSemaphore               fWorkAvailable;
+    bool                      fAllowBorrowing;
+};
+
+thread_local SkWorkStealingThreadPool* SkWorkStealingThreadPool::gCurrentPool  = nullptr;
+thread_local int                       SkWorkStealingThreadPool::gCurrentIndex = 0;
+
 std::unique_ptr<SkExecutor> SkExecutor::MakeFIFOThreadPool(int threads, bool allowBorrowing) {
     using WorkList = std::deque<std::function<void(void)>>;
     return std::make_unique<SkThreadPool<WorkList>>(threads > 0 ? threads : num_cores(),
@@ -151,3 +278,8 @@ std::unique_ptr<SkExecutor> SkExecutor::MakeLIFOThreadPool(int threads, bool all
     return std::make_unique<SkThreadPool<WorkList>>(threads > 0 ? threads : num_cores(),
                                                     allowBorrowing);
 }
+std::unique_ptr<SkExecutor> SkExecutor::MakeWorkStealingThreadPool(int threads,
+                                                                   bool allowBorrowing) {
+    return std::make_unique<SkWorkStealingThreadPool>(threads > 0 ? threads : num_cores(),
+                                                      allowBorrowing);
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkGlyphStore.h"
+
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTime.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/SkTemplates.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkScalerCache.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <atomic>
+#include <cstdio>
+
+// The file is a header followed by the strikes:
+//   magic, version, sizeof(SkScalerContextRec), strike count
+//   for each strike: typeface hash (two uints), descriptor, glyphs (byte arrays)
+// The glyphs of a strike are a count followed by each glyph:
+//   packed ID, advance x and y, width and height, top and left, format and flags, [image]
+static constexpr uint32_t kMagic   = SkSetFourByteTag('s', 'k', 'g', 's');
+static constexpr uint32_t kVersion = 1;
+
+static constexpr uint32_t kForceBW_Flag  = 1 << 8;
+static constexpr uint32_t kHasImage_Flag = 1 << 9;
+
+static uint64_t typeface_hash(const SkTypeface& typeface) {
+    SkBinaryWriteBuffer buffer;
+
+    SkString familyName;
+    typeface.getFamilyName(&familyName);
+    buffer.writeString(familyName.c_str());
+    buffer.writeInt(typeface.fontStyle().weight());
+    buffer.writeInt(typeface.fontStyle().width());
+    buffer.writeInt(typeface.fontStyle().slant());
+    buffer.writeInt(typeface.countGlyphs());
+
+    // The 'head' table has the font's revision, checksum and modification date.
+    if (sk_sp<SkData> head = typeface.copyTableData(SkSetFourByteTag('h', 'e', 'a', 'd'))) {
+        buffer.writeDataAsByteArray(head.get());
+    }
+
+    int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+    if (axisCount > 0) {
+        SkAutoSTMalloc<4, SkFontArguments::VariationPosition::Coordinate> coords(axisCount);
+        if (typeface.getVariationDesignPosition(coords.get(), axisCount) == axisCount) {
+            for (int i = 0; i < axisCount; i++) {
+                buffer.writeUInt(coords[i].axis);
+                buffer.writeScalar(coords[i].value);
+            }
+        }
+    }
+
+    sk_sp<SkData> bytes = buffer.snapshotAsData();
+    return (uint64_t)SkOpts::hash(bytes->data(), bytes->size(), 0) << 32
+                   | SkOpts::hash(bytes->data(), bytes->size(), 1);
+}
+
+// Copies desc with the font ID of its rec cleared, as it is different in every process.
+static std::unique_ptr<SkDescriptor> stable_descriptor(const SkDescriptor& desc) {
+    std::unique_ptr<SkDescriptor> stable = SkDescriptor::Alloc(desc.getLength());
+
+    uint32_t size;
+    const void* ptr = desc.findEntry(kRec_SkDescriptorTag, &size);
+    SkScalerContextRec rec;
+    SkASSERT(ptr && size == sizeof(rec));
+    memcpy((void*)&rec, ptr, sizeof(rec));
+    rec.fFontID = 0;
+    stable->addEntry(kRec_SkDescriptorTag, sizeof(rec), &rec);
+
+    if ((ptr = desc.findEntry(kEffects_SkDescriptorTag, &size))) {
+        stable->addEntry(kEffects_SkDescriptorTag, size, ptr);
+    }
+
+    stable->computeChecksum();
+    return stable;
+}
+
+sk_sp<SkGlyphStore> SkGlyphStore::Make(const char path[], size_t byteLimit) {
+    if (!path) {
+        return nullptr;
+    }
+    sk_sp<SkGlyphStore> store{new SkGlyphStore{SkString{path}, byteLimit}};
+    if (sk_sp<SkData> data = SkData::MakeFromFileName(path)) {
+        SkAutoMutexExclusive lock{store->fMutex};
+        if (!store->read(*data)) {
+            store->fEntries.reset();
+            store->fBytesUsed = 0;
+        }
+    }
+    return store;
+}
+
+SkGlyphStore::SkGlyphStore(SkString path, size_t byteLimit)
+        : fPath{std::move(path)}
+        , fByteLimit{byteLimit} {}
+
+bool SkGlyphStore::read(const SkData& data) {
+    SkReadBuffer buffer{data.data(), data.size()};
+    if (buffer.readUInt() != kMagic ||
+        buffer.readUInt() != kVersion ||
+        buffer.readUInt() != sizeof(SkScalerContextRec)) {
+        return false;
+    }
+    uint32_t strikeCount = buffer.readUInt();
+
+    // Each strike is a typeface hash and two byte arrays, so at least 16 bytes.
+    if (!buffer.validateCanReadN<uint32_t>((size_t)strikeCount * 4)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < strikeCount; i++) {
+        auto entry = std::make_unique<Entry>();
+        uint64_t hi = buffer.readUInt();
+        entry->fKey.fTypefaceHash = hi << 32 | buffer.readUInt();
+
+        size_t descLength = 0;
+        const void* desc = buffer.skipByteArray(&descLength);
+        if (!buffer.validate(desc && descLength >= sizeof(SkDescriptor) &&
+                             SkIsAlign4(descLength))) {
+            return false;
+        }
+        entry->fKey.fDesc = SkDescriptor::Alloc(descLength);
+        memcpy(entry->fKey.fDesc.get(), desc, descLength);
+        if (entry->fKey.fDesc->getLength() != descLength || !entry->fKey.fDesc->isValid()) {
+            return false;
+        }
+
+        // The glyphs stay in the mapping until they are restored.
+        size_t glyphsLength = 0;
+        const void* glyphs = buffer.skipByteArray(&glyphsLength);
+        if (!buffer.isValid()) {
+            return false;
+        }
+        size_t offset = (const char*)glyphs - (const char*)data.data();
+        entry->fGlyphs = SkData::MakeSubset(&data, offset, glyphsLength);
+
+        fBytesUsed += descLength + glyphsLength;
+        fEntries.set(std::move(entry));
+    }
+    return buffer.isValid();
+}
+
+auto SkGlyphStore::makeKey(const SkScalerCache& cache) -> Key {
+    const SkTypeface* typeface = cache.getScalerContext()->getTypeface();
+    uint64_t typefaceHash = 0;
+    bool known = false;
+    {
+        SkAutoMutexExclusive lock{fMutex};
+        if (uint64_t* found = fTypefaceHashes.find(typeface->uniqueID())) {
+            typefaceHash = *found;
+            known = true;
+        }
+    }
+    if (!known) {
+        // The hash reads the typeface's tables, so don't hold the lock while making it.
+        typefaceHash = typeface_hash(*typeface);
+        SkAutoMutexExclusive lock{fMutex};
+        fTypefaceHashes.set(typeface->uniqueID(), typefaceHash);
+    }
+    return Key{typefaceHash, stable_descriptor(cache.getDescriptor())};
+}
+
+size_t SkGlyphStore::restore(SkScalerCache* cache) {
+    sk_sp<SkData> data;
+    {
+        Key key = this->makeKey(*cache);
+        SkAutoMutexExclusive lock{fMutex};
+        if (std::unique_ptr<Entry>* entry = fEntries.find(key)) {
+            data = (*entry)->fGlyphs;
+        }
+    }
+    if (!data) {
+        return 0;
+    }
+
+    size_t increase = 0;
+    SkReadBuffer buffer{data->data(), data->size()};
+    uint32_t glyphCount = buffer.readUInt();
+    for (uint32_t i = 0; i < glyphCount && buffer.isValid(); i++) {
+        SkGlyph glyph{SkPackedGlyphID{buffer.readUInt()}};
+        glyph.fAdvanceX = buffer.readScalar();
+        glyph.fAdvanceY = buffer.readScalar();
+        uint32_t size   = buffer.readUInt(),
+                 origin = buffer.readUInt(),
+                 format = buffer.readUInt();
+        glyph.fWidth      = (uint16_t)(size >> 16);
+        glyph.fHeight     = (uint16_t)size;
+        glyph.fTop        = (int16_t)(origin >> 16);
+        glyph.fLeft       = (int16_t)origin;
+        glyph.fMaskFormat = (uint8_t)format;
+        glyph.fForceBW    = SkToBool(format & kForceBW_Flag);
+        if (!buffer.validate(SkMask::IsValidFormat(glyph.fMaskFormat) &&
+                             (glyph.fWidth == 0) == (glyph.fHeight == 0))) {
+            break;
+        }
+        if (format & kHasImage_Flag) {
+            if (!buffer.validate(!glyph.isEmpty() && !glyph.imageTooLarge())) {
+                break;
+            }
+            glyph.fImage = const_cast<void*>(buffer.skip(glyph.imageSize()));
+            if (!buffer.isValid()) {
+                break;
+            }
+        }
+        increase += std::get<1>(cache->mergeGlyphAndImage(glyph.getPackedID(), glyph));
+    }
+    return increase;
+}
+
+void SkGlyphStore::save(const SkScalerCache& cache) {
+    SkBinaryWriteBuffer buffer;
+    buffer.writeUInt(0);
+    uint32_t glyphCount = 0;
+    cache.forEachGlyph([&](const SkGlyph& glyph) {
+        // Only glyphs which have been drawn are worth keeping.
+        if (!glyph.setImageHasBeenCalled()) {
+            return;
+        }
+        bool hasImage = glyph.fImage != nullptr;
+        buffer.writeUInt(glyph.getPackedID().value());
+        buffer.writeScalar(glyph.fAdvanceX);
+        buffer.writeScalar(glyph.fAdvanceY);
+        buffer.writeUInt((uint32_t)glyph.fWidth << 16 | glyph.fHeight);
+        buffer.writeUInt((uint32_t)(uint16_t)glyph.fTop << 16 | (uint16_t)glyph.fLeft);
+        buffer.writeUInt(glyph.fMaskFormat | (glyph.fForceBW ? kForceBW_Flag  : 0)
+                                           | (hasImage       ? kHasImage_Flag : 0));
+        if (hasImage) {
+            buffer.writePad32(glyph.fImage, glyph.imageSize());
+        }
+        glyphCount++;
+    });
+    if (glyphCount == 0) {
+        return;
+    }
+    // Fill in the count written before the glyphs.
+    sk_sp<SkData> glyphs = buffer.snapshotAsData();
+    *(uint32_t*)glyphs->writable_data() = glyphCount;
+
+    auto entry = std::make_unique<Entry>();
+    entry->fKey = this->makeKey(cache);
+    entry->fGlyphs = std::move(glyphs);
+
+    SkAutoMutexExclusive lock{fMutex};
+    size_t bytes = entry->fKey.fDesc->getLength() + entry->fGlyphs->size();
+    if (std::unique_ptr<Entry>* old = fEntries.find(entry->fKey)) {
+        fBytesUsed -= (*old)->fKey.fDesc->getLength() + (*old)->fGlyphs->size();
+    } else if (fBytesUsed + bytes > fByteLimit) {
+        return;
+    }
+    fBytesUsed += bytes;
+    fEntries.set(std::move(entry));
+    fDirty = true;
+}
+
+bool SkGlyphStore::write() {
+    SkAutoMutexExclusive lock{fMutex};
+    if (!fDirty) {
+        return true;
+    }
+
+    // Write a new file and move it over the old one, which may still be mapped by this process.
+    // Other processes may be writing the same store, so each write gets its own temporary file.
+    static std::atomic<uint32_t> gWriteCount{0};
+    SkString tmpPath = SkStringPrintf("%s.%p.%llx.%u.tmp", fPath.c_str(), this,
+                                      (unsigned long long)SkTime::GetNSecs(),
+                                      gWriteCount.fetch_add(1, std::memory_order_relaxed));
+    bool written;
+    {
+        SkFILEWStream stream{tmpPath.c_str()};
+        if (!stream.isValid()) {
+            return false;
+        }
+        SkBinaryWriteBuffer buffer;
+        buffer.writeUInt(kMagic);
+        buffer.writeUInt(kVersion);
+        buffer.writeUInt(sizeof(SkScalerContextRec));
+        buffer.writeUInt(fEntries.count());
+        fEntries.foreach([&](std::unique_ptr<Entry>* entry) {
+            const Key& key = (*entry)->fKey;
+            buffer.writeUInt((uint32_t)(key.fTypefaceHash >> 32));
+            buffer.writeUInt((uint32_t)key.fTypefaceHash);
+            buffer.writeByteArray(key.fDesc.get(), key.fDesc->getLength());
+            buffer.writeDataAsByteArray((*entry)->fGlyphs.get());
+        });
+        written = buffer.writeToStream(&stream);
+    }
+    if (!written) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    if (std::rename(tmpPath.c_str(), fPath.c_str()) != 0) {
+        // Some platforms will not replace a file by renaming.
+        std::remove(fPath.c_str());
+        if (std::rename(tmpPath.c_str(), fPath.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    fDirty = false;
+    return true;
+}
+
+int SkGlyphStore::countStrikes() const {
+    SkAutoMutexExclusive lock{fMutex};
+    return fEntries.count();
+}
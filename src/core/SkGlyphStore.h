@@ -0,0 +1,95 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGlyphStore_DEFINED
+#define SkGlyphStore_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTHash.h"
+#include "src/core/SkDescriptor.h"
+
+#include <memory>
+
+class SkScalerCache;
+class SkTypeface;
+
+#ifndef SK_DEFAULT_GLYPH_STORE_LIMIT
+    #define SK_DEFAULT_GLYPH_STORE_LIMIT    (8 * 1024 * 1024)
+#endif
+
+// SkGlyphStore keeps the metrics and images of glyphs in a file between runs, so that a process
+// starting up does not have to rasterize the same glyphs all over again.
+//
+// The file is memory mapped when the store is made, and the glyphs of a strike are copied out of
+// it when SkStrikeCache creates that strike. SkStrikeCache::purgeAll() saves the glyphs of the
+// strikes it purges in the store, and write() puts everything back in the file.
+//
+// Strikes are keyed by their descriptor, with the typeface's process-specific ID replaced by a
+// hash of the typeface's name, style, glyph count, 'head' table and variation position.
+class SkGlyphStore : public SkRefCnt {
+public:
+    // Reads the glyphs saved in path, if it exists, and saves them back there. A file that isn't
+    // a glyph store written by this version of Skia is ignored, and replaced by write().
+    // Saving stops adding strikes after the store holds byteLimit bytes of them.
+    static sk_sp<SkGlyphStore> Make(const char path[],
+                                    size_t byteLimit = SK_DEFAULT_GLYPH_STORE_LIMIT);
+
+    // Copies the glyphs saved for the strike into cache, returning the bytes added to cache.
+    size_t restore(SkScalerCache* cache);
+
+    // Saves the glyphs of cache, replacing any saved for its strike before.
+    void save(const SkScalerCache& cache);
+
+    // Writes all the saved strikes to the file, if any were saved since it was read or written.
+    // Returns false if that fails.
+    bool write();
+
+    int countStrikes() const;
+
+private:
+    SkGlyphStore(SkString path, size_t byteLimit);
+
+    // A strike's descriptor without its font ID, and the identity of its typeface.
+    struct Key {
+        uint64_t                      fTypefaceHash;
+        std::unique_ptr<SkDescriptor> fDesc;
+
+        bool operator==(const Key& that) const {
+            return fTypefaceHash == that.fTypefaceHash && *fDesc == *that.fDesc;
+        }
+    };
+
+    struct Entry {
+        Key           fKey;
+        sk_sp<SkData> fGlyphs;  // May point into the file's mapping.
+    };
+
+    struct EntryTraits {
+        static const Key& GetKey(const std::unique_ptr<Entry>& entry) { return entry->fKey; }
+        static uint32_t Hash(const Key& key) {
+            return key.fDesc->getChecksum() ^ (uint32_t)(key.fTypefaceHash >> 32)
+                                            ^ (uint32_t)key.fTypefaceHash;
+        }
+    };
+
+    bool read(const SkData& data) SK_REQUIRES(fMutex);
+    Key makeKey(const SkScalerCache& cache) SK_EXCLUDES(fMutex);
+
+    const SkString fPath;
+    const size_t   fByteLimit;
+
+    mutable SkMutex fMutex;
+    SkTHashTable<std::unique_ptr<Entry>, Key, EntryTraits> fEntries SK_GUARDED_BY(fMutex);
+    SkTHashMap<uint32_t, uint64_t> fTypefaceHashes SK_GUARDED_BY(fMutex);  // By SkFontID.
+    size_t fBytesUsed SK_GUARDED_BY(fMutex) {0};
+    bool   fDirty     SK_GUARDED_BY(fMutex) {false};
+};
+
+#endif  // SkGlyphStore_DEFINED
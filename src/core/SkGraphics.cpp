@@ -19,6 +19,7 @@
 #include "src/core/SkBlitter.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkGeometry.h"
+#include "src/core/SkGlyphStore.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
@@ -132,3 +133,7 @@ void SkGraphics::PurgeFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgeAll();
     SkTypefaceCache::PurgeAll();
 }
+
+void SkGraphics::SetFontCachePersistentPath(const char path[]) {
+    SkStrikeCache::GlobalStrikeCache()->setGlyphStore(SkGlyphStore::Make(path));
+}
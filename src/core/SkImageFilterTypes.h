@@ -13,6 +13,7 @@
 #include "src/core/SkSpecialSurface.h"
 
 class GrRecordingContext;
+class SkExecutor;
 class SkImageFilter;
 class SkImageFilterCache;
 class SkSpecialSurface;
@@ -593,23 +594,26 @@ public:
     // Creates a context with the given layer matrix and destination clip, reading from 'source'
     // with an origin of (0,0).
     Context(const SkMatrix& layerMatrix, const SkIRect& clipBounds, SkImageFilterCache* cache,
-            SkColorType colorType, SkColorSpace* colorSpace, const SkSpecialImage* source)
+            SkColorType colorType, SkColorSpace* colorSpace, const SkSpecialImage* source,
+            SkExecutor* executor = nullptr)
         : fMapping(SkMatrix::I(), layerMatrix)
         , fDesiredOutput(clipBounds)
         , fCache(cache)
         , fColorType(colorType)
         , fColorSpace(colorSpace)
-        , fSource(sk_ref_sp(source), LayerSpace<SkIPoint>({0, 0})) {}
+        , fSource(sk_ref_sp(source), LayerSpace<SkIPoint>({0, 0}))
+        , fExecutor(executor) {}
 
     Context(const Mapping& mapping, const LayerSpace<SkIRect>& desiredOutput,
             SkImageFilterCache* cache, SkColorType colorType, SkColorSpace* colorSpace,
-            const FilterResult<For::kInput>& source)
+            const FilterResult<For::kInput>& source, SkExecutor* executor = nullptr)
         : fMapping(mapping)
         , fDesiredOutput(desiredOutput)
         , fCache(cache)
         , fColorType(colorType)
         , fColorSpace(colorSpace)
-        , fSource(source) {}
+        , fSource(source)
+        , fExecutor(executor) {}
 
     // The mapping that defines the transformation from local parameter space of the filters to the
     // layer space where the image filters are evaluated, as well as the remaining transformation
@@ -654,6 +658,10 @@ public:
     // DEPRECATED: Use source() instead to get both the image and its origin.
     const SkSpecialImage* sourceImage() const { return fSource.image(); }
 
+    // If not null, raster filters may split their work into independent pieces run on this
+    // executor. Their output must not depend on how the work was split.
+    SkExecutor* executor() const { return fExecutor; }
+
     // True if image filtering should occur on the GPU if possible.
     bool gpuBacked() const { return fSource.image()->isTextureBacked(); }
     // The recording context to use when computing the filter with the GPU.
@@ -680,11 +688,13 @@ public:
 
     // Create a new context that matches this context, but with an overridden layer space.
     Context withNewMapping(const Mapping& mapping) const {
-        return Context(mapping, fDesiredOutput, fCache, fColorType, fColorSpace, fSource);
+        return Context(mapping, fDesiredOutput, fCache, fColorType, fColorSpace, fSource,
+                       fExecutor);
     }
     // Create a new context that matches this context, but with an overridden desired output rect.
     Context withNewDesiredOutput(const LayerSpace<SkIRect>& desiredOutput) const {
-        return Context(fMapping, desiredOutput, fCache, fColorType, fColorSpace, fSource);
+        return Context(fMapping, desiredOutput, fCache, fColorType, fColorSpace, fSource,
+                       fExecutor);
     }
 
 private:
@@ -696,6 +706,8 @@ private:
     // is bounded by the device, so this can be a bare pointer.
     SkColorSpace*             fColorSpace;
     FilterResult<For::kInput> fSource;
+    // Owned by the device controlling the filter process, like fColorSpace.
+    SkExecutor*               fExecutor;
 };
 
 } // end namespace skif
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkMappedPicture.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkVertices.h"
+#include "src/core/SkPictureData.h"
+#include "src/core/SkPictureFlat.h"
+#include "src/core/SkPicturePlayback.h"
+
+// Counts ops by walking their headers, without decoding them. Each op starts with its type and
+// size packed into 32 bits. The size covers the whole op, except for ops too large for 24 bits,
+// where the size follows in another 32 bits, and is 3 less than the whole op's (see
+// SkPictureRecord::addDraw()). Malformed data just ends the count; playback validates ops.
+static int count_ops(const SkData& opData) {
+    const uint8_t* ops = opData.bytes();
+    const size_t  size = opData.size();
+
+    int count = 0;
+    size_t offset = 0;
+    while (offset + sizeof(uint32_t) <= size) {
+        uint32_t bits;
+        memcpy(&bits, ops + offset, sizeof(bits));
+        size_t opSize = bits & 0xffffff;
+        if (opSize == 0xffffff) {
+            uint32_t extended;
+            if (offset + 2 * sizeof(uint32_t) > size) {
+                break;
+            }
+            memcpy(&extended, ops + offset + sizeof(uint32_t), sizeof(extended));
+            opSize = (size_t)extended + 3;
+        }
+        if (opSize == 0) {
+            break;
+        }
+        offset += opSize;
+        count++;
+    }
+    return count;
+}
+
+sk_sp<SkPicture> SkMappedPicture::Make(const SkRect& cull, std::unique_ptr<SkPictureData> data) {
+    if (!data || !data->opData()) {
+        return nullptr;
+    }
+    const int opCount = count_ops(*data->opData());
+    return sk_sp<SkPicture>(new SkMappedPicture(cull, std::move(data), opCount));
+}
+
+SkMappedPicture::SkMappedPicture(const SkRect& cull,
+                                 std::unique_ptr<SkPictureData> data,
+                                 int opCount)
+    : fCullRect(cull)
+    , fData(std::move(data))
+    , fOpCount(opCount)
+{}
+
+SkMappedPicture::~SkMappedPicture() = default;
+
+void SkMappedPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    SkASSERT(canvas);
+
+    // SkPicturePlayback tracks the current op, so each playback needs its own.
+    SkPicturePlayback playback(fData.get());
+    playback.draw(canvas, callback, nullptr);
+}
+
+size_t SkMappedPicture::approximateBytesUsed() const {
+    // The op data is usually shared with the (mapped) serialized picture, but it's still memory
+    // this picture keeps alive.
+    return sizeof(*this) + fData->opData()->size();
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMappedPicture_DEFINED
+#define SkMappedPicture_DEFINED
+
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+
+#include <memory>
+
+class SkPictureData;
+
+// An implementation of SkPicture that plays back deserialized SkPictureData directly, reading
+// its op data in place (typically from a mapped .skp, see SkPicture::MakeFromMappedData())
+// rather than re-recording it into an SkRecord.
+class SkMappedPicture final : public SkPicture {
+public:
+    // Returns nullptr if data is null or has no op data.
+    static sk_sp<SkPicture> Make(const SkRect& cull, std::unique_ptr<SkPictureData> data);
+
+    ~SkMappedPicture() override;
+
+// SkPicture overrides
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override { return fCullRect; }
+    int approximateOpCount() const override { return fOpCount; }
+    size_t approximateBytesUsed() const override;
+
+private:
+    SkMappedPicture(const SkRect& cull, std::unique_ptr<SkPictureData>, int opCount);
+
+    const SkRect                         fCullRect;
+    std::unique_ptr<const SkPictureData> fData;
+    const int                            fOpCount;
+};
+
+#endif//SkMappedPicture_DEFINED
@@ -14,228 +14,11 @@
 #include "include/private/SkTo.h"
 #include "src/core/SkArenaAlloc.h"
 #include "src/core/SkGaussFilter.h"
+#include "src/core/SkTripleBoxBlur.h"
 
 #include <cmath>
 #include <climits>
 
-namespace {
-static const double kPi = 3.14159265358979323846264338327950288;
-
-class PlanGauss final {
-public:
-    explicit PlanGauss(double sigma) {
-        auto possibleWindow = static_cast<int>(floor(sigma * 3 * sqrt(2 * kPi) / 4 + 0.5));
-        auto window = std::max(1, possibleWindow);
-
-        fPass0Size = window - 1;
-        fPass1Size = window - 1;
-        fPass2Size = (window & 1) == 1 ? window - 1 : window;
-
-        // Calculating the border is tricky. I will go through the odd case which is simpler, and
-        // then through the even case. Given a stack of filters seven wide for the odd case of
-        // three passes.
-        //
-        //        S
-        //     aaaAaaa
-        //     bbbBbbb
-        //     cccCccc
-        //        D
-        //
-        // The furthest changed pixel is when the filters are in the following configuration.
-        //
-        //                 S
-        //           aaaAaaa
-        //        bbbBbbb
-        //     cccCccc
-        //        D
-        //
-        //  The A pixel is calculated using the value S, the B uses A, and the C uses B, and
-        // finally D is C. So, with a window size of seven the border is nine. In general, the
-        // border is 3*((window - 1)/2).
-        //
-        // For even cases the filter stack is more complicated. The spec specifies two passes
-        // of even filters and a final pass of odd filters. A stack for a width of six looks like
-        // this.
-        //
-        //       S
-        //    aaaAaa
-        //     bbBbbb
-        //    cccCccc
-        //       D
-        //
-        // The furthest pixel looks like this.
-        //
-        //               S
-        //          aaaAaa
-        //        bbBbbb
-        //    cccCccc
-        //       D
-        //
-        // For a window of size, the border value is seven. In general the border is 3 *
-        // (window/2) -1.
-        fBorder = (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
-        fSlidingWindow = 2 * fBorder + 1;
-
-        // If the window is odd then the divisor is just window ^ 3 otherwise,
-        // it is window * window * (window + 1) = window ^ 2 + window ^ 3;
-        auto window2 = window * window;
-        auto window3 = window2 * window;
-        auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
-
-        fWeight = static_cast<uint64_t>(round(1.0 / divisor * (1ull << 32)));
-    }
-
-    size_t bufferSize() const { return fPass0Size + fPass1Size + fPass2Size; }
-
-    int    border()     const { return fBorder; }
-
-public:
-    class Scan {
-    public:
-        Scan(uint64_t weight, int noChangeCount,
-             uint32_t* buffer0, uint32_t* buffer0End,
-             uint32_t* buffer1, uint32_t* buffer1End,
-             uint32_t* buffer2, uint32_t* buffer2End)
-            : fWeight{weight}
-            , fNoChangeCount{noChangeCount}
-            , fBuffer0{buffer0}
-            , fBuffer0End{buffer0End}
-            , fBuffer1{buffer1}
-            , fBuffer1End{buffer1End}
-            , fBuffer2{buffer2}
-            , fBuffer2End{buffer2End}
-        { }
-
-        template <typename AlphaIter> void blur(const AlphaIter srcBegin, const AlphaIter srcEnd,
-                    uint8_t* dst, int dstStride, uint8_t* dstEnd) const {
-            auto buffer0Cursor = fBuffer0;
-            auto buffer1Cursor = fBuffer1;
-            auto buffer2Cursor = fBuffer2;
-
-            std::memset(fBuffer0, 0x00, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
-
-            uint32_t sum0 = 0;
-            uint32_t sum1 = 0;
-            uint32_t sum2 = 0;
-
-            // Consume the source generating pixels.
-            for (AlphaIter src = srcBegin; src < srcEnd; ++src, dst += dstStride) {
-                uint32_t leadingEdge = *src;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-            }
-
-            // The leading edge is off the right side of the mask.
-            for (int i = 0; i < fNoChangeCount; i++) {
-                uint32_t leadingEdge = 0;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-
-                dst += dstStride;
-            }
-
-            // Starting from the right, fill in the rest of the buffer.
-            std::memset(fBuffer0, 0, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
-
-            sum0 = sum1 = sum2 = 0;
-
-            uint8_t* dstCursor = dstEnd;
-            AlphaIter src = srcEnd;
-            while (dstCursor > dst) {
-                dstCursor -= dstStride;
-                uint32_t leadingEdge = *(--src);
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dstCursor = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-            }
-        }
-
-    private:
-        static constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
-
-        uint8_t finalScale(uint32_t sum) const {
-            return SkTo<uint8_t>((fWeight * sum + kHalf) >> 32);
-        }
-
-        uint64_t  fWeight;
-        int       fNoChangeCount;
-        uint32_t* fBuffer0;
-        uint32_t* fBuffer0End;
-        uint32_t* fBuffer1;
-        uint32_t* fBuffer1End;
-        uint32_t* fBuffer2;
-        uint32_t* fBuffer2End;
-    };
-
-    Scan makeBlurScan(int width, uint32_t* buffer) const {
-        uint32_t* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
-        buffer0 = buffer;
-        buffer0End = buffer1 = buffer0 + fPass0Size;
-        buffer1End = buffer2 = buffer1 + fPass1Size;
-        buffer2End = buffer2 + fPass2Size;
-        int noChangeCount = fSlidingWindow > width ? fSlidingWindow - width : 0;
-
-        return Scan(
-            fWeight, noChangeCount,
-            buffer0, buffer0End,
-            buffer1, buffer1End,
-            buffer2, buffer2End);
-    }
-
-    uint64_t fWeight;
-    int      fBorder;
-    int      fSlidingWindow;
-    int      fPass0Size;
-    int      fPass1Size;
-    int      fPass2Size;
-};
-
-} // namespace
-
 // NB 135 is the largest sigma that will not cause a buffer full of 255 mask values to overflow
 // using the Gauss filter. It also limits the size of buffers used hold intermediate values. The
 // additional + 1 added to window represents adding one more leading element before subtracting the
@@ -951,6 +734,128 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     return {radiusX, radiusY};
 }
 
+
+using Blur16 = SkTripleBoxBlur<16>;
+
+// This is defined by the SVG spec:
+// https://drafts.fxtf.org/filter-effects/#feGaussianBlurElement
+static int calculate_window(double sigma) {
+    static const double kPi = 3.14159265358979323846264338327950288;
+    auto possibleWindow = static_cast<int>(floor(sigma * 3 * sqrt(2 * kPi) / 4 + 0.5));
+    return std::max(1, possibleWindow);
+}
+
+// Transposes a 16x16 tile of bytes, so that row r of dst is column r of src.
+static void transpose_16x16(const uint8_t* src, size_t srcRB, uint8_t* dst, size_t dstRB) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    __m128i v[16], t[16];
+    for (int r = 0; r < 16; r++) {
+        v[r] = _mm_loadu_si128((const __m128i*)(src + r * srcRB));
+    }
+    // Each round interleaves pairs of rows, doubling the size of the runs taken from each.
+    for (int i = 0; i < 8; i++) {
+        t[i    ] = _mm_unpacklo_epi8(v[2*i], v[2*i+1]);
+        t[i + 8] = _mm_unpackhi_epi8(v[2*i], v[2*i+1]);
+    }
+    for (int i = 0; i < 8; i++) {
+        v[i    ] = _mm_unpacklo_epi16(t[2*i], t[2*i+1]);
+        v[i + 8] = _mm_unpackhi_epi16(t[2*i], t[2*i+1]);
+    }
+    for (int i = 0; i < 8; i++) {
+        t[i    ] = _mm_unpacklo_epi32(v[2*i], v[2*i+1]);
+        t[i + 8] = _mm_unpackhi_epi32(v[2*i], v[2*i+1]);
+    }
+    for (int i = 0; i < 8; i++) {
+        v[i    ] = _mm_unpacklo_epi64(t[2*i], t[2*i+1]);
+        v[i + 8] = _mm_unpackhi_epi64(t[2*i], t[2*i+1]);
+    }
+    // That leaves column c of src in v[], at the index with c's four bits reversed.
+    static constexpr int kBitReversed[16] = {0, 8, 4, 12, 2, 10, 6, 14,
+                                             1, 9, 5, 13, 3, 11, 7, 15};
+    for (int c = 0; c < 16; c++) {
+        _mm_storeu_si128((__m128i*)(dst + c * dstRB), v[kBitReversed[c]]);
+    }
+#else
+    for (int r = 0; r < 16; r++) {
+        for (int c = 0; c < 16; c++) {
+            dst[c * dstRB + r] = src[r * srcRB + c];
+        }
+    }
+#endif
+}
+
+// Blurs each of the lineCount rows of the A8 src, srcW values long, into a column of dst,
+// dstW = srcW + 2 * border values long.
+//
+// Rows are blurred sixteen at a time. They are first transposed a 16x16 tile at a time into
+// lines, so that each step of the blur reads the values for all sixteen rows from one place, and
+// writes all sixteen results to one row of dst.
+static void blur_and_transpose(int window,
+                               const uint8_t* src, size_t srcRB, int srcW, int lineCount,
+                               uint8_t* dst, size_t dstRB, int dstW,
+                               Sk4u* buffer, uint8_t* lines) {
+    int border = Blur16::Border(window);
+    SkASSERT(dstW == srcW + 2 * border);
+    int slidingWindow = 2 * border + 1;
+    int noChangeCount = slidingWindow > srcW ? slidingWindow - srcW : 0;
+
+    Blur16 blur{std::max(window, 2), Blur16::Rounding::kNearest, buffer};
+    for (int y = 0; y < lineCount; y += 16, src += 16 * srcRB) {
+        int n = std::min(16, lineCount - y);
+
+        int x = 0;
+        if (n == 16) {
+            for (; x + 16 <= srcW; x += 16) {
+                transpose_16x16(src + x, srcRB, lines + 16 * x, 16);
+            }
+        }
+        for (; x < srcW; x++) {
+            for (int r = 0; r < 16; r++) {
+                lines[16 * x + r] = r < n ? src[r * srcRB + x] : 0;
+            }
+        }
+
+        uint8_t partial[16];
+        auto blurredTo = [&](int i) { return n == 16 ? dst + i * dstRB + y : partial; };
+        auto finish = [&](int i) {
+            if (n < 16) {
+                memcpy(dst + i * dstRB + y, partial, n);
+            }
+        };
+
+        if (window < 2) {
+            for (int i = 0; i < srcW; i++) {
+                memcpy(blurredTo(i), lines + 16 * i, 16);
+                finish(i);
+            }
+            continue;
+        }
+
+        // Consume the source generating pixels.
+        blur.reset();
+        int i = 0;
+        for (; i < srcW; i++) {
+            blur.blur(lines + 16 * i, blurredTo(i));
+            finish(i);
+        }
+
+        // The leading edge is off the right side of the mask.
+        for (int end = std::min(dstW, srcW + noChangeCount); i < end; i++) {
+            blur.blur(nullptr, blurredTo(i));
+            finish(i);
+        }
+
+        // Starting from the right, fill in the rest of the buffer.
+        blur.reset();
+        for (int j = dstW, s = srcW; j > i;) {
+            j--;
+            s--;
+            blur.blur(lines + 16 * s, blurredTo(j));
+            finish(j);
+        }
+    }
+}
+
 // TODO: assuming sigmaW = sigmaH. Allow different sigmas. Right now the
 // API forces the sigmas to be the same.
 SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
@@ -962,11 +867,11 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
     // 1024 is a place holder guess until more analysis can be done.
     SkSTArenaAlloc<1024> alloc;
 
-    PlanGauss planW(fSigmaW);
-    PlanGauss planH(fSigmaH);
+    int windowW = calculate_window(fSigmaW),
+        windowH = calculate_window(fSigmaH);
 
-    int borderW = planW.border(),
-        borderH = planH.border();
+    int borderW = windowW > 1 ? Blur16::Border(windowW) : 0,
+        borderH = windowH > 1 ? Blur16::Border(windowH) : 0;
     SkASSERT(borderH >= 0 && borderW >= 0);
 
     *dst = SkMask::PrepareDestination(borderW, borderH, src);
@@ -984,8 +889,34 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
+    // Convert other formats to A8 first.
+    const uint8_t* a8 = src.fImage;
+    size_t a8RB = src.fRowBytes;
+    if (src.fFormat != SkMask::kA8_Format) {
+        ToA8* toA8;
+        size_t bytesPer8;
+        switch (src.fFormat) {
+            case SkMask::kBW_Format:     toA8 = bw_to_a8;     bytesPer8 =  1; break;
+            case SkMask::kARGB32_Format: toA8 = argb32_to_a8; bytesPer8 = 32; break;
+            case SkMask::kLCD16_Format:  toA8 = lcd_to_a8;    bytesPer8 = 16; break;
+            default:
+                SK_ABORT("Unhandled format.");
+        }
+        auto converted = alloc.makeArrayDefault<uint8_t>(srcW * srcH);
+        for (int y = 0; y < srcH; y++) {
+            const uint8_t* from = src.fImage + y * src.fRowBytes;
+            for (int x = 0; x < srcW; x += 8, from += bytesPer8) {
+                toA8(converted + y * srcW + x, from, std::min(8, srcW - x));
+            }
+        }
+        a8 = converted;
+        a8RB = srcW;
+    }
+
+    auto bufferSize = std::max(Blur16::BufferSize(std::max(windowW, 2)),
+                               Blur16::BufferSize(std::max(windowH, 2)));
+    auto buffer = alloc.makeArrayDefault<Sk4u>(bufferSize);
+    auto lines = alloc.makeArrayDefault<uint8_t>(16 * std::max(srcW, srcH));
 
     // Blur both directions.
     int tmpW = srcH,
@@ -994,58 +925,12 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
     auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
 
     // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
-    switch (src.fFormat) {
-        case SkMask::kBW_Format: {
-            const uint8_t* bwStart = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
-            auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kA8_Format: {
-            const uint8_t* a8Start = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
-            auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kARGB32_Format: {
-            const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
-            auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kLCD16_Format: {
-            const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
-            auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        default:
-            SK_ABORT("Unhandled format.");
-    }
+    blur_and_transpose(windowW, a8, a8RB, srcW, srcH, tmp, tmpW, tmpH, buffer, lines);
 
     // Blur vertically (scan in memory order because of the transposition),
     // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->fImage[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    blur_and_transpose(windowH, tmp, tmpW, tmpW, tmpH, dst->fImage, dst->fRowBytes, dstH,
+                       buffer, lines);
 
     return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
 }
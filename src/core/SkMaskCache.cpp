@@ -7,6 +7,9 @@
 
 #include "src/core/SkMaskCache.h"
 
+#include "include/private/SkIDChangeListener.h"
+#include "src/core/SkPathPriv.h"
+
 #define CHECK_LOCAL(localCache, localName, globalName, ...) \
     ((localCache) ? localCache->localName(__VA_ARGS__) : SkResourceCache::globalName(__VA_ARGS__))
 
@@ -183,3 +186,105 @@ void SkMaskCache::Add(SkScalar sigma, SkBlurStyle style,
     RectsBlurKey key(sigma, style, rects, count);
     return CHECK_LOCAL(localCache, add, Add, new RectsBlurRec(key, mask, data));
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+static unsigned gPathCoverageKeyNamespaceLabel;
+
+static uint64_t path_shared_id(uint32_t pathGenID) {
+    uint64_t sharedID = SkSetFourByteTag('p', 'a', 't', 'h');
+    return (sharedID << 32) | pathGenID;
+}
+
+struct PathCoverageKey : public SkResourceCache::Key {
+public:
+    PathCoverageKey(const SkPath& path, const SkMatrix& matrix)
+        : fGenID(path.getGenerationID())
+        , fFillType((int32_t)path.getFillType())
+    {
+        SkAssertResult(matrix.asAffine(fAffine));
+        this->init(&gPathCoverageKeyNamespaceLabel, path_shared_id(fGenID),
+                   sizeof(fGenID) + sizeof(fFillType) + sizeof(fAffine));
+    }
+
+    uint32_t   fGenID;
+    int32_t    fFillType;
+    SkScalar   fAffine[6];
+};
+
+// Purges a path's masks when its generation ID changes, or when the path is freed.
+class PathCoverageInvalidator : public SkIDChangeListener {
+public:
+    explicit PathCoverageInvalidator(uint32_t genID) : fSharedID(path_shared_id(genID)) {}
+
+    void changed() override { SkResourceCache::PostPurgeSharedID(fSharedID); }
+
+private:
+    uint64_t fSharedID;
+};
+
+struct PathCoverageRec : public SkResourceCache::Rec {
+    PathCoverageRec(PathCoverageKey key, const SkMask& mask, SkCachedData* data,
+                    sk_sp<PathCoverageInvalidator> invalidator)
+        : fKey(key)
+        , fInvalidator(std::move(invalidator))
+    {
+        fValue.fMask = mask;
+        fValue.fData = data;
+        fValue.fData->attachToCacheAndRef();
+    }
+    ~PathCoverageRec() override {
+        fValue.fData->detachFromCacheAndUnref();
+        // Once we're gone there's nothing to purge, so let the path drop the listener.
+        fInvalidator->markShouldDeregister();
+    }
+
+    PathCoverageKey                 fKey;
+    sk_sp<PathCoverageInvalidator>  fInvalidator;
+    MaskValue                       fValue;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fValue.fData->size(); }
+    const char* getCategory() const override { return "path-coverage"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override {
+        return fValue.fData->diagnostic_only_getDiscardable();
+    }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const PathCoverageRec& rec = static_cast<const PathCoverageRec&>(baseRec);
+        MaskValue* result = static_cast<MaskValue*>(contextData);
+
+        SkCachedData* tmpData = rec.fValue.fData;
+        tmpData->ref();
+        if (nullptr == tmpData->data()) {
+            tmpData->unref();
+            return false;
+        }
+        *result = rec.fValue;
+        return true;
+    }
+};
+} // namespace
+
+SkCachedData* SkMaskCache::FindAndRef(const SkPath& path, const SkMatrix& matrix, SkMask* mask,
+                                      SkResourceCache* localCache) {
+    MaskValue result;
+    PathCoverageKey key(path, matrix);
+    if (!CHECK_LOCAL(localCache, find, Find, key, PathCoverageRec::Visitor, &result)) {
+        return nullptr;
+    }
+
+    *mask = result.fMask;
+    mask->fImage = (uint8_t*)(result.fData->data());
+    return result.fData;
+}
+
+void SkMaskCache::Add(const SkPath& path, const SkMatrix& matrix, const SkMask& mask,
+                      SkCachedData* data, SkResourceCache* localCache) {
+    PathCoverageKey key(path, matrix);
+    auto invalidator = sk_make_sp<PathCoverageInvalidator>(key.fGenID);
+    SkPathPriv::AddGenIDChangeListener(path, invalidator);
+    return CHECK_LOCAL(localCache, add, Add,
+                       new PathCoverageRec(key, mask, data, std::move(invalidator)));
+}
@@ -9,6 +9,8 @@
 #define SkMaskCache_DEFINED
 
 #include "include/core/SkBlurTypes.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkRRect.h"
 #include "include/core/SkRect.h"
 #include "src/core/SkCachedData.h"
@@ -29,6 +31,12 @@ public:
     static SkCachedData* FindAndRef(SkScalar sigma, SkBlurStyle style,
                                     const SkRect rects[], int count, SkMask* mask,
                                     SkResourceCache* localCache = nullptr);
+    /**
+     * The antialiased coverage of a filled path, drawn with matrix. Entries are keyed by the
+     * path's generation ID and fill type, and purged when that generation ID goes away.
+     */
+    static SkCachedData* FindAndRef(const SkPath& path, const SkMatrix& matrix, SkMask* mask,
+                                    SkResourceCache* localCache = nullptr);
 
     /**
      * Add a mask and its pixel-data to the cache.
@@ -39,6 +47,8 @@ public:
     static void Add(SkScalar sigma, SkBlurStyle style,
                     const SkRect rects[], int count, const SkMask& mask, SkCachedData* data,
                     SkResourceCache* localCache = nullptr);
+    static void Add(const SkPath& path, const SkMatrix& matrix, const SkMask& mask,
+                    SkCachedData* data, SkResourceCache* localCache = nullptr);
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPackedRTree.h"
+
+#include "include/private/SkVx.h"
+
+// Without AVX, 8-wide compares are split in two anyway, and are slower than 4-wide ones.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
+    static constexpr int kLanes = 8;
+#else
+    static constexpr int kLanes = 4;
+#endif
+static_assert(SkPackedRTree::kMaxChildren % kLanes == 0, "");
+
+using F = skvx::Vec<kLanes, float>;
+using I = skvx::Vec<kLanes, int32_t>;
+
+SkPackedRTree::SkPackedRTree() : fCount(0), fRoot(0), fRootBounds(SkRect::MakeEmpty()) {}
+
+void SkPackedRTree::insert(const SkRect boundsArray[], int N) {
+    SkASSERT(0 == fCount);
+
+    std::vector<Branch> branches;
+    branches.reserve(N);
+
+    for (int i = 0; i < N; i++) {
+        const SkRect& bounds = boundsArray[i];
+        if (bounds.isEmpty()) {
+            continue;
+        }
+        branches.push_back({bounds, i});
+    }
+
+    fCount = (int)branches.size();
+    if (fCount) {
+        // Every level has ceil(branches / kMaxChildren) nodes. Reserving them isn't needed
+        // for correctness, as nodes refer to each other by index, but keeps bytesUsed() tight.
+        int nodes = 0;
+        for (int level = fCount; level > 1 || nodes == 0; ) {
+            level = (level + kMaxChildren - 1) / kMaxChildren;
+            nodes += level;
+        }
+        fNodes.reserve(nodes);
+
+        Branch root = this->bulkLoad(&branches);
+        fRoot       = root.fIndex;
+        fRootBounds = root.fBounds;
+    }
+}
+
+int SkPackedRTree::allocateNodeAtLevel(uint16_t level) {
+    fNodes.push_back(Node{});
+    Node& out = fNodes.back();
+    for (int i = 0; i < kMaxChildren; i++) {
+        out.fLeft  [i] = out.fTop   [i] = SK_ScalarInfinity;
+        out.fRight [i] = out.fBottom[i] = SK_ScalarNegativeInfinity;
+        out.fChildren[i] = -1;
+    }
+    out.fNumChildren = 0;
+    out.fLevel = level;
+    return (int)fNodes.size() - 1;
+}
+
+// This groups branches into nodes exactly as SkRTree::bulkLoad() does, one level at a time.
+SkPackedRTree::Branch SkPackedRTree::bulkLoad(std::vector<Branch>* branches) {
+    for (uint16_t level = 0; ; level++) {
+        // Even a single op gets a leaf node, so that leaves always hold op indices.
+        if (branches->size() == 1 && level > 0) {
+            return (*branches)[0];
+        }
+
+        int numBranches = (int)branches->size() / kMaxChildren;
+        int remainder   = (int)branches->size() % kMaxChildren;
+        int newBranches = 0;
+
+        if (remainder > 0) {
+            ++numBranches;
+            // If the remainder isn't enough to fill a node, we'll add fewer nodes to other
+            // branches.
+            if (remainder >= kMinChildren) {
+                remainder = 0;
+            } else {
+                remainder = kMinChildren - remainder;
+            }
+        }
+
+        int currentBranch = 0;
+        while (currentBranch < (int)branches->size()) {
+            int incrementBy = kMaxChildren;
+            if (remainder != 0) {
+                // if need be, omit some nodes to make up for remainder
+                if (remainder <= kMaxChildren - kMinChildren) {
+                    incrementBy -= remainder;
+                    remainder = 0;
+                } else {
+                    incrementBy = kMinChildren;
+                    remainder -= kMaxChildren - kMinChildren;
+                }
+            }
+            int index = this->allocateNodeAtLevel(level);
+            Node& n = fNodes[index];
+            Branch b = { (*branches)[currentBranch].fBounds, index };
+            for (int k = 0; k < incrementBy && currentBranch < (int)branches->size(); ++k) {
+                const Branch& child = (*branches)[currentBranch];
+                b.fBounds.join(child.fBounds);
+                n.fLeft  [k] = child.fBounds.fLeft;
+                n.fTop   [k] = child.fBounds.fTop;
+                n.fRight [k] = child.fBounds.fRight;
+                n.fBottom[k] = child.fBounds.fBottom;
+                n.fChildren[k] = child.fIndex;
+                ++n.fNumChildren;
+                ++currentBranch;
+            }
+            (*branches)[newBranches] = b;
+            ++newBranches;
+        }
+        branches->resize(newBranches);
+    }
+}
+
+void SkPackedRTree::search(const SkRect& query, std::vector<int>* results) const {
+    if (fCount > 0 && SkRect::Intersects(fRootBounds, query)) {
+        this->search(fRoot, query, results);
+    }
+}
+
+void SkPackedRTree::search(int index, const SkRect& query, std::vector<int>* results) const {
+    const Node& node = fNodes[index];
+    // Both the query and every child are non-empty here, so SkRect::Intersects() reduces to
+    // four strict compares.
+    const F l = query.fLeft,
+            t = query.fTop,
+            r = query.fRight,
+            b = query.fBottom;
+    for (int i = 0; i < node.fNumChildren; i += kLanes) {
+        const I hit = (F::Load(node.fLeft   + i) < r) & (l < F::Load(node.fRight  + i))
+                    & (F::Load(node.fTop    + i) < b) & (t < F::Load(node.fBottom + i));
+        if (!any(hit)) {
+            continue;
+        }
+        for (int j = 0; j < kLanes; j++) {
+            if (hit[j]) {
+                if (0 == node.fLevel) {
+                    results->push_back(node.fChildren[i + j]);
+                } else {
+                    this->search(node.fChildren[i + j], query, results);
+                }
+            }
+        }
+    }
+}
+
+size_t SkPackedRTree::bytesUsed() const {
+    size_t byteCount = sizeof(SkPackedRTree);
+
+    byteCount += fNodes.capacity() * sizeof(Node);
+
+    return byteCount;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPackedRTree_DEFINED
+#define SkPackedRTree_DEFINED
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkRect.h"
+
+#include <vector>
+
+/**
+ * An R-Tree like SkRTree, bulk-loaded the same way, but with wider nodes laid out for SIMD
+ * queries: each node stores its children's bounds as separate arrays of lefts, tops, rights
+ * and bottoms, so search() tests 8 children (4 without AVX) against the query per compare.
+ *
+ * Nodes refer to each other by index into one array rather than by pointer, which keeps
+ * them small enough that a node's bounds fit in a few cache lines.
+ */
+class SkPackedRTree : public SkBBoxHierarchy {
+public:
+    SkPackedRTree();
+
+    void insert(const SkRect[], int N) override;
+    void search(const SkRect& query, std::vector<int>* results) const override;
+    size_t bytesUsed() const override;
+
+    // Methods and constants below here are only public for tests.
+
+    // Return the depth of the tree structure.
+    int getDepth() const { return fCount ? fNodes[fRoot].fLevel + 1 : 0; }
+    // Insertion count (not overall node count, which may be greater).
+    int getCount() const { return fCount; }
+
+    static constexpr int kMinChildren = 9,
+                         kMaxChildren = 16;
+
+private:
+    struct Branch {
+        SkRect fBounds;
+        int    fIndex;  // An op index in leaves, otherwise a node index.
+    };
+
+    struct Node {
+        // Unused children have inverted, infinite bounds, so they never intersect a query.
+        float    fLeft  [kMaxChildren];
+        float    fTop   [kMaxChildren];
+        float    fRight [kMaxChildren];
+        float    fBottom[kMaxChildren];
+        int      fChildren[kMaxChildren];
+        uint16_t fNumChildren;
+        uint16_t fLevel;
+    };
+
+    void search(int node, const SkRect& query, std::vector<int>* results) const;
+
+    // Consumes the input array, returning the root.
+    Branch bulkLoad(std::vector<Branch>* branches);
+
+    int allocateNodeAtLevel(uint16_t level);
+
+    // This is the count of data elements (rather than total nodes in the tree)
+    int               fCount;
+    int               fRoot;
+    SkRect            fRootBounds;
+    std::vector<Node> fNodes;
+};
+
+#endif
@@ -32,7 +32,7 @@ SkPathRef::Editor::Editor(sk_sp<SkPathRef>* pathRef,
     }
     fPathRef = pathRef->get();
     fPathRef->callGenIDChangeListeners();
-    fPathRef->fGenerationID = 0;
+    fPathRef->fGenerationID.store(0, std::memory_order_relaxed);
     fPathRef->fBoundsIsDirty = true;
     SkDEBUGCODE(fPathRef->fEditorsAttached++;)
 }
@@ -52,7 +52,7 @@ void SkPath::shrinkToFit() {
 SkPathRef::~SkPathRef() {
     // Deliberately don't validate() this path ref, otherwise there's no way
     // to read one that's not valid and then free its memory without asserting.
-    SkDEBUGCODE(fGenerationID = 0xEEEEEEEE;)
+    SkDEBUGCODE(fGenerationID.store(0xEEEEEEEE);)
     SkDEBUGCODE(fEditorsAttached.store(0x7777777);)
 }
 
@@ -151,7 +151,7 @@ void SkPathRef::CreateTransformedCopy(sk_sp<SkPathRef>* dst,
         (*dst)->fVerbs = src.fVerbs;
         (*dst)->fConicWeights = src.fConicWeights;
         (*dst)->callGenIDChangeListeners();
-        (*dst)->fGenerationID = 0;  // mark as dirty
+        (*dst)->fGenerationID.store(0, std::memory_order_relaxed);  // mark as dirty
     }
 
     // Need to check this here in case (&src == dst)
@@ -200,7 +200,7 @@ void SkPathRef::CreateTransformedCopy(sk_sp<SkPathRef>* dst,
 
     if (dst->get() == &src) {
         (*dst)->callGenIDChangeListeners();
-        (*dst)->fGenerationID = 0;
+        (*dst)->fGenerationID.store(0, std::memory_order_relaxed);
     }
 
     SkDEBUGCODE((*dst)->validate();)
@@ -211,7 +211,7 @@ void SkPathRef::Rewind(sk_sp<SkPathRef>* pathRef) {
         SkDEBUGCODE((*pathRef)->validate();)
         (*pathRef)->callGenIDChangeListeners();
         (*pathRef)->fBoundsIsDirty = true;  // this also invalidates fIsFinite
-        (*pathRef)->fGenerationID = 0;
+        (*pathRef)->fGenerationID.store(0, std::memory_order_relaxed);
         (*pathRef)->fPoints.rewind();
         (*pathRef)->fVerbs.rewind();
         (*pathRef)->fConicWeights.rewind();
@@ -238,7 +238,8 @@ bool SkPathRef::operator== (const SkPathRef& ref) const {
         return false;
     }
 
-    bool genIDMatch = fGenerationID && fGenerationID == ref.fGenerationID;
+    const uint32_t genID = fGenerationID.load(std::memory_order_relaxed);
+    bool genIDMatch = genID && genID == ref.fGenerationID.load(std::memory_order_relaxed);
 #ifdef SK_RELEASE
     if (genIDMatch) {
         return true;
@@ -473,17 +474,23 @@ uint32_t SkPathRef::genID() const {
     SkASSERT(fEditorsAttached.load() == 0);
     static const uint32_t kMask = (static_cast<int64_t>(1) << SkPathPriv::kPathRefGenIDBitCnt) - 1;
 
-    if (fGenerationID == 0) {
+    uint32_t genID = fGenerationID.load(std::memory_order_relaxed);
+    if (genID == 0) {
         if (fPoints.count() == 0 && fVerbs.count() == 0) {
-            fGenerationID = kEmptyGenID;
+            genID = kEmptyGenID;
         } else {
             static std::atomic<uint32_t> nextID{kEmptyGenID + 1};
             do {
-                fGenerationID = nextID.fetch_add(1, std::memory_order_relaxed) & kMask;
-            } while (fGenerationID == 0 || fGenerationID == kEmptyGenID);
+                genID = nextID.fetch_add(1, std::memory_order_relaxed) & kMask;
+            } while (genID == 0 || genID == kEmptyGenID);
+        }
+        // If another thread assigned an ID first, everyone uses that one.
+        uint32_t expected = 0;
+        if (!fGenerationID.compare_exchange_strong(expected, genID, std::memory_order_relaxed)) {
+            genID = expected;
         }
     }
-    return fGenerationID;
+    return genID;
 }
 
 void SkPathRef::addGenIDChangeListener(sk_sp<SkIDChangeListener> listener) {
@@ -7,16 +7,21 @@
 
 #include "include/core/SkPicture.h"
 
+#include "include/core/SkCanvas.h"
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkMappedPicture.h"
 #include "src/core/SkMathPriv.h"
 #include "src/core/SkPictureCommon.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
+#include "src/core/SkRecordDiff.h"
+#include "src/core/SkTaskGroup.h"
 #include <atomic>
 
 // When we read/write the SkPictInfo via a stream, we have a sentinel byte right after the info.
@@ -31,6 +36,12 @@ enum {
     kCustom_TrailingStreamByteAfterPictInfo      = 2,   // -size32 follows
 };
 
+// Since kAlignedOpData_Version, SkPictureData is preceded by zeros padding the 28 byte
+// SkPictInfo and the trailing byte to 32 bytes, so that its op data, which it writes first, is
+// 4-byte aligned within the stream and can be read in place (see SkMappedPicture).
+static constexpr size_t kPictureDataPadding = 3;
+static_assert(sizeof(SkPictInfo) + 1 + kPictureDataPadding == 32, "");
+
 /* SkPicture impl.  This handles generic responsibilities like unique IDs and serialization. */
 
 SkPicture::SkPicture() {
@@ -147,8 +158,18 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     return MakeFromStream(&stream, procs, nullptr);
 }
 
+sk_sp<SkPicture> SkPicture::MakeFromMappedData(sk_sp<SkData> data,
+                                               const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    return MakeFromStream(&stream, procs, nullptr, data.get());
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                           SkTypefacePlayback* typefaces) {
+                                           SkTypefacePlayback* typefaces,
+                                           const SkData* streamData) {
     SkPictInfo info;
     if (!StreamIsSKP(stream, &info)) {
         return nullptr;
@@ -163,8 +184,14 @@ sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialPro
     if (!stream->readU8(&trailingStreamByteAfterPictInfo)) { return nullptr; }
     switch (trailingStreamByteAfterPictInfo) {
         case kPictureData_TrailingStreamByteAfterPictInfo: {
+            if (!SkPicturePriv::SkipPictureDataPadding(stream, info.getVersion())) {
+                return nullptr;
+            }
             std::unique_ptr<SkPictureData> data(
-                    SkPictureData::CreateFromStream(stream, info, procs, typefaces));
+                    SkPictureData::CreateFromStream(stream, info, procs, typefaces, streamData));
+            if (streamData) {
+                return SkMappedPicture::Make(info.fCullRect, std::move(data));
+            }
             return Forwardport(info, data.get(), nullptr);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
@@ -280,12 +307,19 @@ void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
     std::unique_ptr<SkPictureData> data(this->backport());
     if (data) {
         stream->write8(kPictureData_TrailingStreamByteAfterPictInfo);
+        static const uint8_t kZeros[kPictureDataPadding] = {0};
+        stream->write(kZeros, kPictureDataPadding);
         data->serialize(stream, procs, typefaceSet, textBlobsOnly);
     } else {
         stream->write8(kFailure_TrailingStreamByteAfterPictInfo);
     }
 }
 
+bool SkPicturePriv::SkipPictureDataPadding(SkStream* stream, uint32_t version) {
+    return version < kAlignedOpData_Version ||
+           stream->skip(kPictureDataPadding) == kPictureDataPadding;
+}
+
 void SkPicturePriv::Flatten(const sk_sp<const SkPicture> picture, SkWriteBuffer& buffer) {
     SkPictInfo info = picture->createHeader();
     std::unique_ptr<SkPictureData> data(picture->backport());
@@ -325,3 +359,85 @@ sk_sp<SkPicture> SkPicture::MakePlaceholder(SkRect cull) {
     };
     return sk_make_sp<Placeholder>(cull);
 }
+
+bool SkPicture::playbackTiled(const SkPixmap& dst, const SkMatrix* matrix, SkExecutor* executor,
+                              SkISize tileSize) const {
+    if (tileSize.isEmpty() ||
+        !SkCanvas::MakeRasterDirect(dst.info(), dst.writable_addr(), dst.rowBytes())) {
+        return false;
+    }
+
+    const int tilesX = 1 + (dst.width()  - 1) / tileSize.width(),
+              tilesY = 1 + (dst.height() - 1) / tileSize.height();
+
+    auto drawTile = [&](int i) {
+        const SkIRect tile = SkIRect::MakeXYWH((i % tilesX) * tileSize.width(),
+                                               (i / tilesX) * tileSize.height(),
+                                               tileSize.width(), tileSize.height());
+        // extractSubset() clips the edge tiles to dst.
+        SkPixmap pixels;
+        SkAssertResult(dst.extractSubset(&pixels, tile));
+
+        auto canvas = SkCanvas::MakeRasterDirect(pixels.info(), pixels.writable_addr(),
+                                                 pixels.rowBytes());
+        canvas->translate(-tile.x(), -tile.y());
+        if (matrix) {
+            canvas->concat(*matrix);
+        }
+        // The canvas clip is just this tile, so SkBigPicture will query its BBH.
+        this->playback(canvas.get());
+    };
+
+    if (executor) {
+        SkTaskGroup tasks(*executor);
+        tasks.batch(tilesX * tilesY, drawTile);
+        tasks.wait();
+    } else {
+        for (int i = 0; i < tilesX * tilesY; i++) {
+            drawTile(i);
+        }
+    }
+    return true;
+}
+
+SkRect SkPicture::computeDamage(const SkPicture& previous) const {
+    const SkBigPicture* before = previous.asSkBigPicture();
+    const SkBigPicture* after  = this->asSkBigPicture();
+    // Only drawables can draw a picture differently from one time to the next.
+    if (this == &previous && !(after && after->drawableCount() > 0)) {
+        return SkRect::MakeEmpty();
+    }
+    if (before && after) {
+        return SkRecordDiff(*before->record(), before->cullRect(),
+                            *after->record(),  after->cullRect());
+    }
+    SkRect damage = previous.cullRect();
+    damage.join(this->cullRect());
+    return damage;
+}
+
+SkIRect SkPicture::playbackDamage(const SkPixmap& dst, const SkMatrix* matrix,
+                                  const SkPicture& previous) const {
+    SkRect damage = this->computeDamage(previous);
+    if (damage.isEmpty()) {
+        return SkIRect::MakeEmpty();
+    }
+    if (matrix) {
+        damage = matrix->mapRect(damage);
+    }
+    // Antialiasing can touch the pixels just outside the bounds of what's drawn.
+    SkIRect pixels = damage.roundOut().makeOutset(1, 1);
+    auto canvas = SkCanvas::MakeRasterDirect(dst.info(), dst.writable_addr(), dst.rowBytes());
+    if (!canvas || !pixels.intersect(dst.bounds())) {
+        return SkIRect::MakeEmpty();
+    }
+
+    // The canvas clip is just the damage, so SkBigPicture will query its BBH.
+    canvas->clipRect(SkRect::Make(pixels));
+    canvas->clear(SK_ColorTRANSPARENT);
+    if (matrix) {
+        canvas->concat(*matrix);
+    }
+    this->playback(canvas.get());
+    return pixels;
+}
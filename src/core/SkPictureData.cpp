@@ -281,15 +281,37 @@ void SkPictureData::flatten(SkWriteBuffer& buffer) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// If stream is reading from streamData's memory, skips the next size bytes of the stream and
+// returns them as a subset of streamData, as long as they're aligned for an SkReadBuffer.
+// Otherwise returns nullptr without touching the stream.
+static sk_sp<SkData> share_from_stream(SkStream* stream, const SkData* streamData, size_t size) {
+    if (!streamData || stream->getMemoryBase() != streamData->data() || !stream->hasPosition()) {
+        return nullptr;
+    }
+    const size_t offset = stream->getPosition();
+    if (offset > streamData->size() || size > streamData->size() - offset || 0 == size ||
+        !SkIsAlign4(reinterpret_cast<uintptr_t>(streamData->bytes() + offset))) {
+        return nullptr;
+    }
+    if (stream->skip(size) != size) {
+        return nullptr;
+    }
+    return SkData::MakeSubset(streamData, offset, size);
+}
+
 bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
-                                   SkTypefacePlayback* topLevelTFPlayback) {
+                                   SkTypefacePlayback* topLevelTFPlayback,
+                                   const SkData* streamData) {
     switch (tag) {
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            fOpData = share_from_stream(stream, streamData, size);
+            if (!fOpData) {
+                fOpData = SkData::MakeFromStream(stream, size);
+            }
             if (!fOpData) {
                 return false;
             }
@@ -338,12 +360,15 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             }
         } break;
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            // Paints, paths and the like are decoded out of this buffer, so we don't need to
+            // keep it, but can still avoid copying it.
+            sk_sp<SkData> shared = share_from_stream(stream, streamData, size);
+            SkAutoMalloc storage(shared ? 0 : size);
+            if (!shared && stream->read(storage.get(), size) != size) {
                 return false;
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(shared ? shared->data() : storage.get(), size);
             buffer.setVersion(fInfo.getVersion());
 
             if (!fFactoryPlayback) {
@@ -472,13 +497,14 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
 SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
-                                               SkTypefacePlayback* topLevelTFPlayback) {
+                                               SkTypefacePlayback* topLevelTFPlayback,
+                                               const SkData* streamData) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback)) {
+    if (!data->parseStream(stream, procs, topLevelTFPlayback, streamData)) {
         return nullptr;
     }
     return data.release();
@@ -497,7 +523,8 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
 
 bool SkPictureData::parseStream(SkStream* stream,
                                 const SkDeserialProcs& procs,
-                                SkTypefacePlayback* topLevelTFPlayback) {
+                                SkTypefacePlayback* topLevelTFPlayback,
+                                const SkData* streamData) {
     for (;;) {
         uint32_t tag;
         if (!stream->readU32(&tag)) { return false; }
@@ -507,7 +534,7 @@ bool SkPictureData::parseStream(SkStream* stream,
 
         uint32_t size;
         if (!stream->readU32(&size)) { return false; }
-        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback)) {
+        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, streamData)) {
             return false; // we're invalid
         }
     }
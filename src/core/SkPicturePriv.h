@@ -11,6 +11,7 @@
 #include "include/core/SkPicture.h"
 
 class SkReadBuffer;
+class SkStream;
 class SkWriteBuffer;
 
 class SkPicturePriv {
@@ -35,6 +36,13 @@ public:
         return picture->asSkBigPicture();
     }
 
+    /**
+     *  Skips the zeros that pad a serialized SkPictInfo and the byte after it to 32 bytes, when
+     *  |version| writes them (kAlignedOpData_Version and later).  Call this after reading that
+     *  byte, before the SkPictureData.  Returns false if the stream ends early.
+     */
+    static bool SkipPictureDataPadding(SkStream* stream, uint32_t version);
+
     // V35: Store SkRect (rather then width & height) in header
     // V36: Remove (obsolete) alphatype from SkColorTable
     // V37: Added shadow only option to SkDropShadowImageFilter (last version to record CLEAR)
@@ -80,6 +88,7 @@ public:
     // V77: Explicit filtering options on imageshaders
     // V78: Serialize skmipmap data for images that have it
     // V79: Cubic Resampler option on imageshader
+    // V80: Pad SkPictureData to 4 bytes after the stream's trailing byte, aligning its op data
 
     enum Version {
         kMorphologyTakesScalar_Version      = 74,
@@ -88,10 +97,11 @@ public:
         kFilterOptionsInImageShader_Version = 77,
         kSerializeMipmaps_Version           = 78,
         kCubicResamplerImageShader_Version  = 79,
+        kAlignedOpData_Version              = 80,
 
         // Only SKPs within the min/current picture version range (inclusive) can be read.
         kMin_Version     = kMorphologyTakesScalar_Version,
-        kCurrent_Version = kCubicResamplerImageShader_Version
+        kCurrent_Version = kAlignedOpData_Version
     };
 };
 
@@ -51,6 +51,14 @@ SkCanvas* SkPictureRecorder::beginRecording(const SkRect& bounds,
     return this->beginRecording(bounds, factory ? (*factory)() : nullptr, flags);
 }
 
+void SkPictureRecorder::optimize() {
+    SkRecordOptimize(fRecord.get());
+    if ((fFlags & kBatchDraws_RecordFlag) && !fBBH) {
+        SkRecordBatchDraws(fRecord.get());
+        fRecord->defrag();
+    }
+}
+
 SkCanvas* SkPictureRecorder::getRecordingCanvas() {
     return fActivelyRecording ? fRecorder.get() : nullptr;
 }
@@ -72,7 +80,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture(uint32_t finishFlag
     }
 
     // TODO: delay as much of this work until just before first playback?
-    SkRecordOptimize(fRecord.get());
+    this->optimize();
 
     SkDrawableList* drawableList = fRecorder->getDrawableList();
     std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
@@ -134,7 +142,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable(uint32_t finishFl
     fRecorder->flushMiniRecorder();
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
-    SkRecordOptimize(fRecord.get());
+    this->optimize();
 
     if (fBBH.get()) {
         SkAutoTMalloc<SkRect> bounds(fRecord->count());
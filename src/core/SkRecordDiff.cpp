@@ -0,0 +1,593 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkRecordDiff.h"
+
+#include "include/private/SkTemplates.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecords.h"
+#include "src/utils/SkPatchUtils.h"
+
+#include <vector>
+
+using namespace SkRecords;
+
+namespace {
+
+// Field by field equality. Pointers to refcounted objects (images, pictures, shaders...) compare
+// by identity, as SkPaint::operator==() does for its effects.
+template <typename T>
+bool eq(const T& a, const T& b) { return a == b; }
+
+template <typename T>
+bool eq(const Optional<T>& a, const Optional<T>& b) {
+    return (a == nullptr && b == nullptr) || (a && b && eq(*a, *b));
+}
+
+bool eq(const ClipOpAndAA& a, const ClipOpAndAA& b) {
+    return a.op() == b.op() && a.aa() == b.aa();
+}
+
+bool eq(const SkDrawShadowRec& a, const SkDrawShadowRec& b) {
+    return a.fZPlaneParams == b.fZPlaneParams
+        && a.fLightPos     == b.fLightPos
+        && a.fLightRadius  == b.fLightRadius
+        && a.fAmbientColor == b.fAmbientColor
+        && a.fSpotColor    == b.fSpotColor
+        && a.fFlags        == b.fFlags;
+}
+
+// Either array may be null.
+template <typename T>
+bool eq(const T* a, const T* b, int count) {
+    if (a == nullptr || b == nullptr) {
+        return a == b;
+    }
+    return 0 == memcmp(a, b, count * sizeof(T));
+}
+
+// Unless we know better, assume ops draw differently. (DrawDrawable lands here, as drawables
+// may draw something different each time they're drawn.)
+template <typename T>
+bool equal(const T&, const T&) { return false; }
+
+bool equal(const NoOp&, const NoOp&) { return true; }
+bool equal(const Flush&, const Flush&) { return true; }
+bool equal(const Save&, const Save&) { return true; }
+bool equal(const Restore& a, const Restore& b) { return eq(a.matrix, b.matrix); }
+
+bool equal(const SaveLayer& a, const SaveLayer& b) {
+    return eq(a.bounds, b.bounds) && eq(a.paint, b.paint) && eq(a.backdrop, b.backdrop)
+        && a.saveLayerFlags == b.saveLayerFlags;
+}
+bool equal(const SaveBehind& a, const SaveBehind& b) { return eq(a.subset, b.subset); }
+bool equal(const MarkCTM& a, const MarkCTM& b) { return eq(a.name, b.name); }
+
+bool equal(const SetMatrix& a, const SetMatrix& b) { return eq(a.matrix, b.matrix); }
+bool equal(const Concat&    a, const Concat&    b) { return eq(a.matrix, b.matrix); }
+bool equal(const Concat44&  a, const Concat44&  b) { return eq(a.matrix, b.matrix); }
+bool equal(const Translate& a, const Translate& b) { return a.dx == b.dx && a.dy == b.dy; }
+bool equal(const Scale&     a, const Scale&     b) { return a.sx == b.sx && a.sy == b.sy; }
+
+bool equal(const ClipPath& a, const ClipPath& b) {
+    return eq(a.opAA, b.opAA) && eq<SkPath>(a.path, b.path);
+}
+bool equal(const ClipRRect& a, const ClipRRect& b) {
+    return eq(a.opAA, b.opAA) && eq(a.rrect, b.rrect);
+}
+bool equal(const ClipRect& a, const ClipRect& b) {
+    return eq(a.opAA, b.opAA) && eq(a.rect, b.rect);
+}
+bool equal(const ClipRegion& a, const ClipRegion& b) {
+    return a.op == b.op && eq(a.region, b.region);
+}
+bool equal(const ClipShader& a, const ClipShader& b) {
+    return a.op == b.op && eq(a.shader, b.shader);
+}
+
+bool equal(const DrawArc& a, const DrawArc& b) {
+    return eq(a.oval, b.oval) && a.startAngle == b.startAngle && a.sweepAngle == b.sweepAngle
+        && a.useCenter == b.useCenter && eq(a.paint, b.paint);
+}
+bool equal(const DrawDRRect& a, const DrawDRRect& b) {
+    return eq(a.outer, b.outer) && eq(a.inner, b.inner) && eq(a.paint, b.paint);
+}
+bool equal(const DrawImage& a, const DrawImage& b) {
+    return eq(a.image, b.image) && a.left == b.left && a.top == b.top && eq(a.paint, b.paint);
+}
+bool equal(const DrawImageLattice& a, const DrawImageLattice& b) {
+    return eq(a.image, b.image) && eq(a.src, b.src) && eq(a.dst, b.dst)
+        && a.xCount == b.xCount && eq<int>(a.xDivs, b.xDivs, a.xCount)
+        && a.yCount == b.yCount && eq<int>(a.yDivs, b.yDivs, a.yCount)
+        && a.flagCount == b.flagCount
+        && eq<SkCanvas::Lattice::RectType>(a.flags, b.flags, a.flagCount)
+        && eq<SkColor>(a.colors, b.colors, a.flagCount)
+        && eq(a.paint, b.paint);
+}
+bool equal(const DrawImageRect& a, const DrawImageRect& b) {
+    return eq(a.image, b.image) && eq(a.src, b.src) && eq(a.dst, b.dst)
+        && a.constraint == b.constraint && eq(a.paint, b.paint);
+}
+bool equal(const DrawImageNine& a, const DrawImageNine& b) {
+    return eq(a.image, b.image) && eq(a.center, b.center) && eq(a.dst, b.dst)
+        && eq(a.paint, b.paint);
+}
+bool equal(const DrawOval& a, const DrawOval& b) {
+    return eq(a.oval, b.oval) && eq(a.paint, b.paint);
+}
+bool equal(const DrawPaint& a, const DrawPaint& b) { return eq(a.paint, b.paint); }
+bool equal(const DrawBehind& a, const DrawBehind& b) { return eq(a.paint, b.paint); }
+bool equal(const DrawRRect& a, const DrawRRect& b) {
+    return eq(a.rrect, b.rrect) && eq(a.paint, b.paint);
+}
+bool equal(const DrawRect& a, const DrawRect& b) {
+    return eq(a.rect, b.rect) && eq(a.paint, b.paint);
+}
+bool equal(const DrawRegion& a, const DrawRegion& b) {
+    return eq(a.region, b.region) && eq(a.paint, b.paint);
+}
+bool equal(const DrawPath& a, const DrawPath& b) {
+    return eq<SkPath>(a.path, b.path) && eq(a.paint, b.paint);
+}
+bool equal(const DrawPicture& a, const DrawPicture& b) {
+    return eq(a.picture, b.picture) && eq(a.matrix, b.matrix) && eq(a.paint, b.paint);
+}
+bool equal(const DrawPoints& a, const DrawPoints& b) {
+    return a.mode == b.mode && a.count == b.count && eq<SkPoint>(a.pts, b.pts, a.count)
+        && eq(a.paint, b.paint);
+}
+bool equal(const DrawTextBlob& a, const DrawTextBlob& b) {
+    return eq(a.blob, b.blob) && a.x == b.x && a.y == b.y && eq(a.paint, b.paint);
+}
+bool equal(const DrawPatch& a, const DrawPatch& b) {
+    return eq<SkPoint>(a.cubics, b.cubics, SkPatchUtils::kNumCtrlPts)
+        && eq<SkColor>(a.colors, b.colors, SkPatchUtils::kNumCorners)
+        && eq<SkPoint>(a.texCoords, b.texCoords, SkPatchUtils::kNumCorners)
+        && a.bmode == b.bmode && eq(a.paint, b.paint);
+}
+bool equal(const DrawAtlas& a, const DrawAtlas& b) {
+    return eq(a.atlas, b.atlas) && a.count == b.count
+        && eq<SkRSXform>(a.xforms, b.xforms, a.count)
+        && eq<SkRect>(a.texs, b.texs, a.count)
+        && eq<SkColor>(a.colors, b.colors, a.count)
+        && a.mode == b.mode && eq(a.cull, b.cull) && eq(a.paint, b.paint);
+}
+bool equal(const DrawVertices& a, const DrawVertices& b) {
+    return eq(a.vertices, b.vertices) && a.bmode == b.bmode && eq(a.paint, b.paint);
+}
+bool equal(const DrawShadowRec& a, const DrawShadowRec& b) {
+    return eq<SkPath>(a.path, b.path) && eq(a.rec, b.rec);
+}
+bool equal(const DrawAnnotation& a, const DrawAnnotation& b) {
+    return eq(a.rect, b.rect) && eq(a.key, b.key)
+        && (a.value == b.value || (a.value && b.value && a.value->equals(b.value.get())));
+}
+bool equal(const DrawEdgeAAQuad& a, const DrawEdgeAAQuad& b) {
+    return eq(a.rect, b.rect) && eq<SkPoint>(a.clip, b.clip, 4) && a.aa == b.aa
+        && eq(a.color, b.color) && a.mode == b.mode;
+}
+bool equal(const DrawEdgeAAImageSet& a, const DrawEdgeAAImageSet& b) {
+    // Sets with per-entry clips or matrices are rare enough not to bother comparing.
+    if (a.dstClips || b.dstClips || a.preViewMatrices || b.preViewMatrices ||
+        a.count != b.count || a.constraint != b.constraint || !eq(a.paint, b.paint)) {
+        return false;
+    }
+    for (int i = 0; i < a.count; i++) {
+        const SkCanvas::ImageSetEntry& ea = a.set[i];
+        const SkCanvas::ImageSetEntry& eb = b.set[i];
+        if (!eq(ea.fImage, eb.fImage) || !eq(ea.fSrcRect, eb.fSrcRect) ||
+            !eq(ea.fDstRect, eb.fDstRect) || ea.fAlpha != eb.fAlpha ||
+            ea.fAAFlags != eb.fAAFlags) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+struct As {
+    const T* ptr = nullptr;
+
+    void operator()(const T& op) { ptr = &op; }
+    template <typename U>
+    void operator()(const U&) {}
+};
+
+// Compares an op with op j of another record.
+class OpsEqual {
+public:
+    OpsEqual(const SkRecord& other, int j) : fOther(other), fJ(j) {}
+
+    template <typename T>
+    bool operator()(const T& op) {
+        As<T> other;
+        fOther.visit(fJ, other);
+        return other.ptr && equal(op, *other.ptr);
+    }
+
+private:
+    const SkRecord& fOther;
+    const int       fJ;
+};
+
+// The state an op is drawn with is a node in a tree. Its ancestors are the save, matrix and clip
+// ops drawn before it that are still in effect, innermost first.
+struct StateNode {
+    int op;      // The save, matrix or clip op.
+    int parent;  // -1 for the initial state.
+};
+
+// Hashes the matrix, clip and layer state each op is drawn with, and tracks the node for it.
+// The hash only needs to be as precise as equal(): state ops fold in the same fields it
+// compares, and anything compared by identity is hashed by address.
+class StateHasher {
+public:
+    void visit(const SkRecord& record, int i) {
+        fCurrentOp = i;
+        record.visit(i, *this);
+    }
+
+    // The state the next op will be drawn with.
+    uint32_t state() const {
+        const int depth = (int)fStack.size();
+        return SkOpts::hash(&depth, sizeof(depth), fState);
+    }
+    int node() const { return fNode; }
+
+    std::vector<StateNode> detachNodes() { return std::move(fNodes); }
+
+    // Draws don't change the state.
+    template <typename T>
+    void operator()(const T&) {}
+
+    void operator()(const Save&) {
+        this->push();
+        this->refine(Save_Type);
+    }
+    void operator()(const Restore&) {
+        if (!fStack.empty()) {
+            fState = fStack.back().state;
+            fNode  = fStack.back().node;
+            fStack.pop_back();
+        }
+    }
+    void operator()(const SaveLayer& op) {
+        this->push();
+        this->refine(SaveLayer_Type);
+        this->mixOptional(op.bounds);
+        if (op.paint) {
+            this->mixPaint(*op.paint);
+        }
+        this->mix(op.backdrop.get());
+        this->mix(op.saveLayerFlags);
+    }
+    void operator()(const SaveBehind& op) {
+        this->push();
+        this->refine(SaveBehind_Type);
+        this->mixOptional(op.subset);
+    }
+
+    void operator()(const SetMatrix& op) {
+        this->refine(SetMatrix_Type);
+        this->mixMatrix(op.matrix);
+    }
+    void operator()(const Concat& op) {
+        this->refine(Concat_Type);
+        this->mixMatrix(op.matrix);
+    }
+    void operator()(const Concat44&  op) {
+        SkScalar m[16];
+        op.matrix.getColMajor(m);
+        this->refine(Concat44_Type);
+        this->mix(m);
+    }
+    void operator()(const Translate& op) {
+        this->refine(Translate_Type);
+        this->mix(op.dx);
+        this->mix(op.dy);
+    }
+    void operator()(const Scale& op) {
+        this->refine(Scale_Type);
+        this->mix(op.sx);
+        this->mix(op.sy);
+    }
+
+    void operator()(const ClipRect& op) {
+        this->refine(ClipRect_Type);
+        this->mixOpAA(op.opAA);
+        this->mix(op.rect);
+    }
+    void operator()(const ClipRRect& op) {
+        SkScalar rrect[SkRRect::kSizeInMemory / sizeof(SkScalar)];
+        op.rrect.writeToMemory(rrect);
+        this->refine(ClipRRect_Type);
+        this->mixOpAA(op.opAA);
+        this->mix(rrect);
+    }
+    void operator()(const ClipPath& op) {
+        this->refine(ClipPath_Type);
+        this->mixOpAA(op.opAA);
+        this->mix(op.path.getFillType());
+        SkAutoSTMalloc<32, SkPoint> points(op.path.countPoints());
+        op.path.getPoints(points.get(), op.path.countPoints());
+        fState = SkOpts::hash(points.get(), op.path.countPoints() * sizeof(SkPoint), fState);
+        SkAutoSTMalloc<32, uint8_t> verbs(op.path.countVerbs());
+        op.path.getVerbs(verbs.get(), op.path.countVerbs());
+        fState = SkOpts::hash(verbs.get(), op.path.countVerbs(), fState);
+    }
+    void operator()(const ClipRegion& op) {
+        const size_t size = op.region.writeToMemory(nullptr);
+        SkAutoSTMalloc<64, uint8_t> region(size);
+        op.region.writeToMemory(region.get());
+        this->refine(ClipRegion_Type);
+        this->mix(op.op);
+        fState = SkOpts::hash(region.get(), size, fState);
+    }
+    void operator()(const ClipShader& op) {
+        this->refine(ClipShader_Type);
+        this->mix(op.op);
+        this->mix(op.shader.get());
+    }
+
+private:
+    // Starts a save block, which Restore returns to the current state.
+    void push() { fStack.push_back({fState, fNode}); }
+
+    // The ops after the current one are drawn in a new state, with the current op as its node.
+    // The caller mixes in the current op's fields.
+    void refine(Type type) {
+        fNodes.push_back({fCurrentOp, fNode});
+        fNode = (int)fNodes.size() - 1;
+        this->mix(type);
+    }
+
+    template <typename T>
+    void mix(const T& value) { fState = SkOpts::hash(&value, sizeof(value), fState); }
+
+    template <typename T>
+    void mixOptional(const Optional<T>& value) {
+        this->mix(value != nullptr);
+        if (value) {
+            this->mix(*value);
+        }
+    }
+
+    void mixOpAA(const ClipOpAndAA& opAA) {
+        this->mix(opAA.op());
+        this->mix(opAA.aa());
+    }
+
+    void mixMatrix(const SkMatrix& matrix) {
+        SkScalar m[9];
+        matrix.get9(m);
+        this->mix(m);
+    }
+
+    void mixPaint(const SkPaint& paint) {
+        this->mix(paint.getColor4f());
+        this->mix(paint.getStrokeWidth());
+        this->mix(paint.getStrokeMiter());
+        this->mix(paint.getStrokeCap());
+        this->mix(paint.getStrokeJoin());
+        this->mix(paint.getStyle());
+        this->mix(paint.isAntiAlias());
+        this->mix(paint.isDither());
+        this->mix(paint.getFilterQuality());
+        this->mix(paint.getBlendMode());
+        this->mix(paint.getShader());
+        this->mix(paint.getColorFilter());
+        this->mix(paint.getPathEffect());
+        this->mix(paint.getMaskFilter());
+        this->mix(paint.getImageFilter());
+    }
+
+    struct Saved {
+        uint32_t state;
+        int      node;
+    };
+
+    uint32_t               fState = 0;
+    int                    fNode = -1;
+    std::vector<StateNode> fNodes;
+    std::vector<Saved>     fStack;
+    int                    fCurrentOp = 0;
+};
+
+// Finds the SaveLayers with backdrop filters, and where each may draw. A backdrop filter reads
+// what's beneath its layer, so it fills the layer's bounds, or the clip if it has none, whatever
+// the layer's contents are. We don't track clips, so that's anywhere in the cull.
+struct Backdrop {
+    int    op;
+    SkRect area;
+};
+
+class BackdropFinder {
+public:
+    explicit BackdropFinder(const SkRect& cull) : fCull(cull) {}
+
+    void visit(const SkRecord& record, int i) {
+        fCurrentOp = i;
+        record.visit(i, *this);
+    }
+
+    // In record order.
+    std::vector<Backdrop> backdrops;
+
+    template <typename T>
+    void operator()(const T&) {}
+
+    void operator()(const Save&)       { fPaintedLayers.push_back(fPaintedLayers.back()); }
+    void operator()(const SaveBehind&) { fPaintedLayers.push_back(fPaintedLayers.back()); }
+    void operator()(const SaveLayer& op) {
+        // A layer's paint may move what's drawn in it anywhere, e.g. with an offset image filter.
+        const bool painted = fPaintedLayers.back() || op.paint;
+        if (op.backdrop) {
+            SkRect area = fCull;
+            if (op.bounds && !painted) {
+                area = fCTM.mapRect(*op.bounds);
+                if (!area.intersect(fCull)) {
+                    area.setEmpty();
+                }
+            }
+            backdrops.push_back({fCurrentOp, area});
+        }
+        fPaintedLayers.push_back(painted);
+    }
+    void operator()(const Restore& op) {
+        fCTM = op.matrix;
+        if (fPaintedLayers.size() > 1) {
+            fPaintedLayers.pop_back();
+        }
+    }
+
+    void operator()(const SetMatrix& op) { fCTM = op.matrix; }
+    void operator()(const Concat44& op)  { fCTM.preConcat(op.matrix.asM33()); }
+    void operator()(const Concat& op)    { fCTM.preConcat(op.matrix); }
+    void operator()(const Scale& op)     { fCTM.preScale(op.sx, op.sy); }
+    void operator()(const Translate& op) { fCTM.preTranslate(op.dx, op.dy); }
+
+private:
+    const SkRect      fCull;
+    SkMatrix          fCTM = SkMatrix::I();
+    std::vector<bool> fPaintedLayers{false};
+    int               fCurrentOp = 0;
+};
+
+struct Ops {
+    Ops(const SkRecord& record, const SkRect& cull)
+        : record(record)
+        , states(record.count())
+        , stateNodes(record.count())
+        , bounds(record.count()) {
+        StateHasher hasher;
+        BackdropFinder finder(cull);
+        for (int i = 0; i < record.count(); i++) {
+            states[i] = hasher.state();
+            stateNodes[i] = hasher.node();
+            hasher.visit(record, i);
+            finder.visit(record, i);
+        }
+        nodes = hasher.detachNodes();
+        backdrops = std::move(finder.backdrops);
+
+        SkAutoTMalloc<SkBBoxHierarchy::Metadata> meta(record.count());
+        SkRecordFillBounds(cull, record, bounds.get(), meta.get());
+        // A backdrop layer also draws wherever its contents do.
+        for (Backdrop& backdrop : backdrops) {
+            backdrop.area.join(bounds[backdrop.op]);
+        }
+        // Matrix and clip ops get the bounds of their whole save block, but they don't draw.
+        // What changing them does to the draws after them shows up in those draws' states.
+        for (int i = 0; i < record.count(); i++) {
+            if (!meta[i].isDraw) {
+                bounds[i].setEmpty();
+            }
+        }
+    }
+
+    const SkRecord&          record;
+    SkAutoTMalloc<uint32_t>  states;
+    SkAutoTMalloc<int>       stateNodes;
+    std::vector<StateNode>   nodes;
+    SkAutoTMalloc<SkRect>    bounds;
+    std::vector<Backdrop>    backdrops;
+};
+
+// Matches ops of two records that are equal and drawn in the same state.
+class OpMatcher {
+public:
+    OpMatcher(const Ops& a, const Ops& b) : fA(a), fB(b) {}
+
+    bool operator()(int i, int j) {
+        return fA.states[i] == fB.states[j]
+            && this->sameState(fA.stateNodes[i], fB.stateNodes[j])
+            && fA.record.visit(i, OpsEqual(fB.record, j));
+    }
+
+private:
+    // Equal state hashes may still collide, so compare the state ops themselves. Neighbouring
+    // ops mostly share their state, or nest it in the one we last compared, so we remember that.
+    bool sameState(int x, int y) {
+        const int startX = x,
+                  startY = y;
+        while ((x >= 0 || y >= 0) && (x != fSameX || y != fSameY)) {
+            if (x < 0 || y < 0 ||
+                !fA.record.visit(fA.nodes[x].op, OpsEqual(fB.record, fB.nodes[y].op))) {
+                return false;
+            }
+            x = fA.nodes[x].parent;
+            y = fB.nodes[y].parent;
+        }
+        fSameX = startX;
+        fSameY = startY;
+        return true;
+    }
+
+    const Ops& fA;
+    const Ops& fB;
+    int        fSameX = -1,
+               fSameY = -1;
+};
+
+}  // namespace
+
+SkRect SkRecordDiff(const SkRecord& before, const SkRect& beforeCull,
+                    const SkRecord& after,  const SkRect& afterCull) {
+    // Unbounded draws like drawPaint() fill the cull rect, so they'd differ if it did.
+    if (beforeCull != afterCull) {
+        SkRect damage = beforeCull;
+        damage.join(afterCull);
+        return damage;
+    }
+
+    const Ops a(before, beforeCull),
+              b(after,  afterCull);
+    const int n = before.count(),
+              m = after.count();
+
+    OpMatcher same_op(a, b);
+    int prefix = 0;
+    while (prefix < n && prefix < m && same_op(prefix, prefix)) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix &&
+           same_op(n - 1 - suffix, m - 1 - suffix)) {
+        suffix++;
+    }
+
+    SkRect damage = SkRect::MakeEmpty();
+    for (int i = prefix; i < n - suffix; i++) {
+        damage.join(a.bounds[i]);
+    }
+    for (int j = prefix; j < m - suffix; j++) {
+        damage.join(b.bounds[j]);
+    }
+    // SaveLayers aren't draws, so backdrop layers that changed add their areas here.
+    for (const Ops* ops : {&a, &b}) {
+        for (const Backdrop& backdrop : ops->backdrops) {
+            if (backdrop.op >= prefix && backdrop.op < ops->record.count() - suffix) {
+                damage.join(backdrop.area);
+            }
+        }
+    }
+
+    // The matched backdrop layers after that filter what was damaged beneath them, so they
+    // redraw all their areas too. (Those before it read nothing that changed.)
+    if (!damage.isEmpty()) {
+        for (const Ops* ops : {&a, &b}) {
+            for (const Backdrop& backdrop : ops->backdrops) {
+                if (backdrop.op >= ops->record.count() - suffix) {
+                    damage.join(backdrop.area);
+                }
+            }
+        }
+    }
+    return damage;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRecordDiff_DEFINED
+#define SkRecordDiff_DEFINED
+
+#include "include/core/SkRect.h"
+
+class SkRecord;
+
+// Compares two records op by op, and returns conservative bounds, in record space, of everything
+// that drawing after may draw differently than drawing before.
+//
+// Ops are matched from the start of both records, and then from their ends, so that a change
+// in the middle of a record (e.g. one widget of a UI redrawn differently) damages only the bounds
+// of the ops in between, as computed by SkRecordFillBounds() with each record's cull rect.
+// Ops only match if they're equal and drawn in the same matrix, clip and layer state.
+// Drawables, and any ops we don't know how to compare, never match. Matched layers with backdrop
+// filters are damaged too if anything drawn before them is, as they filter what's beneath them.
+SkRect SkRecordDiff(const SkRecord& before, const SkRect& beforeCull,
+                    const SkRecord& after,  const SkRect& afterCull);
+
+#endif//SkRecordDiff_DEFINED
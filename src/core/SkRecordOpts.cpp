@@ -11,6 +11,7 @@
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkRecordPattern.h"
 #include "src/core/SkRecords.h"
+#include "src/core/SkTextBlobPriv.h"
 
 using namespace SkRecords;
 
@@ -286,6 +287,202 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Batching is a linear pass rather than a Pattern: runs have no fixed length, and the ops in a run
+// must also agree with each other (e.g. share a paint), not just have the right types.
+//
+// We cap the length of a run so that each batch still gets reasonably tight bounds in the BBH.
+static constexpr int kMaxBatchedDraws = 64;
+
+template <typename T>
+static T* get_as(SkRecord* record, int i) {
+    Is<T> is;
+    return record->mutate(i, is) ? is.get() : nullptr;
+}
+
+static bool same_paint(const SkPaint* a, const SkPaint* b) {
+    return a == b || (a && b && *a == *b);
+}
+
+// Finds each run of two or more Pass::Op that Pass can batch together, and calls pass->batch() with
+// the run's indices. NoOps may sit between the ops of a run, and are left alone.
+template <typename Pass>
+static void batch_runs(Pass* pass, SkRecord* record) {
+    using Op = typename Pass::Op;
+
+    SkSTArray<kMaxBatchedDraws, int> run;
+    int i = 0;
+    while (i < record->count()) {
+        Op* first = get_as<Op>(record, i);
+        if (!first || !pass->canBatch(*first)) {
+            i++;
+            continue;
+        }
+
+        run.reset();
+        run.push_back(i++);
+        for (; i < record->count() && run.count() < kMaxBatchedDraws; i++) {
+            if (get_as<NoOp>(record, i)) {
+                continue;
+            }
+            Op* next = get_as<Op>(record, i);
+            if (!next || !pass->canBatch(*next) || !pass->canBatchWith(*first, *next)) {
+                break;
+            }
+            run.push_back(i);
+        }
+
+        if (run.count() > 1) {
+            pass->batch(record, run);
+        }
+    }
+}
+
+// Turns runs of DrawImageRect into a DrawEdgeAAImageSet, which devices can draw in one go.
+struct ImageRectBatcher {
+    using Op = DrawImageRect;
+
+    bool canBatch(const DrawImageRect& op) const {
+        // An image set shares one image filter (and its layer) between all its entries,
+        // and its bounds in the BBH don't account for mask filters.
+        if (op.paint && (op.paint->getImageFilter() || op.paint->getMaskFilter())) {
+            return false;
+        }
+        // Only DrawImageRect can cull its image before decoding it.
+        if (op.image->isLazyGenerated()) {
+            return false;
+        }
+        // SkCanvas::drawImageRect() skips these, but an image set would draw them.
+        const SkRect src = op.src ? *op.src : SkRect::Make(op.image->bounds());
+        return src.isFinite() && !src.isEmpty() && op.dst.isFinite() && !op.dst.isEmpty();
+    }
+
+    bool canBatchWith(const DrawImageRect& first, const DrawImageRect& next) const {
+        return same_paint(first.paint, next.paint) && first.constraint == next.constraint;
+    }
+
+    void batch(SkRecord* record, const SkTArray<int>& run) {
+        const DrawImageRect* first = get_as<DrawImageRect>(record, run[0]);
+        const bool aa = first->paint && first->paint->isAntiAlias();
+        const SkCanvas::SrcRectConstraint constraint = first->constraint;
+
+        SkPaint* paint = nullptr;
+        if (first->paint) {
+            paint = new (record->alloc<SkPaint>()) SkPaint(*first->paint);
+        }
+
+        SkAutoTArray<SkCanvas::ImageSetEntry> set(run.count());
+        for (int i = 0; i < run.count(); i++) {
+            const DrawImageRect* op = get_as<DrawImageRect>(record, run[i]);
+            set[i] = SkCanvas::ImageSetEntry(op->image,
+                                             op->src ? *op->src : SkRect::Make(op->image->bounds()),
+                                             op->dst,
+                                             1.0f,
+                                             aa ? SkCanvas::kAll_QuadAAFlags
+                                                : SkCanvas::kNone_QuadAAFlags);
+        }
+
+        for (int i = 1; i < run.count(); i++) {
+            record->replace<NoOp>(run[i]);
+        }
+        new (record->replace<DrawEdgeAAImageSet>(run[0]))
+                DrawEdgeAAImageSet{paint, std::move(set), run.count(), nullptr, nullptr,
+                                   constraint};
+    }
+};
+
+// Turns runs of DrawTextBlob into one DrawTextBlob of all their runs, offset to where they drew.
+struct TextBlobBatcher {
+    using Op = DrawTextBlob;
+
+    bool canBatch(const DrawTextBlob& op) const {
+        // Like images, an image filter would apply to the merged blob as a whole.
+        if (op.paint.getImageFilter()) {
+            return false;
+        }
+        // RSXform runs are drawn relative to the blob's origin in ways we don't try to preserve.
+        for (SkTextBlobRunIterator it(op.blob.get()); !it.done(); it.next()) {
+            if (it.positioning() == SkTextBlobRunIterator::kRSXform_Positioning) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool canBatchWith(const DrawTextBlob& first, const DrawTextBlob& next) const {
+        return first.paint == next.paint;
+    }
+
+    void batch(SkRecord* record, const SkTArray<int>& run) {
+        SkTextBlobBuilder builder;
+        for (int index : run) {
+            const DrawTextBlob* op = get_as<DrawTextBlob>(record, index);
+            AppendRuns(&builder, *op->blob, op->x, op->y);
+        }
+
+        SkPaint paint = get_as<DrawTextBlob>(record, run[0])->paint;
+        for (int i = 1; i < run.count(); i++) {
+            record->replace<NoOp>(run[i]);
+        }
+        new (record->replace<DrawTextBlob>(run[0]))
+                DrawTextBlob{std::move(paint), builder.make(), 0, 0};
+    }
+
+    static void AppendRuns(SkTextBlobBuilder* builder, const SkTextBlob& blob,
+                           SkScalar x, SkScalar y) {
+        // Each run gets the whole blob's bounds, so the merged blob's bounds are their union.
+        const SkRect bounds = blob.bounds().makeOffset(x, y);
+
+        for (SkTextBlobRunIterator it(&blob); !it.done(); it.next()) {
+            const int count    = it.glyphCount(),
+                      textSize = it.textSize();
+            const SkPoint& offset = it.offset();
+
+            const SkTextBlobBuilder::RunBuffer* buffer = nullptr;
+            switch (it.positioning()) {
+                case SkTextBlobRunIterator::kDefault_Positioning:
+                    buffer = &SkTextBlobBuilderPriv::AllocRunText(builder, it.font(), count,
+                                                                  offset.x() + x, offset.y() + y,
+                                                                  textSize, SkString(), &bounds);
+                    break;
+                case SkTextBlobRunIterator::kHorizontal_Positioning:
+                    buffer = &SkTextBlobBuilderPriv::AllocRunTextPosH(builder, it.font(), count,
+                                                                      offset.y() + y, textSize,
+                                                                      SkString(), &bounds);
+                    for (int i = 0; i < count; i++) {
+                        buffer->pos[i] = it.pos()[i] + x;
+                    }
+                    break;
+                case SkTextBlobRunIterator::kFull_Positioning:
+                    buffer = &SkTextBlobBuilderPriv::AllocRunTextPos(builder, it.font(), count,
+                                                                     textSize, SkString(),
+                                                                     &bounds);
+                    for (int i = 0; i < count; i++) {
+                        buffer->points()[i] = it.points()[i] + SkVector{x, y};
+                    }
+                    break;
+                case SkTextBlobRunIterator::kRSXform_Positioning:
+                    SkUNREACHABLE;
+            }
+
+            memcpy(buffer->glyphs, it.glyphs(), count * sizeof(SkGlyphID));
+            if (textSize > 0) {
+                memcpy(buffer->utf8text, it.text(), textSize);
+                memcpy(buffer->clusters, it.clusters(), count * sizeof(uint32_t));
+            }
+        }
+    }
+};
+
+void SkRecordBatchDraws(SkRecord* record) {
+    ImageRectBatcher images;
+    batch_runs(&images, record);
+
+    TextBlobBatcher text;
+    batch_runs(&text, record);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 void SkRecordOptimize(SkRecord* record) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
@@ -315,6 +512,7 @@ void SkRecordOptimize2(SkRecord* record) {
     SkRecordNoopSaveLayerDrawRestores(record);
 #endif
     SkRecordMergeSvgOpacityAndFilterLayers(record);
+    SkRecordBatchDraws(record);
 
     record->defrag();
 }
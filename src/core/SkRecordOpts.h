@@ -26,6 +26,11 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
+// Merges runs of consecutive DrawImageRects that share a paint into DrawEdgeAAImageSets, and runs
+// of consecutive DrawTextBlobs that share a paint into single DrawTextBlobs. SkPictureRecorder
+// only runs this for kBatchDraws_RecordFlag; SkRecordOptimize() leaves these draws alone.
+void SkRecordBatchDraws(SkRecord*);
+
 // Experimental optimizers
 void SkRecordOptimize2(SkRecord*);
 
@@ -10,6 +10,7 @@
 #include "include/core/SkGraphics.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkTypeface.h"
+#include "include/private/SkTArray.h"
 #include "src/core/SkEnumerate.h"
 #include "src/core/SkScalerContext.h"
 
@@ -96,14 +97,6 @@ std::tuple<SkSpan<const SkGlyph*>, size_t> SkScalerCache::internalPrepare(
     return {{results, glyphIDs.size()}, delta};
 }
 
-std::tuple<const void*, size_t> SkScalerCache::prepareImage(SkGlyph* glyph) {
-    size_t delta = 0;
-    if (glyph->setImage(&fAlloc, fScalerContext.get())) {
-        delta = glyph->imageSize();
-    }
-    return {glyph->image(), delta};
-}
-
 std::tuple<SkGlyph*, size_t> SkScalerCache::mergeGlyphAndImage(
         SkPackedGlyphID toID, const SkGlyph& from) {
     SkAutoMutexExclusive lock{fMu};
@@ -135,17 +128,54 @@ std::tuple<SkSpan<const SkGlyph*>, size_t> SkScalerCache::preparePaths(
 
 std::tuple<SkSpan<const SkGlyph*>, size_t> SkScalerCache::prepareImages(
         SkSpan<const SkPackedGlyphID> glyphIDs, const SkGlyph* results[]) {
-    const SkGlyph** cursor = results;
+    // SkGlyph* const* and const SkGlyph** point to the same pointers; only the glyphs' constness
+    // differs.
+    SkGlyph** glyphs = const_cast<SkGlyph**>(results);
     SkAutoMutexExclusive lock{fMu};
+    size_t delta = this->prepareGlyphs(glyphIDs, glyphs);
+    delta += this->prepareGlyphImages({glyphs, glyphIDs.size()});
+
+    return {{results, glyphIDs.size()}, delta};
+}
+
+size_t SkScalerCache::prepareGlyphs(SkSpan<const SkPackedGlyphID> packedIDs,
+                                    SkGlyph* results[]) {
     size_t delta = 0;
-    for (auto glyphID : glyphIDs) {
-        auto[glyph, glyphSize] = this->glyph(glyphID);
-        auto[_, imageSize] = this->prepareImage(glyph);
-        delta += glyphSize + imageSize;
-        *cursor++ = glyph;
+    // Glyphs are added to the map as they are made, so a repeated ID finds the first one.
+    SkSTArray<32, SkGlyph*> newGlyphs;
+    for (auto [i, packedID] : SkMakeEnumerate(packedIDs)) {
+        SkGlyph* glyph = fGlyphMap.findOrNull(packedID);
+        if (glyph == nullptr) {
+            size_t size;
+            std::tie(glyph, size) = this->makeGlyph(packedID);
+            delta += size;
+            newGlyphs.push_back(glyph);
+        }
+        results[i] = glyph;
     }
 
-    return {{results, glyphIDs.size()}, delta};
+    for (SkGlyph* glyph : newGlyphs) {
+        fScalerContext->getMetrics(glyph);
+    }
+    return delta;
+}
+
+size_t SkScalerCache::prepareGlyphImages(SkSpan<SkGlyph* const> glyphs) {
+    size_t delta = 0;
+    // Once its image is allocated, a glyph reports setImageHasBeenCalled(), so a repeated glyph
+    // is only generated once.
+    SkSTArray<32, SkGlyph*> needImages;
+    for (SkGlyph* glyph : glyphs) {
+        if (!glyph->setImageHasBeenCalled()) {
+            delta += glyph->allocImage(&fAlloc);
+            needImages.push_back(glyph);
+        }
+    }
+
+    for (SkGlyph* glyph : needImages) {
+        fScalerContext->getImage(*glyph);
+    }
+    return delta;
 }
 
 template <typename Fn>
@@ -165,18 +195,34 @@ size_t SkScalerCache::commonFilterLoop(SkDrawableGlyphBuffer* drawables, Fn&& fn
 
 size_t SkScalerCache::prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables) {
     SkAutoMutexExclusive lock{fMu};
-    size_t imageDelta = 0;
-    size_t delta = this->commonFilterLoop(drawables,
-        [&](size_t i, SkGlyph* glyph, SkPoint pos) SK_REQUIRES(fMu) {
-            // If the glyph is too large, then no image is created.
-            auto [image, imageSize] = this->prepareImage(glyph);
-            if (image != nullptr) {
-                drawables->push_back(glyph, i);
-                imageDelta += imageSize;
-            }
-        });
 
-    return delta + imageDelta;
+    // Gather the glyphs with finite positions first, so that the missing metrics, and then the
+    // missing images, are generated in one pass each.
+    auto input = drawables->input();
+    SkAutoSTMalloc<64, SkPackedGlyphID> packedIDs(input.size());
+    SkAutoSTMalloc<64, size_t> indices(input.size());
+    size_t count = 0;
+    for (auto [i, packedID, pos] : SkMakeEnumerate(input)) {
+        if (SkScalarsAreFinite(pos.x(), pos.y())) {
+            packedIDs[count] = packedID.packedID();
+            indices[count] = i;
+            count++;
+        }
+    }
+
+    SkAutoSTMalloc<64, SkGlyph*> glyphs(count);
+    size_t delta = this->prepareGlyphs({packedIDs.get(), count}, glyphs.get());
+    delta += this->prepareGlyphImages({glyphs.get(), count});
+
+    for (size_t j = 0; j < count; j++) {
+        SkGlyph* glyph = glyphs[j];
+        // If the glyph is too large, then no image is created.
+        if (!glyph->isEmpty() && glyph->image() != nullptr) {
+            drawables->push_back(glyph, indices[j]);
+        }
+    }
+
+    return delta;
 }
 
 // Note: this does not actually fill out the image. That happens at atlas building time.
@@ -44,6 +44,13 @@ public:
     /** Return the number of glyphs currently cached. */
     int countCachedGlyphs() const SK_EXCLUDES(fMu);
 
+    // Call fn with each glyph currently cached.
+    template <typename Fn>
+    void forEachGlyph(Fn&& fn) const SK_EXCLUDES(fMu) {
+        SkAutoMutexExclusive lock{fMu};
+        fGlyphMap.foreach([&fn](const SkGlyph* glyph) { fn(*glyph); });
+    }
+
     /** If the advance axis intersects the glyph's path, append the positions scaled and offset
         to the array (if non-null), and set the count to the updated array length.
     */
@@ -60,6 +67,9 @@ public:
     std::tuple<SkSpan<const SkGlyph*>, size_t> preparePaths(
             SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fMu);
 
+    // Return the glyphs for glyphIDs, in order, with their metrics and images. The glyphs that are
+    // missing either are generated together in one pass, once each no matter how often they
+    // appear in glyphIDs.
     std::tuple<SkSpan<const SkGlyph*>, size_t> prepareImages(
             SkSpan<const SkPackedGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fMu);
 
@@ -105,7 +115,13 @@ private:
     // advances using a scaler.
     std::tuple<SkGlyph*, size_t> glyph(SkPackedGlyphID) SK_REQUIRES(fMu);
 
-    std::tuple<const void*, size_t> prepareImage(SkGlyph* glyph) SK_REQUIRES(fMu);
+    // Find or make the glyphs for packedIDs, writing them to results. The ones not cached have
+    // their metrics generated together.
+    size_t prepareGlyphs(SkSpan<const SkPackedGlyphID> packedIDs,
+                         SkGlyph* results[]) SK_REQUIRES(fMu);
+
+    // Allocate images for the glyphs that need one, and then generate them together.
+    size_t prepareGlyphImages(SkSpan<SkGlyph* const> glyphs) SK_REQUIRES(fMu);
 
     // If the path has never been set, then use the scaler context to add the glyph.
     std::tuple<const SkPath*, size_t> preparePath(SkGlyph*) SK_REQUIRES(fMu);
@@ -19,6 +19,7 @@
 #include "src/core/SkScalerCache.h"
 
 bool gSkUseThreadLocalStrikeCaches_IAcknowledgeThisIsIncrediblyExperimental = false;
+int  gSkStrikeCacheShardCount = SK_DEFAULT_FONT_CACHE_SHARD_COUNT;
 
 SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 #if !defined(SK_BUILD_FOR_IOS)
@@ -27,20 +28,56 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
         return cache;
     }
 #endif
-    static auto* cache = new SkStrikeCache;
+    static auto* cache = new SkStrikeCache{gSkStrikeCacheShardCount};
     return cache;
 }
 
+SkStrikeCache::SkStrikeCache(int shardCount)
+        : fShardCount{std::max(shardCount, 1)}
+        , fShards{new Shard[fShardCount]} {}
+
+auto SkStrikeCache::shardFor(const SkDescriptor& desc) const -> Shard* {
+    // The shard's hash table indexes strikes by the low bits of the checksum, so pick the shard
+    // with the high bits.
+    return &fShards[(uint64_t)desc.getChecksum() * fShardCount >> 32];
+}
+
 auto SkStrikeCache::findOrCreateStrike(const SkDescriptor& desc,
                                        const SkScalerContextEffects& effects,
                                        const SkTypeface& typeface) -> sk_sp<Strike> {
-    SkAutoSpinlock ac(fLock);
-    sk_sp<Strike> strike = this->internalFindStrikeOrNull(desc);
+    Shard* shard = this->shardFor(desc);
+    sk_sp<SkGlyphStore> glyphStore = this->glyphStore();
+    sk_sp<Strike> strike;
+    {
+        SkAutoSpinlock ac(shard->fLock);
+        strike = this->internalFindStrikeOrNull(shard, desc);
+        if (strike == nullptr && glyphStore == nullptr) {
+            auto scaler = typeface.createScalerContext(effects, &desc);
+            strike = this->internalCreateStrike(shard, desc, std::move(scaler));
+        }
+        if (strike != nullptr) {
+            this->internalPurge(shard);
+        }
+    }
     if (strike == nullptr) {
+        // Restoring hashes the typeface and copies glyphs, so fill the strike before locking.
         auto scaler = typeface.createScalerContext(effects, &desc);
-        strike = this->internalCreateStrike(desc, std::move(scaler));
+        auto restored = sk_make_sp<Strike>(this, shard, desc, std::move(scaler), nullptr, nullptr);
+        restored->fMemoryUsed += glyphStore->restore(&restored->fScalerCache);
+        restored->fSaveToGlyphStore = true;
+
+        SkAutoSpinlock ac(shard->fLock);
+        // Another thread may have made the strike in the meantime.
+        strike = this->internalFindStrikeOrNull(shard, desc);
+        if (strike == nullptr) {
+            this->internalAttachToHead(shard, restored);
+            strike = std::move(restored);
+        }
+        this->internalPurge(shard);
+    }
+    if (fShardCount > 1) {
+        this->rebalance();
     }
-    this->internalPurge();
     return strike;
 }
 
@@ -120,34 +157,43 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
-    SkAutoSpinlock ac(fLock);
-    sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
-    this->internalPurge();
+    Shard* shard = this->shardFor(desc);
+    sk_sp<SkStrike> result;
+    {
+        SkAutoSpinlock ac(shard->fLock);
+        result = this->internalFindStrikeOrNull(shard, desc);
+        this->internalPurge(shard);
+    }
+    if (fShardCount > 1) {
+        this->rebalance();
+    }
     return result;
 }
 
-auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
+auto SkStrikeCache::internalFindStrikeOrNull(Shard* shard, const SkDescriptor& desc)
+        -> sk_sp<Strike> {
 
     // Check head because it is likely the strike we are looking for.
-    if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
+    Strike* head = shard->fHead;
+    if (head != nullptr && head->getDescriptor() == desc) { return sk_ref_sp(head); }
 
     // Do the heavy search looking for the strike.
-    sk_sp<Strike>* strikeHandle = fStrikeLookup.find(desc);
+    sk_sp<Strike>* strikeHandle = shard->fStrikeLookup.find(desc);
     if (strikeHandle == nullptr) { return nullptr; }
     Strike* strikePtr = strikeHandle->get();
     SkASSERT(strikePtr != nullptr);
-    if (fHead != strikePtr) {
+    if (head != strikePtr) {
         // Make most recently used
         strikePtr->fPrev->fNext = strikePtr->fNext;
         if (strikePtr->fNext != nullptr) {
             strikePtr->fNext->fPrev = strikePtr->fPrev;
         } else {
-            fTail = strikePtr->fPrev;
+            shard->fTail = strikePtr->fPrev;
         }
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
+        head->fPrev = strikePtr;
+        strikePtr->fNext = head;
         strikePtr->fPrev = nullptr;
-        fHead = strikePtr;
+        shard->fHead = strikePtr;
     }
     return sk_ref_sp(strikePtr);
 }
@@ -157,53 +203,71 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
-    SkAutoSpinlock ac(fLock);
-    return this->internalCreateStrike(desc, std::move(scaler), maybeMetrics, std::move(pinner));
+    Shard* shard = this->shardFor(desc);
+    SkAutoSpinlock ac(shard->fLock);
+    return this->internalCreateStrike(
+            shard, desc, std::move(scaler), maybeMetrics, std::move(pinner));
 }
 
 auto SkStrikeCache::internalCreateStrike(
+        Shard* shard,
         const SkDescriptor& desc,
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) -> sk_sp<Strike> {
-    auto strike =
-            sk_make_sp<Strike>(this, desc, std::move(scaler), maybeMetrics, std::move(pinner));
-    this->internalAttachToHead(strike);
+    auto strike = sk_make_sp<Strike>(
+            this, shard, desc, std::move(scaler), maybeMetrics, std::move(pinner));
+    this->internalAttachToHead(shard, strike);
     return strike;
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoSpinlock ac(fLock);
-    this->internalPurge(fTotalMemoryUsed);
+    sk_sp<SkGlyphStore> glyphStore = this->glyphStore();
+    std::vector<sk_sp<Strike>> purged;
+    for (int i = 0; i < fShardCount; i++) {
+        Shard* shard = &fShards[i];
+        SkAutoSpinlock ac(shard->fLock);
+        this->internalPurge(shard, shard->fMemoryUsed, glyphStore ? &purged : nullptr);
+    }
+    if (glyphStore != nullptr) {
+        // Saving copies every glyph image, so it waits until the shards are unlocked.
+        for (const sk_sp<Strike>& strike : purged) {
+            glyphStore->save(strike->fScalerCache);
+        }
+        glyphStore->write();
+    }
+}
+
+void SkStrikeCache::setGlyphStore(sk_sp<SkGlyphStore> glyphStore) {
+    SkAutoSpinlock ac(fGlyphStoreLock);
+    fGlyphStore = std::move(glyphStore);
+}
+
+sk_sp<SkGlyphStore> SkStrikeCache::glyphStore() const {
+    SkAutoSpinlock ac(fGlyphStoreLock);
+    return fGlyphStore;
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoSpinlock ac(fLock);
-    return fTotalMemoryUsed;
+    return fTotalMemoryUsed.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoSpinlock ac(fLock);
-    return fCacheCount;
+    return fCacheCount.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoSpinlock ac(fLock);
-    return fCacheCountLimit;
+    return fCacheCountLimit.load(std::memory_order_relaxed);
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
-    SkAutoSpinlock ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit, std::memory_order_relaxed);
+    this->rebalance();
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoSpinlock ac(fLock);
-    return fCacheSizeLimit;
+    return fCacheSizeLimit.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::setCacheCountLimit(int newCount) {
@@ -211,17 +275,13 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoSpinlock ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = fCacheCountLimit.exchange(newCount, std::memory_order_relaxed);
+    this->rebalance();
     return prevCount;
 }
 
 int SkStrikeCache::getCachePointSizeLimit() const {
-    SkAutoSpinlock ac(fLock);
-    return fPointSizeLimit;
+    return fPointSizeLimit.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::setCachePointSizeLimit(int newLimit) {
@@ -229,39 +289,68 @@ int SkStrikeCache::setCachePointSizeLimit(int newLimit) {
         newLimit = 0;
     }
 
-    SkAutoSpinlock ac(fLock);
-
-    int prevLimit = fPointSizeLimit;
-    fPointSizeLimit = newLimit;
-    return prevLimit;
+    return fPointSizeLimit.exchange(newLimit, std::memory_order_relaxed);
 }
 
 void SkStrikeCache::forEachStrike(std::function<void(const Strike&)> visitor) const {
-    SkAutoSpinlock ac(fLock);
+    for (int i = 0; i < fShardCount; i++) {
+        const Shard* shard = &fShards[i];
+        SkAutoSpinlock ac(shard->fLock);
 
-    this->validate();
+        this->validate(shard);
 
-    for (Strike* strike = fHead; strike != nullptr; strike = strike->fNext) {
-        visitor(*strike);
+        for (Strike* strike = shard->fHead; strike != nullptr; strike = strike->fNext) {
+            visitor(*strike);
+        }
     }
 }
 
-size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
+void SkStrikeCache::rebalance() {
+    // Shards only purge themselves when they are used, so one that grew while the cache was within
+    // budget keeps its surplus until we take it back here. Once every shard is down to its share
+    // the whole cache is within budget.
+    for (int i = 0; i < fShardCount; i++) {
+        if (fTotalMemoryUsed.load(std::memory_order_relaxed) <=
+                    fCacheSizeLimit.load(std::memory_order_relaxed) &&
+            fCacheCount.load(std::memory_order_relaxed) <=
+                    fCacheCountLimit.load(std::memory_order_relaxed)) {
+            return;
+        }
+        Shard* shard = &fShards[i];
+        SkAutoSpinlock ac(shard->fLock);
+        this->internalPurge(shard);
+    }
+}
+
+size_t SkStrikeCache::internalPurge(Shard* shard, size_t minBytesNeeded,
+                                    std::vector<sk_sp<Strike>>* toSave) {
+    const size_t totalMemoryUsed = fTotalMemoryUsed.load(std::memory_order_relaxed),
+                 cacheSizeLimit  = fCacheSizeLimit.load(std::memory_order_relaxed);
+    const int    cacheCount      = fCacheCount.load(std::memory_order_relaxed),
+                 cacheCountLimit = fCacheCountLimit.load(std::memory_order_relaxed);
+
+    // A shard may use more than its share of the budget as long as the others leave it room.
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > cacheSizeLimit) {
+        size_t share = cacheSizeLimit / fShardCount;
+        if (shard->fMemoryUsed > share) {
+            bytesNeeded = shard->fMemoryUsed - share;
+        }
     }
     bytesNeeded = std::max(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = std::max(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = std::max(bytesNeeded, shard->fMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
-        // no small purges!
-        countNeeded = std::max(countNeeded, fCacheCount >> 2);
+    if (cacheCount > cacheCountLimit) {
+        int share = cacheCountLimit / fShardCount;
+        if (shard->fCacheCount > share) {
+            countNeeded = shard->fCacheCount - share;
+            // no small purges!
+            countNeeded = std::max(countNeeded, shard->fCacheCount >> 2);
+        }
     }
 
     // early exit
@@ -274,7 +363,7 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
 
     // Start at the tail and proceed backwards deleting; the list is in LRU
     // order, with unimportant entries at the tail.
-    Strike* strike = fTail;
+    Strike* strike = shard->fTail;
     while (strike != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
         Strike* prev = strike->fPrev;
 
@@ -282,12 +371,15 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
         if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
             bytesFreed += strike->fMemoryUsed;
             countFreed += 1;
-            this->internalRemoveStrike(strike);
+            if (toSave != nullptr && strike->fSaveToGlyphStore) {
+                toSave->push_back(sk_ref_sp(strike));
+            }
+            this->internalRemoveStrike(shard, strike);
         }
         strike = prev;
     }
 
-    this->validate();
+    this->validate(shard);
 
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
@@ -299,78 +391,84 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     return bytesFreed;
 }
 
-void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
-    SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
+void SkStrikeCache::internalAttachToHead(Shard* shard, sk_sp<Strike> strike) {
+    SkASSERT(shard->fStrikeLookup.find(strike->getDescriptor()) == nullptr);
     Strike* strikePtr = strike.get();
-    fStrikeLookup.set(std::move(strike));
+    shard->fStrikeLookup.set(std::move(strike));
     SkASSERT(nullptr == strikePtr->fPrev && nullptr == strikePtr->fNext);
 
-    fCacheCount += 1;
-    fTotalMemoryUsed += strikePtr->fMemoryUsed;
+    shard->fCacheCount += 1;
+    shard->fMemoryUsed += strikePtr->fMemoryUsed;
+    fCacheCount.fetch_add(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_add(strikePtr->fMemoryUsed, std::memory_order_relaxed);
 
-    if (fHead != nullptr) {
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
+    if (shard->fHead != nullptr) {
+        shard->fHead->fPrev = strikePtr;
+        strikePtr->fNext = shard->fHead;
     }
 
-    if (fTail == nullptr) {
-        fTail = strikePtr;
+    if (shard->fTail == nullptr) {
+        shard->fTail = strikePtr;
     }
 
-    fHead = strikePtr; // Transfer ownership of strike to the cache list.
+    shard->fHead = strikePtr; // Transfer ownership of strike to the cache list.
 }
 
-void SkStrikeCache::internalRemoveStrike(Strike* strike) {
-    SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
-    fTotalMemoryUsed -= strike->fMemoryUsed;
+void SkStrikeCache::internalRemoveStrike(Shard* shard, Strike* strike) {
+    SkASSERT(shard->fCacheCount > 0);
+    shard->fCacheCount -= 1;
+    shard->fMemoryUsed -= strike->fMemoryUsed;
+    fCacheCount.fetch_sub(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_sub(strike->fMemoryUsed, std::memory_order_relaxed);
 
     if (strike->fPrev) {
         strike->fPrev->fNext = strike->fNext;
     } else {
-        fHead = strike->fNext;
+        shard->fHead = strike->fNext;
     }
     if (strike->fNext) {
         strike->fNext->fPrev = strike->fPrev;
     } else {
-        fTail = strike->fPrev;
+        shard->fTail = strike->fPrev;
     }
 
     strike->fPrev = strike->fNext = nullptr;
     strike->fRemoved = true;
-    fStrikeLookup.remove(strike->getDescriptor());
+    shard->fStrikeLookup.remove(strike->getDescriptor());
 }
 
-void SkStrikeCache::validate() const {
+void SkStrikeCache::validate(const Shard* shard) const {
 #ifdef SK_DEBUG
     size_t computedBytes = 0;
     int computedCount = 0;
 
-    const Strike* strike = fHead;
+    const Strike* strike = shard->fHead;
     while (strike != nullptr) {
         computedBytes += strike->fMemoryUsed;
         computedCount += 1;
-        SkASSERT(fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
+        SkASSERT(strike->fShard == shard);
+        SkASSERT(shard->fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
         strike = strike->fNext;
     }
 
-    if (fCacheCount != computedCount) {
-        SkDebugf("fCacheCount: %d, computedCount: %d", fCacheCount, computedCount);
+    if (shard->fCacheCount != computedCount) {
+        SkDebugf("fCacheCount: %d, computedCount: %d", shard->fCacheCount, computedCount);
         SK_ABORT("fCacheCount != computedCount");
     }
-    if (fTotalMemoryUsed != computedBytes) {
-        SkDebugf("fTotalMemoryUsed: %d, computedBytes: %d", fTotalMemoryUsed, computedBytes);
-        SK_ABORT("fTotalMemoryUsed == computedBytes");
+    if (shard->fMemoryUsed != computedBytes) {
+        SkDebugf("fMemoryUsed: %zu, computedBytes: %zu", shard->fMemoryUsed, computedBytes);
+        SK_ABORT("fMemoryUsed == computedBytes");
     }
 #endif
 }
 
 void SkStrikeCache::Strike::updateDelta(size_t increase) {
     if (increase != 0) {
-        SkAutoSpinlock lock{fStrikeCache->fLock};
+        SkAutoSpinlock lock{fShard->fLock};
         fMemoryUsed += increase;
         if (!fRemoved) {
-            fStrikeCache->fTotalMemoryUsed += increase;
+            fShard->fMemoryUsed += increase;
+            fStrikeCache->fTotalMemoryUsed.fetch_add(increase, std::memory_order_relaxed);
         }
     }
 }
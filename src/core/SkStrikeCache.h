@@ -8,12 +8,15 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "include/private/SkSpinlock.h"
 #include "include/private/SkTemplates.h"
 #include "src/core/SkDescriptor.h"
+#include "src/core/SkGlyphStore.h"
 #include "src/core/SkScalerCache.h"
 
 class SkTraceMemoryDump;
@@ -30,6 +33,14 @@ class SkTraceMemoryDump;
     #define SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT  256
 #endif
 
+#ifndef SK_DEFAULT_FONT_CACHE_SHARD_COUNT
+    #define SK_DEFAULT_FONT_CACHE_SHARD_COUNT   1
+#endif
+
+// The number of shards GlobalStrikeCache() creates. Only has an effect if set before the global
+// cache is first used.
+extern int gSkStrikeCacheShardCount;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SkStrikePinner {
@@ -38,18 +49,27 @@ public:
     virtual bool canDelete() = 0;
 };
 
+// The strikes are partitioned by descriptor checksum into shards, each with its own lock, LRU list
+// and share of the budget, so that threads drawing text with different strikes rarely contend.
+// A shard may use more than its share while the cache as a whole is within budget; once it is
+// over, the shards over their shares are purged back down to them. With one shard, this is a
+// plain LRU cache behind a single lock.
 class SkStrikeCache final : public SkStrikeForGPUCacheInterface {
+    class Shard;
+
 public:
-    SkStrikeCache() = default;
+    explicit SkStrikeCache(int shardCount = 1);
 
     class Strike final : public SkRefCnt, public SkStrikeForGPU {
     public:
         Strike(SkStrikeCache* strikeCache,
+               Shard* shard,
                const SkDescriptor& desc,
                std::unique_ptr<SkScalerContext> scaler,
                const SkFontMetrics* metrics,
                std::unique_ptr<SkStrikePinner> pinner)
                 : fStrikeCache{strikeCache}
+                , fShard{shard}
                 , fScalerCache{desc, std::move(scaler), metrics}
                 , fPinner{std::move(pinner)} {}
 
@@ -137,33 +157,37 @@ public:
         void updateDelta(size_t increase);
 
         SkStrikeCache* const            fStrikeCache;
+        Shard* const                    fShard;
         Strike*                         fNext{nullptr};
         Strike*                         fPrev{nullptr};
         SkScalerCache                   fScalerCache;
         std::unique_ptr<SkStrikePinner> fPinner;
         size_t                          fMemoryUsed{sizeof(SkScalerCache)};
         bool                            fRemoved{false};
+        bool                            fSaveToGlyphStore{false};
     };  // Strike
 
+    // The global cache has SK_DEFAULT_FONT_CACHE_SHARD_COUNT shards, unless
+    // gSkStrikeCacheShardCount is set before it is first used.
     static SkStrikeCache* GlobalStrikeCache();
 
-    sk_sp<Strike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
+    sk_sp<Strike> findStrike(const SkDescriptor& desc);
 
     sk_sp<Strike> createStrike(
             const SkDescriptor& desc,
             std::unique_ptr<SkScalerContext> scaler,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_EXCLUDES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
     sk_sp<Strike> findOrCreateStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) SK_EXCLUDES(fLock);
+            const SkTypeface& typeface);
 
     SkScopedStrikeForGPU findOrCreateScopedStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) override SK_EXCLUDES(fLock);
+            const SkTypeface& typeface) override;
 
     static void PurgeAll();
     static void Dump();
@@ -172,59 +196,88 @@ public:
     // SkTraceMemoryDump interface.
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
-    void purgeAll() SK_EXCLUDES(fLock); // does not change budget
+    void purgeAll(); // does not change budget
 
-    int getCacheCountLimit() const SK_EXCLUDES(fLock);
-    int setCacheCountLimit(int limit) SK_EXCLUDES(fLock);
-    int getCacheCountUsed() const SK_EXCLUDES(fLock);
+    int getCacheCountLimit() const;
+    int setCacheCountLimit(int limit);
+    int getCacheCountUsed() const;
 
-    size_t getCacheSizeLimit() const SK_EXCLUDES(fLock);
-    size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
-    size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
+    size_t getCacheSizeLimit() const;
+    size_t setCacheSizeLimit(size_t limit);
+    size_t getTotalMemoryUsed() const;
 
-    int  getCachePointSizeLimit() const SK_EXCLUDES(fLock);
-    int  setCachePointSizeLimit(int limit) SK_EXCLUDES(fLock);
+    int  getCachePointSizeLimit() const;
+    int  setCachePointSizeLimit(int limit);
+
+    int shardCount() const { return fShardCount; }
+
+    // Strikes made by findOrCreateStrike() start with the glyphs glyphStore has for them.
+    // purgeAll() saves the glyphs of those strikes to the store, and writes it to its file.
+    void setGlyphStore(sk_sp<SkGlyphStore> glyphStore);
+    sk_sp<SkGlyphStore> glyphStore() const;
 
 private:
-    sk_sp<Strike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
+    class Shard {
+    public:
+        mutable SkSpinlock fLock;
+        Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
+        Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
+        struct StrikeTraits {
+            static const SkDescriptor& GetKey(const sk_sp<Strike>& strike) {
+                return strike->getDescriptor();
+            }
+            static uint32_t Hash(const SkDescriptor& descriptor) {
+                return descriptor.getChecksum();
+            }
+        };
+        SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
+        size_t  fMemoryUsed SK_GUARDED_BY(fLock) {0};
+        int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
+    };
+
+    Shard* shardFor(const SkDescriptor& desc) const;
+
+    sk_sp<Strike> internalFindStrikeOrNull(Shard* shard, const SkDescriptor& desc)
+            SK_REQUIRES(shard->fLock);
     sk_sp<Strike> internalCreateStrike(
+            Shard* shard,
             const SkDescriptor& desc,
             std::unique_ptr<SkScalerContext> scaler,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(shard->fLock);
 
     // The following methods can only be called when mutex is already held.
-    void internalRemoveStrike(Strike* strike) SK_REQUIRES(fLock);
-    void internalAttachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+    void internalRemoveStrike(Shard* shard, Strike* strike) SK_REQUIRES(shard->fLock);
+    void internalAttachToHead(Shard* shard, sk_sp<Strike> strike) SK_REQUIRES(shard->fLock);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
-    // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0) SK_REQUIRES(fLock);
+    // and attempt to purge the shard to match its share of them.
+    // Returns number of bytes freed. Purged strikes with glyphs for the glyph store are added to
+    // toSave, if it is given.
+    size_t internalPurge(Shard* shard, size_t minBytesNeeded = 0,
+                         std::vector<sk_sp<Strike>>* toSave = nullptr) SK_REQUIRES(shard->fLock);
 
-    // A simple accounting of what each glyph cache reports and the strike cache total.
-    void validate() const SK_REQUIRES(fLock);
+    // If the whole cache is over budget, purge every shard that is over its share.
+    void rebalance();
 
-    void forEachStrike(std::function<void(const Strike&)> visitor) const SK_EXCLUDES(fLock);
+    // A simple accounting of what each glyph cache reports and the shard total.
+    void validate(const Shard* shard) const SK_REQUIRES(shard->fLock);
 
-    mutable SkSpinlock fLock;
-    Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
-    Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
-    struct StrikeTraits {
-        static const SkDescriptor& GetKey(const sk_sp<Strike>& strike) {
-            return strike->getDescriptor();
-        }
-        static uint32_t Hash(const SkDescriptor& descriptor) {
-            return descriptor.getChecksum();
-        }
-    };
-    SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
+    void forEachStrike(std::function<void(const Strike&)> visitor) const;
+
+    const int                fShardCount;
+    std::unique_ptr<Shard[]> fShards;
+
+    // Totals across the shards, kept up to date by each shard under its own lock.
+    std::atomic<size_t>  fTotalMemoryUsed{0};
+    std::atomic<int32_t> fCacheCount{0};
+
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
+    std::atomic<int32_t> fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
 
-    size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
-    int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
-    int32_t fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
+    mutable SkSpinlock  fGlyphStoreLock;
+    sk_sp<SkGlyphStore> fGlyphStore SK_GUARDED_BY(fGlyphStoreLock);
 };
 
 using SkStrike = SkStrikeCache::Strike;
@@ -0,0 +1,345 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkThreadedBMPDevice.h"
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRSXform.h"
+#include "include/core/SkVertices.h"
+#include "src/core/SkDraw.h"
+#include "src/core/SkDrawTiler.h"
+#include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/core/SkTLazy.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Flush once this many draws are queued, bounding the memory held by captured paints and paths.
+static constexpr int kMaxQueuedDraws = 1 << 14;
+
+// A matrix provider for replaying a draw on another thread. The marker stack is not captured,
+// so runtime effects that look up marked matrices see none, as in a picture playback.
+class DeferredMatrixProvider : public SkMatrixProvider {
+public:
+    DeferredMatrixProvider(const SkM44& localToDevice) : SkMatrixProvider(localToDevice) {}
+
+    bool getLocalToMarker(uint32_t, SkM44*) const override { return false; }
+};
+
+SkThreadedBMPDevice::SkThreadedBMPDevice(const SkBitmap& bitmap,
+                                         const SkSurfaceProps& surfaceProps,
+                                         SkExecutor* executor,
+                                         int bandHeight)
+        : INHERITED(bitmap, surfaceProps, nullptr, nullptr)
+        , fExecutor(executor ? executor : &SkExecutor::GetDefault())
+        , fBandHeight(bandHeight > 0 ? bandHeight : kDefaultBandHeight)
+        , fBandCount((bitmap.height() + fBandHeight - 1) / fBandHeight) {
+    fBandDraws.reset(fBandCount);
+}
+
+SkThreadedBMPDevice::~SkThreadedBMPDevice() {
+    this->flush();
+}
+
+SkIRect SkThreadedBMPDevice::devBounds(const SkRect* localBounds) const {
+    SkIRect bounds = fRCStack.rc().getBounds();
+    if (localBounds && !this->localToDevice().hasPerspective()) {
+        // Outset before rounding so antialiasing and hairlines can't escape, and so we never
+        // have to outset a saturated int.
+        SkIRect drawBounds = this->localToDevice().mapRect(*localBounds)
+                                                 .makeOutset(1, 1)
+                                                 .roundOut();
+        if (!bounds.intersect(drawBounds)) {
+            return SkIRect::MakeEmpty();
+        }
+    }
+    return bounds;
+}
+
+void SkThreadedBMPDevice::enqueue(const SkIRect& devBounds, Tiling tiling,
+                                  const SkRect* tilerBounds, DrawFn drawFn) {
+    if (devBounds.isEmpty() || fRCStack.rc().isEmpty()) {
+        return;
+    }
+    SkASSERT(SkIRect::MakeWH(this->width(), this->height()).contains(devBounds));
+
+    const int index = fQueue.count();
+    fQueue.push_back({std::move(drawFn), this->localToDevice44(), fRCStack.rc(), tiling,
+                      tilerBounds != nullptr, tilerBounds ? *tilerBounds : SkRect::MakeEmpty()});
+
+    const int top    =  devBounds.fTop         / fBandHeight,
+              bottom = (devBounds.fBottom - 1) / fBandHeight;
+    for (int band = top; band <= bottom; band++) {
+        if (fBandDraws[band].isEmpty()) {
+            fDirtyBands.push_back(band);
+        }
+        fBandDraws[band].push_back(index);
+    }
+
+    if (fQueue.count() >= kMaxQueuedDraws) {
+        this->flush();
+    }
+}
+
+void SkThreadedBMPDevice::replayBand(int band) const {
+    SkPixmap root;
+    if (!fBitmap.peekPixels(&root)) {
+        return;
+    }
+
+    const SkIRect bandBounds = SkIRect::MakeLTRB(0, band * fBandHeight, this->width(),
+                                                 std::min((band + 1) * fBandHeight,
+                                                          this->height()));
+    for (int index : fBandDraws[band]) {
+        const DrawElement& element = fQueue[index];
+        DeferredMatrixProvider matrixProvider(element.fLocalToDevice);
+
+        if (element.fTiling == Tiling::kTiler) {
+            SkDrawTiler tiler(root, matrixProvider, element.fRC,
+                              element.fHasTilerBounds ? &element.fTilerBounds : nullptr,
+                              &bandBounds);
+            while (const SkDraw* draw = tiler.next()) {
+                element.fDrawFn(*draw);
+            }
+        } else {
+            SkDraw draw;
+            draw.fDst = root;
+            draw.fMatrixProvider = &matrixProvider;
+            draw.fRC = &element.fRC;
+            draw.fBlitBounds = &bandBounds;
+            element.fDrawFn(draw);
+        }
+    }
+}
+
+void SkThreadedBMPDevice::flush() {
+    if (fQueue.empty()) {
+        return;
+    }
+
+    SkTaskGroup tasks(*fExecutor);
+    tasks.batch(fDirtyBands.count(), [this](int i) { this->replayBand(fDirtyBands[i]); });
+    tasks.wait();
+
+    for (int band : fDirtyBands) {
+        fBandDraws[band].rewind();
+    }
+    fDirtyBands.rewind();
+    fQueue.reset();
+    fAlloc.reset();
+    fBitmap.notifyPixelsChanged();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkThreadedBMPDevice::drawPaint(const SkPaint& paint) {
+    this->enqueue(this->devBounds(nullptr), Tiling::kRootPixmap, nullptr,
+                  [paint](const SkDraw& draw) {
+        draw.drawPaint(paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawPoints(SkCanvas::PointMode mode, size_t count,
+                                     const SkPoint pts[], const SkPaint& paint) {
+    SkPoint* ptsCopy = fAlloc.makeArrayDefault<SkPoint>(count);
+    memcpy(ptsCopy, pts, count * sizeof(SkPoint));
+    this->enqueue(this->devBounds(nullptr), Tiling::kTiler, nullptr,
+                  [mode, count, ptsCopy, paint](const SkDraw& draw) {
+        draw.drawPoints(mode, count, ptsCopy, paint, nullptr);
+    });
+}
+
+void SkThreadedBMPDevice::drawRect(const SkRect& r, const SkPaint& paint) {
+    Bounder bounds(r, paint);
+    this->enqueue(this->devBounds(bounds), Tiling::kTiler, bounds,
+                  [r, paint](const SkDraw& draw) {
+        draw.drawRect(r, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
+#ifdef SK_IGNORE_BLURRED_RRECT_OPT
+    // SkBitmapDevice forwards to our drawPath().
+    this->INHERITED::drawRRect(rrect, paint);
+#else
+    Bounder bounds(rrect.getBounds(), paint);
+    this->enqueue(this->devBounds(bounds), Tiling::kTiler, bounds,
+                  [rrect, paint](const SkDraw& draw) {
+        draw.drawRRect(rrect, paint);
+    });
+#endif
+}
+
+void SkThreadedBMPDevice::drawPath(const SkPath& path, const SkPaint& paint, bool) {
+    // We always copy the path, so pathIsMutable doesn't buy us anything.
+    // The copies share one SkPathRef, so compute its lazy bounds before the bands race to.
+    path.updateBoundsCache();
+    SkTLazy<Bounder> bounds;
+    if (!path.isInverseFillType()) {
+        bounds.init(path.getBounds(), paint);
+    }
+    const SkRect* localBounds = bounds.isValid() ? bounds->bounds() : nullptr;
+
+    if (path.countPoints() >= SkDraw::kMinBandedPathPoints) {
+        // Replayed once per band, a huge path would have every band walk all of its edges.
+        // Instead we draw it now, letting SkDraw split its edges into bands on our executor.
+        this->flush();
+        SkDrawTiler tiler(this, localBounds);
+        while (const SkDraw* tile = tiler.next()) {
+            SkDraw draw(*tile);
+            draw.fExecutor = fExecutor;
+            draw.drawPath(path, paint, nullptr, false);
+        }
+        return;
+    }
+
+    // Each band replays the draw, but it's only one sighting of the path, so the bands share one
+    // decision about caching its mask.
+    const auto cacheMasks = SkDraw::SeenPathRecently(path) ? SkDraw::CachePathMasks::kYes
+                                                           : SkDraw::CachePathMasks::kNo;
+    this->enqueue(this->devBounds(localBounds), Tiling::kTiler, localBounds,
+                  [path, paint, cacheMasks](const SkDraw& draw) {
+        SkDraw bandDraw(draw);
+        bandDraw.fCachePathMasks = cacheMasks;
+        bandDraw.drawPath(path, paint, nullptr, false);
+    });
+}
+
+void SkThreadedBMPDevice::drawBitmap(const SkBitmap& bitmap, const SkMatrix& matrix,
+                                     const SkRect* dstOrNull, const SkPaint& paint) {
+    if (!bitmap.isImmutable()) {
+        // The caller is free to change these pixels as soon as we return.
+        this->flush();
+        this->INHERITED::drawBitmap(bitmap, matrix, dstOrNull, paint);
+        return;
+    }
+
+    // dstOrNull only bounds the draw; the pixels we touch come from mapping the bitmap.
+    SkRect mapped;
+    matrix.mapRect(&mapped, SkRect::MakeIWH(bitmap.width(), bitmap.height()));
+    Bounder bounds(mapped, paint);
+    // SkBitmapDevice tiles by dstOrNull when it has one, so we must too.
+    const SkRect* tilerBounds = dstOrNull ? dstOrNull : bounds.bounds();
+
+    const bool hasDst = dstOrNull != nullptr;
+    const SkRect dst = hasDst ? *dstOrNull : SkRect::MakeEmpty();
+    this->enqueue(this->devBounds(matrix.hasPerspective() ? nullptr : bounds.bounds()),
+                  Tiling::kTiler, tilerBounds,
+                  [bitmap, matrix, hasDst, dst, paint](const SkDraw& draw) {
+        draw.drawBitmap(bitmap, matrix, hasDst ? &dst : nullptr, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawGlyphRunList(const SkGlyphRunList& glyphRunList) {
+    // Glyph runs point into transient buffers and the glyph painter is not thread safe.
+    this->flush();
+    this->INHERITED::drawGlyphRunList(glyphRunList);
+}
+
+void SkThreadedBMPDevice::drawVertices(const SkVertices* vertices, SkBlendMode bmode,
+                                       const SkPaint& paint) {
+    this->enqueue(this->devBounds(Bounder(vertices->bounds(), paint)),
+                  Tiling::kRootPixmap, nullptr,
+                  [vertices = sk_ref_sp(vertices), bmode, paint](const SkDraw& draw) {
+        draw.drawVertices(vertices.get(), bmode, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawAtlas(const SkImage* atlas, const SkRSXform xform[],
+                                    const SkRect tex[], const SkColor colors[], int count,
+                                    SkBlendMode mode, const SkPaint& paint) {
+    auto copy = [this, count](const auto* src) {
+        using T = std::remove_const_t<std::remove_pointer_t<decltype(src)>>;
+        T* dst = nullptr;
+        if (src) {
+            dst = fAlloc.makeArrayDefault<T>(count);
+            memcpy(dst, src, count * sizeof(T));
+        }
+        return dst;
+    };
+    this->enqueue(this->devBounds(nullptr), Tiling::kRootPixmap, nullptr,
+                  [atlas = sk_ref_sp(atlas), xform = copy(xform), tex = copy(tex),
+                   colors = copy(colors), count, mode, paint](const SkDraw& draw) {
+        draw.drawAtlas(atlas.get(), xform, tex, colors, count, mode, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawDevice(SkBaseDevice* device, int x, int y, const SkPaint& paint) {
+    SkBitmapDevice* src = static_cast<SkBitmapDevice*>(device);
+    src->flush();
+    if (src->fCoverage) {
+        this->flush();
+        this->INHERITED::drawDevice(device, x, y, paint);
+        return;
+    }
+
+    SkIRect bounds = SkIRect::MakeXYWH(x, y, src->width(), src->height());
+    if (!bounds.intersect(fRCStack.rc().getBounds())) {
+        return;
+    }
+    this->enqueue(bounds, Tiling::kRootPixmap, nullptr,
+                  [bitmap = src->fBitmap, x, y, paint](const SkDraw& draw) {
+        draw.drawSprite(bitmap, x, y, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPaint& paint) {
+    // Image filters may read back from us, and are better parallelized by themselves.
+    this->flush();
+    this->INHERITED::drawSpecial(src, x, y, paint);
+}
+
+sk_sp<SkSpecialImage> SkThreadedBMPDevice::snapSpecial(const SkIRect& bounds, bool forceCopy) {
+    this->flush();
+    return this->INHERITED::snapSpecial(bounds, forceCopy);
+}
+
+void SkThreadedBMPDevice::setImmutable() {
+    this->flush();
+    this->INHERITED::setImmutable();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkThreadedBMPDevice::onReadPixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return this->INHERITED::onReadPixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onWritePixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return this->INHERITED::onWritePixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onPeekPixels(SkPixmap* pmap) {
+    this->flush();
+    return this->INHERITED::onPeekPixels(pmap);
+}
+
+bool SkThreadedBMPDevice::onAccessPixels(SkPixmap* pmap) {
+    this->flush();
+    return this->INHERITED::onAccessPixels(pmap);
+}
+
+void SkThreadedBMPDevice::replaceBitmapBackendForRasterSurface(const SkBitmap& bm) {
+    this->flush();
+    this->INHERITED::replaceBitmapBackendForRasterSurface(bm);
+}
+
+SkBaseDevice* SkThreadedBMPDevice::onCreateDevice(const CreateInfo& cinfo,
+                                                  const SkPaint* layerPaint) {
+    sk_sp<SkBaseDevice> device(this->INHERITED::onCreateDevice(cinfo, layerPaint));
+    if (!device || cinfo.fTrackCoverage || cinfo.fAllocator) {
+        return device.release();
+    }
+    // Reuse the layer SkBitmapDevice just allocated, but defer into it like we do.
+    const SkBitmapDevice* layer = static_cast<const SkBitmapDevice*>(device.get());
+    return new SkThreadedBMPDevice(layer->fBitmap, layer->surfaceProps(), fExecutor, fBandHeight);
+}
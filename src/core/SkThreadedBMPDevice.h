@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkThreadedBMPDevice_DEFINED
+#define SkThreadedBMPDevice_DEFINED
+
+#include "include/core/SkM44.h"
+#include "include/private/SkTArray.h"
+#include "include/private/SkTDArray.h"
+#include "src/core/SkArenaAlloc.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkRasterClip.h"
+
+#include <functional>
+
+class SkDraw;
+class SkExecutor;
+
+/**
+ *  An SkBitmapDevice that defers its draws and replays them band by band on an SkExecutor.
+ *
+ *  Each draw captures the current matrix and raster clip, and is binned into every horizontal
+ *  band of rows its device bounds touch. flush() then runs one task per non-empty band; a task
+ *  replays that band's draws in order, with SkDraw::fBlitBounds limiting their writes to the
+ *  band, so tasks write disjoint pixels and need no synchronization.
+ *
+ *  Geometry is rasterized against the captured clip, not the band, so the result matches
+ *  SkBitmapDevice, except that an antialiased hairline can round differently in the pixel pair
+ *  where it crosses from one band into the next. The price is that a draw spanning several bands
+ *  is scan converted once per band: shading and blending parallelize, edge walking does not.
+ *  Paths with enough points for that to matter (SkDraw::kMinBandedPathPoints) are the exception:
+ *  we flush and draw them right away, with SkDraw clipping their edges to bands that it scan
+ *  converts concurrently.
+ *
+ *  Anything that reads our pixels (readPixels, peekPixels, snapSpecial, ...) flushes first.
+ *  Draws that can't be safely captured (text, image filters, mutable bitmaps) flush and then
+ *  draw serially, though image filters may split their own work across our executor.
+ */
+class SkThreadedBMPDevice : public SkBitmapDevice {
+public:
+    // A null executor uses SkExecutor::GetDefault(). bandHeight <= 0 picks kDefaultBandHeight.
+    SkThreadedBMPDevice(const SkBitmap& bitmap, const SkSurfaceProps& surfaceProps,
+                        SkExecutor* executor, int bandHeight = 0);
+    ~SkThreadedBMPDevice() override;
+
+    // Replay all queued draws. Blocks until every band is done.
+    void flush() override;
+
+    SkExecutor* imageFilterExecutor() const override { return fExecutor; }
+
+    static constexpr int kDefaultBandHeight = 128;
+
+protected:
+    void drawPaint(const SkPaint& paint) override;
+    void drawPoints(SkCanvas::PointMode mode, size_t count,
+                    const SkPoint[], const SkPaint& paint) override;
+    void drawRect(const SkRect& r, const SkPaint& paint) override;
+    void drawRRect(const SkRRect& rr, const SkPaint& paint) override;
+    void drawPath(const SkPath&, const SkPaint&, bool pathIsMutable) override;
+    void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
+                    const SkPaint&) override;
+
+    void drawGlyphRunList(const SkGlyphRunList& glyphRunList) override;
+    void drawVertices(const SkVertices*, SkBlendMode, const SkPaint&) override;
+    void drawAtlas(const SkImage*, const SkRSXform[], const SkRect[], const SkColor[], int count,
+                   SkBlendMode, const SkPaint&) override;
+    void drawDevice(SkBaseDevice*, int x, int y, const SkPaint&) override;
+    void drawSpecial(SkSpecialImage*, int x, int y, const SkPaint&) override;
+
+    sk_sp<SkSpecialImage> snapSpecial(const SkIRect&, bool = false) override;
+    void setImmutable() override;
+
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int, int) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
+private:
+    using DrawFn = std::function<void(const SkDraw&)>;
+
+    // Draws that SkBitmapDevice issues through SkDrawTiler are replayed through one too, so
+    // devices too big for SkFixed are tiled the same way; draws it issues through BDDraw always
+    // see the root pixmap.
+    enum class Tiling : bool { kTiler, kRootPixmap };
+
+    struct DrawElement {
+        DrawFn       fDrawFn;
+        SkM44        fLocalToDevice;
+        SkRasterClip fRC;
+        Tiling       fTiling;
+        bool         fHasTilerBounds;
+        SkRect       fTilerBounds;    // the bounds SkBitmapDevice would give its SkDrawTiler
+    };
+
+    // Returns the device-space bounds of a draw, clipped to the current clip. localBounds, if
+    // known, should already account for the paint (i.e. come from Bounder).
+    SkIRect devBounds(const SkRect* localBounds) const;
+
+    // Queue drawFn against the current matrix and clip, touching the bands under devBounds.
+    void enqueue(const SkIRect& devBounds, Tiling, const SkRect* tilerBounds, DrawFn drawFn);
+    void replayBand(int band) const;
+
+    void replaceBitmapBackendForRasterSurface(const SkBitmap&) override;
+    SkBaseDevice* onCreateDevice(const CreateInfo&, const SkPaint*) override;
+
+    SkExecutor*                fExecutor;
+    const int                  fBandHeight;
+    const int                  fBandCount;
+
+    SkTArray<DrawElement>      fQueue;
+    SkTArray<SkTDArray<int>>   fBandDraws;    // indices into fQueue, one list per band
+    SkTDArray<int>             fDirtyBands;   // bands with a non-empty fBandDraws entry
+    SkArenaAlloc               fAlloc{4096};  // copies of point/atlas arrays, reset by flush()
+
+    typedef SkBitmapDevice INHERITED;
+};
+
+#endif // SkThreadedBMPDevice_DEFINED
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTripleBoxBlur_DEFINED
+#define SkTripleBoxBlur_DEFINED
+
+#include "include/core/SkTypes.h"
+#include "include/private/SkNx.h"
+
+#include <cmath>
+
+// SkTripleBoxBlur implements the common three pass box filter approximation of Gaussian blur
+// specified by https://drafts.fxtf.org/filter-effects/#feGaussianBlurElement, for both
+// SkMaskBlurFilter and the raster path of SkBlurImageFilter.
+//
+// It combines all three passes into a single pass. This approach is facilitated by three circular
+// buffers the width of the window which track values for trailing edges of each of the three
+// passes. This allows the algorithm to use more precision in the calculation because the values
+// are not rounded each pass. And this implementation also avoids a trap that's easy to fall
+// into resulting in blending in too many zeroes near the edge.
+//
+//  In general, a window sum has the form:
+//     sum_n+1 = sum_n + leading_edge - trailing_edge.
+//  If instead we do the subtraction at the end of the previous iteration, we can just
+// calculate the sums instead of having to do the subtractions too.
+//
+//      In previous iteration:
+//      sum_n+1 = sum_n - trailing_edge.
+//
+//      In this iteration:
+//      sum_n+1 = sum_n + leading_edge.
+//
+//  Now we can stack all three sums and do them at once. Sum0 gets its leading edge from the
+// actual data. Sum1's leading edge is just Sum0, and Sum2's leading edge is Sum1. So, doing the
+// three passes at the same time has the form:
+//
+//    sum0_n+1 = sum0_n + leading edge
+//    sum1_n+1 = sum1_n + sum0_n+1
+//    sum2_n+1 = sum2_n + sum1_n+1
+//
+//    sum2_n+1 / window^3 is the new value of the destination pixel.
+//
+//    Reduce the sums by the trailing edges which were stored in the circular buffers,
+// for the next go around. This is the case for odd sized windows, even windows the the third
+// circular buffer is one larger then the first two circular buffers.
+//
+//    sum2_n+2 = sum2_n+1 - buffer2[i];
+//    buffer2[i] = sum1;
+//    sum1_n+2 = sum1_n+1 - buffer1[i];
+//    buffer1[i] = sum0;
+//    sum0_n+2 = sum0_n+1 - buffer0[i];
+//    buffer0[i] = leading edge
+//
+// N independent lines of 8-bit values are blurred at once, one per 32-bit lane. The image filter
+// blurs the four channels of one N32 pixel along a row, or of four adjacent pixels down their
+// columns. The mask filter blurs sixteen rows of an A8 mask at a time, transposing them so that
+// the values for all sixteen are adjacent in memory.
+template <int N>
+class SkTripleBoxBlur {
+    static_assert(N % 4 == 0, "SkTripleBoxBlur blurs lines in groups of four.");
+    static constexpr int kQuads = N / 4;
+
+public:
+    // How the sum of window^3 values is scaled back down to 8 bits. These differ by at most one,
+    // and each matches what its caller has always produced.
+    enum class Rounding {
+        kNearest,     // (sum * weight + 1/2) >> 32, as SkMaskBlurFilter does.
+        kBiasedSum,   // ((sum + divisor/2) * weight) >> 32, as SkBlurImageFilter does.
+    };
+
+    // Calculating the border is tricky. The border is the distance in pixels between the first
+    // dst pixel and the first src pixel (or the last src pixel and the last dst pixel).
+    // I will go through the odd case which is simpler, and then through the even case. Given a
+    // stack of filters seven wide for the odd case of three passes.
+    //
+    //        S
+    //     aaaAaaa
+    //     bbbBbbb
+    //     cccCccc
+    //        D
+    //
+    // The furthest changed pixel is when the filters are in the following configuration.
+    //
+    //                 S
+    //           aaaAaaa
+    //        bbbBbbb
+    //     cccCccc
+    //        D
+    //
+    //  The A pixel is calculated using the value S, the B uses A, and the C uses B, and
+    // finally D is C. So, with a window size of seven the border is nine. In the odd case, the
+    // border is 3*((window - 1)/2).
+    //
+    // For even cases the filter stack is more complicated. The spec specifies two passes
+    // of even filters and a final pass of odd filters. A stack for a width of six looks like
+    // this.
+    //
+    //       S
+    //    aaaAaa
+    //     bbBbbb
+    //    cccCccc
+    //       D
+    //
+    // The furthest pixel looks like this.
+    //
+    //               S
+    //          aaaAaa
+    //        bbBbbb
+    //    cccCccc
+    //       D
+    //
+    // For a window of six, the border value is eight. In the even case the border is 3 *
+    // (window/2) - 1.
+    static int Border(int window) {
+        return (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
+    }
+
+    // The number of Sk4u a blur of window needs for its circular buffers.
+    static int BufferSize(int window) {
+        int pass2Count = (window & 1) == 1 ? window - 1 : window;
+        return (2 * (window - 1) + pass2Count) * kQuads;
+    }
+
+    // Window must be at least 2; a window of 1 doesn't blur at all.
+    SkTripleBoxBlur(int window, Rounding rounding, Sk4u* buffer)
+        : fRounding{rounding}
+        , fBuffer01Start{buffer}
+        , fBuffer01End{buffer + 2 * (window - 1) * kQuads}
+        , fBuffer2Start{fBuffer01End}
+        , fBuffer2End{buffer + BufferSize(window)} {
+        SkASSERT(window >= 2);
+
+        // If the window is odd then the divisor is just window ^ 3 otherwise,
+        // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
+        auto window2 = window * window;
+        auto window3 = window2 * window;
+        auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
+
+        // weight = 1 / d * 2 ^ 32
+        fWeight = static_cast<uint32_t>(round(1.0 / divisor * (1ull << 32)));
+
+        // NB the kBiasedSum sums use the following technique to avoid adding 1/2 to round the
+        // divide.
+        //
+        //   Sum/d + 1/2 == (Sum + h) / d
+        //   Sum + d(1/2) ==  Sum + h
+        //     h == (1/2)d
+        //
+        // But the d/2 it self should be rounded.
+        //    h == d/2 + 1/2 == (d + 1) / 2
+        fHalf = rounding == Rounding::kBiasedSum ? static_cast<uint32_t>((divisor + 1) / 2) : 0;
+
+        this->reset();
+    }
+
+    // Clears the sums and circular buffers to start blurring the next N lines.
+    void reset() {
+        for (int q = 0; q < kQuads; q++) {
+            fSum0[q] = 0;
+            fSum1[q] = 0;
+            fSum2[q] = fHalf;
+        }
+        sk_bzero(fBuffer01Start, (fBuffer2End - fBuffer01Start) * sizeof(Sk4u));
+        fCursor01 = fBuffer01Start;
+        fCursor2  = fBuffer2Start;
+    }
+
+    // Moves the window ahead by one value on each of the N lines, reading their leading edges
+    // from src and writing the blurred values to dst. Src may be nullptr to move past the end of
+    // the lines, where the values are 0.
+    SK_ALWAYS_INLINE void blur(const uint8_t* src, uint8_t* dst) {
+        for (int q = 0; q < kQuads; q++) {
+            Sk4u leadingEdge = src ? SkNx_cast<uint32_t>(Sk4b::Load(src + 4 * q)) : Sk4u(0);
+            fSum0[q] += leadingEdge;
+            fSum1[q] += fSum0[q];
+            fSum2[q] += fSum1[q];
+
+            Sk4u value = fSum2[q].mulHi(fWeight);
+            if (fRounding == Rounding::kNearest) {
+                // Add the carry out of the low half of the product and 1/2.
+                value += (fSum2[q] * fWeight) >> 31;
+            }
+            SkNx_cast<uint8_t>(value).store(dst + 4 * q);
+
+            fSum2[q] -= fCursor2[q];
+            fCursor2[q] = fSum1[q];
+            fSum1[q] -= fCursor01[kQuads + q];
+            fCursor01[kQuads + q] = fSum0[q];
+            fSum0[q] -= fCursor01[q];
+            fCursor01[q] = leadingEdge;
+        }
+        fCursor2  = fCursor2  + kQuads < fBuffer2End  ? fCursor2  + kQuads : fBuffer2Start;
+        fCursor01 = fCursor01 + 2 * kQuads < fBuffer01End ? fCursor01 + 2 * kQuads
+                                                          : fBuffer01Start;
+    }
+
+private:
+    const Rounding fRounding;
+    uint32_t       fWeight;
+    uint32_t       fHalf;
+    Sk4u           fSum0[kQuads],
+                   fSum1[kQuads],
+                   fSum2[kQuads];
+
+    // Pass 0 and pass 1 share a circular buffer, with both of their trailing edges in each step.
+    Sk4u* const    fBuffer01Start;
+    Sk4u* const    fBuffer01End;
+    Sk4u* const    fBuffer2Start;
+    Sk4u* const    fBuffer2End;
+    Sk4u*          fCursor01;
+    Sk4u*          fCursor2;
+};
+
+#endif//SkTripleBoxBlur_DEFINED
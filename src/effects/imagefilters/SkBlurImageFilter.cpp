@@ -14,13 +14,16 @@
 #include "include/private/SkColorData.h"
 #include "include/private/SkNx.h"
 #include "include/private/SkTFitsIn.h"
-#include "src/core/SkArenaAlloc.h"
+#include "include/private/SkTemplates.h"
+#include "include/private/SkTo.h"
 #include "src/core/SkAutoPixmapStorage.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/core/SkTripleBoxBlur.h"
 #include "src/core/SkWriteBuffer.h"
 
 #if SK_SUPPORT_GPU
@@ -143,174 +146,31 @@ static int calculate_window(double sigma) {
     return std::max(1, possibleWindow);
 }
 
-// Calculating the border is tricky. The border is the distance in pixels between the first dst
-// pixel and the first src pixel (or the last src pixel and the last dst pixel).
-// I will go through the odd case which is simpler, and then through the even case. Given a
-// stack of filters seven wide for the odd case of three passes.
+// blur_one_direction runs SkTripleBoxBlur over srcH lines of N32 pixels. Along rows, each pixel
+// is blurred on its own. Down columns, where adjacent lines are adjacent in memory, four pixels
+// are blurred at a time, so that each step reads and writes 16 contiguous bytes instead of 4.
 //
-//        S
-//     aaaAaaa
-//     bbbBbbb
-//     cccCccc
-//        D
-//
-// The furthest changed pixel is when the filters are in the following configuration.
-//
-//                 S
-//           aaaAaaa
-//        bbbBbbb
-//     cccCccc
-//        D
-//
-//  The A pixel is calculated using the value S, the B uses A, and the C uses B, and
-// finally D is C. So, with a window size of seven the border is nine. In the odd case, the
-// border is 3*((window - 1)/2).
-//
-// For even cases the filter stack is more complicated. The spec specifies two passes
-// of even filters and a final pass of odd filters. A stack for a width of six looks like
-// this.
-//
-//       S
-//    aaaAaa
-//     bbBbbb
-//    cccCccc
-//       D
-//
-// The furthest pixel looks like this.
-//
-//               S
-//          aaaAaa
-//        bbBbbb
-//    cccCccc
-//       D
-//
-// For a window of six, the border value is eight. In the even case the border is 3 *
-// (window/2) - 1.
-static int calculate_border(int window) {
-    return (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
-}
-
-static int calculate_buffer(int window) {
-    int bufferSize = window - 1;
-    return (window & 1) == 1 ? 3 * bufferSize : 3 * bufferSize + 1;
-}
-
-// blur_one_direction implements the common three pass box filter approximation of Gaussian blur,
-// but combines all three passes into a single pass. This approach is facilitated by three circular
-// buffers the width of the window which track values for trailing edges of each of the three
-// passes. This allows the algorithm to use more precision in the calculation because the values
-// are not rounded each pass. And this implementation also avoids a trap that's easy to fall
-// into resulting in blending in too many zeroes near the edge.
-//
-//  In general, a window sum has the form:
-//     sum_n+1 = sum_n + leading_edge - trailing_edge.
-//  If instead we do the subtraction at the end of the previous iteration, we can just
-// calculate the sums instead of having to do the subtractions too.
-//
-//      In previous iteration:
-//      sum_n+1 = sum_n - trailing_edge.
-//
-//      In this iteration:
-//      sum_n+1 = sum_n + leading_edge.
-//
-//  Now we can stack all three sums and do them at once. Sum0 gets its leading edge from the
-// actual data. Sum1's leading edge is just Sum0, and Sum2's leading edge is Sum1. So, doing the
-// three passes at the same time has the form:
-//
-//    sum0_n+1 = sum0_n + leading edge
-//    sum1_n+1 = sum1_n + sum0_n+1
-//    sum2_n+1 = sum2_n + sum1_n+1
-//
-//    sum2_n+1 / window^3 is the new value of the destination pixel.
-//
-//    Reduce the sums by the trailing edges which were stored in the circular buffers,
-// for the next go around. This is the case for odd sized windows, even windows the the third
-// circular buffer is one larger then the first two circular buffers.
-//
-//    sum2_n+2 = sum2_n+1 - buffer2[i];
-//    buffer2[i] = sum1;
-//    sum1_n+2 = sum1_n+1 - buffer1[i];
-//    buffer1[i] = sum0;
-//    sum0_n+2 = sum0_n+1 - buffer0[i];
-//    buffer0[i] = leading edge
-//
-//   This is all encapsulated in the processValue function below.
-//
-using Pass0And1 = Sk4u[2];
 // The would be dLeft parameter is assumed to be 0.
+template <int N>
 static void blur_one_direction(Sk4u* buffer, int window,
                                int srcLeft, int srcRight, int dstRight,
                                const uint32_t* src, int srcXStride, int srcYStride, int srcH,
                                      uint32_t* dst, int dstXStride, int dstYStride) {
+    static constexpr int kPixels = N / 4;
+    SkASSERT(kPixels == 1 || (srcYStride == 1 && dstYStride == 1));
+    SkASSERT(srcH % kPixels == 0);
 
-    // The circular buffers are one less than the window.
-    auto pass0Count = window - 1,
-         pass1Count = window - 1,
-         pass2Count = (window & 1) == 1 ? window - 1 : window;
-
-    Pass0And1* buffer01Start = (Pass0And1*)buffer;
-    Sk4u*      buffer2Start  = buffer + pass0Count + pass1Count;
-    Pass0And1* buffer01End   = (Pass0And1*)buffer2Start;
-    Sk4u*      buffer2End    = buffer2Start + pass2Count;
-
-    // If the window is odd then the divisor is just window ^ 3 otherwise,
-    // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
-    auto window2 = window * window;
-    auto window3 = window2 * window;
-    auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
+    SkTripleBoxBlur<N> blur{window, SkTripleBoxBlur<N>::Rounding::kBiasedSum, buffer};
 
-    // NB the sums in the blur code use the following technique to avoid
-    // adding 1/2 to round the divide.
-    //
-    //   Sum/d + 1/2 == (Sum + h) / d
-    //   Sum + d(1/2) ==  Sum + h
-    //     h == (1/2)d
-    //
-    // But the d/2 it self should be rounded.
-    //    h == d/2 + 1/2 == (d + 1) / 2
-    //
-    // weight = 1 / d * 2 ^ 32
-    auto weight = static_cast<uint32_t>(round(1.0 / divisor * (1ull << 32)));
-    auto half = static_cast<uint32_t>((divisor + 1) / 2);
-
-    auto border = calculate_border(window);
+    auto border = SkTripleBoxBlur<N>::Border(window);
 
     // Calculate the start and end of the source pixels with respect to the destination start.
     auto srcStart = srcLeft - border,
          srcEnd   = srcRight - border,
          dstEnd   = dstRight;
 
-    for (auto y = 0; y < srcH; y++) {
-        auto buffer01Cursor = buffer01Start;
-        auto buffer2Cursor  = buffer2Start;
-
-        Sk4u sum0{0u};
-        Sk4u sum1{0u};
-        Sk4u sum2{half};
-
-        sk_bzero(buffer01Start, (buffer2End - (Sk4u *) (buffer01Start)) * sizeof(*buffer2Start));
-
-        // Given an expanded input pixel, move the window ahead using the leadingEdge value.
-        auto processValue = [&](const Sk4u& leadingEdge) -> Sk4u {
-            sum0 += leadingEdge;
-            sum1 += sum0;
-            sum2 += sum1;
-
-            Sk4u value = sum2.mulHi(weight);
-
-            sum2 -= *buffer2Cursor;
-            *buffer2Cursor = sum1;
-            buffer2Cursor = (buffer2Cursor + 1) < buffer2End ? buffer2Cursor + 1 : buffer2Start;
-
-            sum1 -= (*buffer01Cursor)[1];
-            (*buffer01Cursor)[1] = sum0;
-            sum0 -= (*buffer01Cursor)[0];
-            (*buffer01Cursor)[0] = leadingEdge;
-            buffer01Cursor =
-                    (buffer01Cursor + 1) < buffer01End ? buffer01Cursor + 1 : buffer01Start;
-
-            return value;
-        };
+    for (auto y = 0; y < srcH; y += kPixels) {
+        blur.reset();
 
         auto srcIdx = srcStart;
         auto dstIdx = 0;
@@ -321,7 +181,7 @@ static void blur_one_direction(Sk4u* buffer, int window,
         // change to zero as per the spec.
         // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
         while (dstIdx < srcIdx) {
-            *dstCursor = 0;
+            sk_bzero(dstCursor, kPixels * sizeof(uint32_t));
             dstCursor += dstXStride;
             SK_PREFETCH(dstCursor);
             dstIdx++;
@@ -329,9 +189,9 @@ static void blur_one_direction(Sk4u* buffer, int window,
 
         // The edge of the source is before the edge of the destination. Calculate the sums for
         // the pixels before the start of the destination.
+        uint32_t unused[kPixels];
         while (dstIdx > srcIdx) {
-            Sk4u leadingEdge = srcIdx < srcEnd ? SkNx_cast<uint32_t>(Sk4b::Load(srcCursor)) : 0;
-            (void) processValue(leadingEdge);
+            blur.blur(srcIdx < srcEnd ? (const uint8_t*)srcCursor : nullptr, (uint8_t*)unused);
             srcCursor += srcXStride;
             srcIdx++;
         }
@@ -340,8 +200,7 @@ static void blur_one_direction(Sk4u* buffer, int window,
         // Consume the source generating pixels to dst.
         auto loopEnd = std::min(dstEnd, srcEnd);
         while (dstIdx < loopEnd) {
-            Sk4u leadingEdge = SkNx_cast<uint32_t>(Sk4b::Load(srcCursor));
-            SkNx_cast<uint8_t>(processValue(leadingEdge)).store(dstCursor);
+            blur.blur((const uint8_t*)srcCursor, (uint8_t*)dstCursor);
             srcCursor += srcXStride;
             dstCursor += dstXStride;
             SK_PREFETCH(dstCursor);
@@ -352,15 +211,45 @@ static void blur_one_direction(Sk4u* buffer, int window,
         // are now 0x0000 until the end of the destination.
         loopEnd = dstEnd;
         while (dstIdx < loopEnd) {
-            SkNx_cast<uint8_t>(processValue(0u)).store(dstCursor);
+            blur.blur(nullptr, (uint8_t*)dstCursor);
             dstCursor += dstXStride;
             SK_PREFETCH(dstCursor);
             dstIdx++;
         }
 
-        src += srcYStride;
-        dst += dstYStride;
+        src += kPixels * srcYStride;
+        dst += kPixels * dstYStride;
+    }
+}
+
+// With an executor, blurs of many lines are split into strips of lines blurred concurrently.
+// Every line is blurred on its own, so the output is the same however the lines are split.
+static constexpr int kMinLinesPerStrip = 64;
+static constexpr int kMaxStrips        = 16;
+
+// Calls fn(buffer, start, end) for strips of lines covering [0, lines), each with its own
+// circular buffers of bufferSize. Strips start at multiples of four lines, so that four column
+// blurs within a strip line up with those over the whole image.
+template <typename Fn>
+static void for_each_strip(SkExecutor* executor, int lines, int bufferSize, Fn&& fn) {
+    int strips = executor ? SkTPin(lines / kMinLinesPerStrip, 1, kMaxStrips) : 1;
+
+    auto strip = [&](int i) {
+        int start = SkToInt(int64_t(lines) * i / strips) & ~3,
+            end   = i + 1 == strips ? lines : SkToInt(int64_t(lines) * (i + 1) / strips) & ~3;
+
+        // The amount 4096 bytes is enough for buffers up to 10 sigma.
+        SkAutoSTMalloc<256, Sk4u> buffer(bufferSize);
+        fn(buffer.get(), start, end);
+    };
+
+    if (strips == 1) {
+        strip(0);
+        return;
     }
+    SkTaskGroup tasks(*executor);
+    tasks.batch(strips, strip);
+    tasks.wait();
 }
 
 static sk_sp<SkSpecialImage> copy_image_with_bounds(
@@ -469,13 +358,14 @@ static sk_sp<SkSpecialImage> cpu_blur(
         return nullptr;
     }
 
-    auto bufferSizeW = calculate_buffer(windowW),
-         bufferSizeH = calculate_buffer(windowH);
+    // Blurring four columns at a time lets the vertical pass read and write 16 contiguous bytes
+    // each step, but needs four times the buffer space. Once the buffers no longer fit in cache
+    // that costs more than it saves.
+    bool fourColumns = SkTripleBoxBlur<16>::BufferSize(windowH) * sizeof(Sk4u) <= 16 * 1024;
 
-    // The amount 1024 is enough for buffers up to 10 sigma. The tmp bitmap will be
-    // allocated on the heap.
-    SkSTArenaAlloc<1024> alloc;
-    Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(std::max(bufferSizeW, bufferSizeH));
+    auto bufferSizeW = SkTripleBoxBlur<4>::BufferSize(std::max(windowW, 2)),
+         bufferSizeH = fourColumns ? SkTripleBoxBlur<16>::BufferSize(std::max(windowH, 2))
+                                   : SkTripleBoxBlur<4>::BufferSize(std::max(windowH, 2));
 
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
@@ -517,19 +407,36 @@ static sk_sp<SkSpecialImage> cpu_blur(
         intermediateWidth = dstW;
         intermediateDst = static_cast<uint32_t *>(dst.getPixels());
 
-        blur_one_direction(
-                buffer, windowW,
-                srcBounds.left(), srcBounds.right(), dstBounds.right(),
-                static_cast<uint32_t *>(src.getPixels()), 1, src.rowBytesAsPixels(), srcH,
-                intermediateSrc, 1, intermediateRowBytesAsPixels);
+        for_each_strip(ctx.executor(), srcH, bufferSizeW, [&](Sk4u* buffer, int top, int bottom) {
+            blur_one_direction<4>(
+                    buffer, windowW,
+                    srcBounds.left(), srcBounds.right(), dstBounds.right(),
+                    static_cast<uint32_t*>(src.getPixels()) + top * src.rowBytesAsPixels(),
+                    1, src.rowBytesAsPixels(), bottom - top,
+                    intermediateSrc + top * intermediateRowBytesAsPixels,
+                    1, intermediateRowBytesAsPixels);
+        });
     }
 
     if (windowH > 1) {
-        blur_one_direction(
-                buffer, windowH,
-                srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
-                intermediateSrc, intermediateRowBytesAsPixels, 1, intermediateWidth,
-                intermediateDst, dst.rowBytesAsPixels(), 1);
+        for_each_strip(ctx.executor(), intermediateWidth, bufferSizeH,
+                       [&](Sk4u* buffer, int left, int right) {
+            auto columns = 0;
+            if (fourColumns) {
+                columns = (right - left) & ~3;
+                blur_one_direction<16>(
+                        buffer, windowH,
+                        srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
+                        intermediateSrc + left, intermediateRowBytesAsPixels, 1, columns,
+                        intermediateDst + left, dst.rowBytesAsPixels(), 1);
+            }
+            blur_one_direction<4>(
+                    buffer, windowH,
+                    srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
+                    intermediateSrc + left + columns, intermediateRowBytesAsPixels, 1,
+                    right - left - columns,
+                    intermediateDst + left + columns, dst.rowBytesAsPixels(), 1);
+        });
     }
 
     return SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(dstBounds.width(),
@@ -277,7 +277,7 @@ sk_sp<SkSpecialImage> SkDisplacementMapEffectImpl::onFilterImage(const Context&
     // color space makes sense, so we ignore color spaces (and gamma) entirely. This may not be
     // ideal, but it's at least consistent and predictable.
     Context displContext(ctx.mapping(), ctx.desiredOutput(), ctx.cache(),
-                         kN32_SkColorType, nullptr, ctx.source());
+                         kN32_SkColorType, nullptr, ctx.source(), ctx.executor());
     sk_sp<SkSpecialImage> displ(this->filterInput(0, displContext, &displOffset));
     if (!displ) {
         return nullptr;
@@ -6,10 +6,12 @@
  */
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkMallocPixelRef.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkImagePriv.h"
+#include "src/core/SkThreadedBMPDevice.h"
 #include "src/image/SkSurface_Base.h"
 
 class SkSurface_Raster : public SkSurface_Base {
@@ -17,7 +19,8 @@ public:
     SkSurface_Raster(const SkImageInfo&, void*, size_t rb,
                      void (*releaseProc)(void* pixels, void* context), void* context,
                      const SkSurfaceProps*);
-    SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*);
+    SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*,
+                     SkExecutor* executor = nullptr);
 
     SkCanvas* onNewCanvas() override;
     sk_sp<SkSurface> onNewSurface(const SkImageInfo&) override;
@@ -26,10 +29,16 @@ public:
     void onDraw(SkCanvas*, SkScalar x, SkScalar y, const SkPaint*) override;
     void onCopyOnWrite(ContentChangeMode) override;
     void onRestoreBackingMutability() override;
+    GrSemaphoresSubmitted onFlush(BackendSurfaceAccess, const GrFlushInfo&,
+                                  const GrBackendSurfaceMutableState*) override;
 
 private:
+    // Rasterize any draws our SkThreadedBMPDevice has deferred, before we touch fBitmap.
+    void flushPendingDraws();
+
     SkBitmap    fBitmap;
     bool        fWeOwnThePixels;
+    SkExecutor* fExecutor = nullptr;    // if set, we draw through an SkThreadedBMPDevice
 
     typedef SkSurface_Base INHERITED;
 };
@@ -76,26 +85,49 @@ SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, void* pixels, size_t
 }
 
 SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef> pr,
-                                   const SkSurfaceProps* props)
+                                   const SkSurfaceProps* props, SkExecutor* executor)
     : INHERITED(pr->width(), pr->height(), props)
+    , fExecutor(executor)
 {
     fBitmap.setInfo(info, pr->rowBytes());
     fBitmap.setPixelRef(std::move(pr), 0, 0);
     fWeOwnThePixels = true;
 }
 
-SkCanvas* SkSurface_Raster::onNewCanvas() { return new SkCanvas(fBitmap, this->props()); }
+SkCanvas* SkSurface_Raster::onNewCanvas() {
+    if (fExecutor) {
+        return new SkCanvas(sk_make_sp<SkThreadedBMPDevice>(fBitmap, this->props(), fExecutor));
+    }
+    return new SkCanvas(fBitmap, this->props());
+}
 
 sk_sp<SkSurface> SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
+    if (fExecutor) {
+        return SkSurface::MakeRasterThreaded(info, fExecutor, &this->props());
+    }
     return SkSurface::MakeRaster(info, &this->props());
 }
 
+void SkSurface_Raster::flushPendingDraws() {
+    if (fExecutor) {
+        this->getCachedCanvas()->flush();
+    }
+}
+
+GrSemaphoresSubmitted SkSurface_Raster::onFlush(BackendSurfaceAccess, const GrFlushInfo&,
+                                                const GrBackendSurfaceMutableState*) {
+    this->flushPendingDraws();
+    return GrSemaphoresSubmitted::kNo;
+}
+
 void SkSurface_Raster::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
                               const SkPaint* paint) {
+    this->flushPendingDraws();
     canvas->drawBitmap(fBitmap, x, y, paint);
 }
 
 sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
+    this->flushPendingDraws();
     if (subset) {
         SkASSERT(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()).contains(*subset));
         SkBitmap dst;
@@ -122,6 +154,7 @@ sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
 }
 
 void SkSurface_Raster::onWritePixels(const SkPixmap& src, int x, int y) {
+    this->flushPendingDraws();
     fBitmap.writePixels(src, x, y);
 }
 
@@ -199,3 +232,17 @@ sk_sp<SkSurface> SkSurface::MakeRasterN32Premul(int width, int height,
                                                 const SkSurfaceProps* surfaceProps) {
     return MakeRaster(SkImageInfo::MakeN32Premul(width, height), surfaceProps);
 }
+
+sk_sp<SkSurface> SkSurface::MakeRasterThreaded(const SkImageInfo& info, SkExecutor* executor,
+                                               const SkSurfaceProps* props) {
+    if (!SkSurfaceValidateRasterInfo(info)) {
+        return nullptr;
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeAllocate(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    return sk_make_sp<SkSurface_Raster>(info, std::move(pr), props,
+                                        executor ? executor : &SkExecutor::GetDefault());
+}
@@ -9,17 +9,22 @@
 
 #ifdef SK_ENCODE_PNG
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/private/SkImageInfoPriv.h"
+#include "include/private/SkVx.h"
 #include "src/codec/SkColorTable.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkEndian.h"
 #include "src/core/SkMSAN.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/images/SkImageEncoderFns.h"
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -64,6 +69,10 @@ public:
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
 
+    // When true, rows are filtered and IDAT is written by encodeIDATRows() instead of libpng.
+    bool writesIDAT() const { return fWritesIDAT; }
+    bool encodeIDATRows(const SkPixmap& src, int startRow, int numRows);
+
     ~SkPngEncoderMgr() {
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
     }
@@ -79,6 +88,13 @@ private:
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+
+    SkExecutor*             fExecutor = nullptr;
+    int                     fFilters = PNG_FILTER_NONE;
+    int                     fZLibLevel = 6;
+    bool                    fFastFilterSelection = false;
+    bool                    fWritesIDAT = false;
+    uLong                   fAdler = 1;  // adler32() of the empty string.
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -202,6 +218,12 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
 
+    // libpng treats an empty set of filters as kNone.
+    fFilters = filters ? filters : PNG_FILTER_NONE;
+    fZLibLevel = zlibLevel;
+    fExecutor = options.fExecutor;
+    fFastFilterSelection = options.fFastFilterSelection;
+
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
     if (comments != nullptr) {
@@ -390,6 +412,359 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
 
 void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
+
+    // We can only filter rows ourselves if they already have the layout libpng would write.
+    fWritesIDAT = (fExecutor || fFastFilterSelection) &&
+                  png_get_rowbytes(fPngPtr, fInfoPtr) ==
+                          (size_t)fPngBytesPerPixel * srcInfo.width();
+}
+
+// With an executor, rows are split into runs of roughly this many bytes.  Each run is filtered and
+// deflated on its own, then ended on a byte boundary with Z_SYNC_FLUSH, so the raw deflate output
+// of consecutive runs can simply be concatenated into one zlib stream (as pigz does).
+static constexpr size_t kParallelRunBytes = 128 * 1024;
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkTAbs(p - a),
+        pb = SkTAbs(p - b),
+        pc = SkTAbs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Filters byte i of |row| against |prev|, handling the first bpp bytes, which have no left pixel.
+template <int kFilter>
+static uint8_t filter_byte(const uint8_t* row, const uint8_t* prev, size_t i, int bpp) {
+    int left   = i >= (size_t)bpp ? row[i - bpp]  : 0,
+        upLeft = i >= (size_t)bpp ? prev[i - bpp] : 0;
+    switch (kFilter) {
+        case PNG_FILTER_VALUE_SUB:   return row[i] - left;
+        case PNG_FILTER_VALUE_UP:    return row[i] - prev[i];
+        case PNG_FILTER_VALUE_AVG:   return row[i] - ((left + prev[i]) >> 1);
+        case PNG_FILTER_VALUE_PAETH: return row[i] - paeth_predictor(left, prev[i], upLeft);
+    }
+    return row[i];
+}
+
+using U8x16 = skvx::Vec<16, uint8_t>;
+
+// Filters the 16 bytes of |row| starting at i >= bpp.  Encoding only depends on the unfiltered
+// rows, so unlike decoding, every lane is independent.
+template <int kFilter>
+static U8x16 filter_16(const uint8_t* row, const uint8_t* prev, size_t i, int bpp) {
+    SkASSERT(i >= (size_t)bpp);
+    U8x16 x = U8x16::Load(row + i);
+    switch (kFilter) {
+        case PNG_FILTER_VALUE_SUB: return x - U8x16::Load(row + i - bpp);
+        case PNG_FILTER_VALUE_UP:  return x - U8x16::Load(prev + i);
+        case PNG_FILTER_VALUE_AVG: {
+            U8x16 a = U8x16::Load(row + i - bpp),
+                  b = U8x16::Load(prev + i);
+            // (a + b) >> 1, without overflowing 8 bits.
+            return x - ((a & b) + ((a ^ b) >> 1));
+        }
+        case PNG_FILTER_VALUE_PAETH: {
+            using I16x16 = skvx::Vec<16, int16_t>;
+            I16x16 a = skvx::cast<int16_t>(U8x16::Load(row + i - bpp)),
+                   b = skvx::cast<int16_t>(U8x16::Load(prev + i)),
+                   c = skvx::cast<int16_t>(U8x16::Load(prev + i - bpp));
+            // With p = a + b - c, these are |p - a|, |p - b| and |p - c|.
+            I16x16 pa = abs(b - c),
+                   pb = abs(a - c),
+                   pc = abs(a + b - c - c);
+            I16x16 pred = if_then_else((pa <= pb) & (pa <= pc), a,
+                                       if_then_else(pb <= pc, b, c));
+            return x - skvx::cast<uint8_t>(pred);
+        }
+    }
+    return x;
+}
+
+template <int kFilter>
+static void filter_row(uint8_t* dst, const uint8_t* row, const uint8_t* prev,
+                       size_t rowBytes, int bpp) {
+    size_t i = 0;
+    for (; i < std::min(rowBytes, (size_t)bpp); i++) {
+        dst[i] = filter_byte<kFilter>(row, prev, i, bpp);
+    }
+    for (; i + 16 <= rowBytes; i += 16) {
+        filter_16<kFilter>(row, prev, i, bpp).store(dst + i);
+    }
+    for (; i < rowBytes; i++) {
+        dst[i] = filter_byte<kFilter>(row, prev, i, bpp);
+    }
+}
+
+// Writes filter type byte |filter| followed by |row| filtered against |prev| into |dst|.
+static void filter_row(int filter, uint8_t* dst, const uint8_t* row, const uint8_t* prev,
+                       size_t rowBytes, int bpp) {
+    *dst++ = filter;
+    switch (filter) {
+        case PNG_FILTER_VALUE_NONE:
+            memcpy(dst, row, rowBytes);
+            break;
+        case PNG_FILTER_VALUE_SUB:   filter_row<PNG_FILTER_VALUE_SUB  >(dst, row, prev, rowBytes, bpp); break;
+        case PNG_FILTER_VALUE_UP:    filter_row<PNG_FILTER_VALUE_UP   >(dst, row, prev, rowBytes, bpp); break;
+        case PNG_FILTER_VALUE_AVG:   filter_row<PNG_FILTER_VALUE_AVG  >(dst, row, prev, rowBytes, bpp); break;
+        case PNG_FILTER_VALUE_PAETH: filter_row<PNG_FILTER_VALUE_PAETH>(dst, row, prev, rowBytes, bpp); break;
+        default:
+            SkASSERT(false);
+    }
+}
+
+// libpng's heuristic for picking a filter: the sum of the filtered bytes, read as signed, in
+// absolute value.  Smaller tends to deflate better.
+static inline int byte_cost(uint8_t v) { return v < 128 ? v : 256 - v; }
+
+// With fFastFilterSelection, the cost is estimated from at most this many 16 byte blocks spread
+// evenly across the row, rather than from the whole row.
+static constexpr size_t kSampledCostBlocks = 32;
+
+// Returns the cost of filtering |row| with kFilter, without writing the filtered bytes.  When
+// |sampled|, only some of the row's blocks are looked at; that's fine for comparing filters, as
+// long as every filter looks at the same blocks.
+template <int kFilter>
+static size_t row_cost(const uint8_t* row, const uint8_t* prev, size_t rowBytes, int bpp,
+                       bool sampled) {
+    const size_t blocks = rowBytes > (size_t)bpp ? (rowBytes - bpp) / 16 : 0;
+    const size_t step = sampled ? std::max<size_t>(1, blocks / kSampledCostBlocks) : 1;
+
+    skvx::Vec<16, uint32_t> sum(0);
+    for (size_t b = 0; b < blocks; b += step) {
+        U8x16 v = filter_16<kFilter>(row, prev, bpp + 16 * b, bpp);
+        sum += skvx::cast<uint32_t>(min(v, U8x16(0) - v));
+    }
+    size_t cost = 0;
+    for (int lane = 0; lane < 16; lane++) {
+        cost += sum[lane];
+    }
+
+    if (step == 1) {
+        // Every block was counted; add in the bytes before and after them for an exact cost.
+        for (size_t i = 0; i < std::min(rowBytes, (size_t)bpp); i++) {
+            cost += byte_cost(filter_byte<kFilter>(row, prev, i, bpp));
+        }
+        for (size_t i = bpp + 16 * blocks; i < rowBytes; i++) {
+            cost += byte_cost(filter_byte<kFilter>(row, prev, i, bpp));
+        }
+    }
+    return cost;
+}
+
+// Returns the filter from |filters| (a mask of PNG_FILTER_*) that the heuristic favors for |row|.
+static int choose_filter(int filters, const uint8_t* row, const uint8_t* prev, size_t rowBytes,
+                         int bpp, bool sampled) {
+    static constexpr size_t (*kCosts[])(const uint8_t*, const uint8_t*, size_t, int, bool) = {
+        row_cost<PNG_FILTER_VALUE_NONE>,
+        row_cost<PNG_FILTER_VALUE_SUB>,
+        row_cost<PNG_FILTER_VALUE_UP>,
+        row_cost<PNG_FILTER_VALUE_AVG>,
+        row_cost<PNG_FILTER_VALUE_PAETH>,
+    };
+    static_assert(SK_ARRAY_COUNT(kCosts) == PNG_FILTER_VALUE_LAST, "");
+
+    int best = PNG_FILTER_VALUE_NONE;
+    size_t bestCost = SIZE_MAX;
+    for (int filter = PNG_FILTER_VALUE_NONE; filter < PNG_FILTER_VALUE_LAST; filter++) {
+        if (!(filters & (PNG_FILTER_NONE << filter))) {
+            continue;
+        }
+        if (SkIsPow2(filters)) {
+            return filter;
+        }
+        size_t cost = kCosts[filter](row, prev, rowBytes, bpp, sampled);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = filter;
+        }
+    }
+    return best;
+}
+
+static void deflate_to(z_stream* zStream, int flush, SkWStream* dst) {
+    uint8_t outBuffer[16384];
+    do {
+        zStream->next_out = outBuffer;
+        zStream->avail_out = sizeof(outBuffer);
+        SkDEBUGCODE(int result =) deflate(zStream, flush);
+        SkASSERT(result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR);
+        dst->write(outBuffer, sizeof(outBuffer) - zStream->avail_out);
+    } while (zStream->avail_in || !zStream->avail_out);
+}
+
+static bool write_png_chunk(SkWStream* dst, const char type[4], const void* data, size_t len) {
+    uint32_t lenBE = SkEndian_SwapBE32(SkToU32(len));
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+    crc = crc32(crc, (const Bytef*)data, SkToUInt(len));
+    uint32_t crcBE = SkEndian_SwapBE32(SkToU32(crc));
+    return dst->write(&lenBE, 4)
+        && dst->write(type, 4)
+        && (len == 0 || dst->write(data, len))
+        && dst->write(&crcBE, 4);
+}
+
+// Compressed data is written out in IDAT chunks of at most this many bytes as deflate produces it.
+static constexpr size_t kIDATChunkBytes = 64 * 1024;
+
+namespace {
+// Splits everything written to it into IDAT chunks of kIDATChunkBytes, so at most one chunk of
+// compressed data is held at a time.
+class IDATWStream final : public SkWStream {
+public:
+    explicit IDATWStream(SkWStream* dst) : fDst(dst), fChunk(kIDATChunkBytes) {}
+
+    bool write(const void* buffer, size_t size) override {
+        const uint8_t* src = (const uint8_t*)buffer;
+        fBytesWritten += size;
+        while (size > 0) {
+            size_t n = std::min(size, kIDATChunkBytes - fUsed);
+            memcpy(fChunk.get() + fUsed, src, n);
+            fUsed += n;
+            src += n;
+            size -= n;
+            if (fUsed == kIDATChunkBytes && !this->writeChunk()) {
+                return false;
+            }
+        }
+        return fSucceeded;
+    }
+
+    size_t bytesWritten() const override { return fBytesWritten; }
+
+    // Writes whatever is buffered as a (possibly short) chunk.  Returns false if any chunk failed.
+    bool writeChunk() {
+        if (fUsed > 0 && fSucceeded) {
+            fSucceeded = write_png_chunk(fDst, "IDAT", fChunk.get(), fUsed);
+        }
+        fUsed = 0;
+        return fSucceeded;
+    }
+
+private:
+    SkWStream*             fDst;
+    SkAutoTMalloc<uint8_t> fChunk;
+    size_t                 fUsed = 0;
+    size_t                 fBytesWritten = 0;
+    bool                   fSucceeded = true;
+};
+
+struct ParallelRun {
+    SkDynamicMemoryWStream fCompressed;
+    uLong                  fAdler = 1;
+    size_t                 fFilteredBytes = 0;
+    bool                   fSucceeded = false;
+};
+}  // namespace
+
+// Transforms, filters and deflates rows [startRow, endRow) of |src| into |dst|, recording the
+// adler32 of the filtered rows in |run|.
+static void encode_run(const SkPixmap& src, transform_scanline_proc proc, int bpp, int filters,
+                       bool sampledCosts, int zlibLevel, int startRow, int endRow, bool lastRun,
+                       SkWStream* dst, ParallelRun* run) {
+    const size_t rowBytes = (size_t)bpp * src.width();
+    const int srcBpp = SkColorTypeBytesPerPixel(src.colorType());
+
+    // prev and curr hold transformed rows; filtered holds the filter type byte and filtered curr.
+    SkAutoTMalloc<uint8_t> storage(2 * rowBytes + rowBytes + 1);
+    uint8_t* prev     = storage.get();
+    uint8_t* curr     = prev + rowBytes;
+    uint8_t* filtered = curr + rowBytes;
+
+    if (startRow > 0) {
+        proc((char*)prev, (const char*)src.addr(0, startRow - 1), src.width(), srcBpp);
+    } else {
+        sk_bzero(prev, rowBytes);
+        // The two byte zlib header: deflate with a 32K window, and a hint of the level used.
+        int flevel = zlibLevel < 2 ? 0 : zlibLevel < 6 ? 1 : zlibLevel == 6 ? 2 : 3;
+        uint8_t header[2] = { 0x78, (uint8_t)(flevel << 6) };
+        header[1] += 31 - ((header[0] << 8) + header[1]) % 31;
+        dst->write(header, sizeof(header));
+    }
+
+    z_stream zStream;
+    zStream.zalloc = Z_NULL;
+    zStream.zfree = Z_NULL;
+    zStream.opaque = Z_NULL;
+    // Negative window bits: raw deflate, with no zlib header or adler32 trailer of its own.
+    // Like libpng, favor Huffman coding over string matching once rows are filtered.
+    int strategy = filters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    if (Z_OK != deflateInit2(&zStream, zlibLevel, Z_DEFLATED, -15, 8, strategy)) {
+        return;
+    }
+
+    for (int y = startRow; y < endRow; y++) {
+        const void* srcRow = src.addr(0, y);
+        sk_msan_assert_initialized(srcRow,
+                                   (const uint8_t*)srcRow + (src.width() << src.shiftPerPixel()));
+        proc((char*)curr, (const char*)srcRow, src.width(), srcBpp);
+
+        int filter = choose_filter(filters, curr, prev, rowBytes, bpp, sampledCosts);
+        filter_row(filter, filtered, curr, prev, rowBytes, bpp);
+
+        run->fAdler = adler32(run->fAdler, filtered, SkToUInt(rowBytes + 1));
+        run->fFilteredBytes += rowBytes + 1;
+        zStream.next_in = filtered;
+        zStream.avail_in = SkToUInt(rowBytes + 1);
+        deflate_to(&zStream, Z_NO_FLUSH, dst);
+        std::swap(prev, curr);
+    }
+
+    deflate_to(&zStream, lastRun ? Z_FINISH : Z_SYNC_FLUSH, dst);
+    (void)deflateEnd(&zStream);
+    run->fSucceeded = true;
+}
+
+bool SkPngEncoderMgr::encodeIDATRows(const SkPixmap& src, int startRow, int numRows) {
+    const size_t rowBytes = (size_t)fPngBytesPerPixel * src.width();
+    const int rowsPerRun = fExecutor ? (int)std::max<size_t>(1, kParallelRunBytes / rowBytes)
+                                     : numRows;
+    const int numRuns = (numRows + rowsPerRun - 1) / rowsPerRun;
+    const int endRow = startRow + numRows;
+    const bool finalRows = endRow == src.height();
+
+    SkWStream* dst = (SkWStream*)png_get_io_ptr(fPngPtr);
+    IDATWStream idat(dst);
+
+    // Serially, deflate output goes straight into IDAT chunks.  In parallel, each run buffers its
+    // own output until the runs before it have been written.
+    SkAutoTArray<ParallelRun> runs(numRuns);
+    auto encodeRun = [&](int i) {
+        int runStart = startRow + i * rowsPerRun;
+        int runEnd = std::min(runStart + rowsPerRun, endRow);
+        SkWStream* runDst = &idat;
+        if (fExecutor) {
+            runDst = &runs[i].fCompressed;
+        }
+        encode_run(src, fProc, fPngBytesPerPixel, fFilters, fFastFilterSelection, fZLibLevel,
+                   runStart, runEnd, finalRows && runEnd == endRow, runDst, &runs[i]);
+    };
+    if (fExecutor) {
+        SkTaskGroup taskGroup(*fExecutor);
+        taskGroup.batch(numRuns, encodeRun);
+        taskGroup.wait();
+    } else {
+        encodeRun(0);
+    }
+
+    for (int i = 0; i < numRuns; i++) {
+        ParallelRun& run = runs[i];
+        if (!run.fSucceeded || !run.fCompressed.writeToAndReset(&idat)) {
+            return false;
+        }
+        fAdler = adler32_combine(fAdler, run.fAdler, (z_off_t)run.fFilteredBytes);
+    }
+    if (finalRows) {
+        uint32_t adlerBE = SkEndian_SwapBE32(SkToU32(fAdler));
+        idat.write(&adlerBE, 4);
+    }
+    if (!idat.writeChunk()) {
+        return false;
+    }
+
+    return !finalRows || write_png_chunk(dst, "IEND", nullptr, 0);
 }
 
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
@@ -428,6 +803,14 @@ SkPngEncoder::SkPngEncoder(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const Sk
 SkPngEncoder::~SkPngEncoder() {}
 
 bool SkPngEncoder::onEncodeRows(int numRows) {
+    if (fEncoderMgr->writesIDAT()) {
+        if (!fEncoderMgr->encodeIDATRows(fSrc, fCurrRow, numRows)) {
+            return false;
+        }
+        fCurrRow += numRows;
+        return true;
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
@@ -37,9 +37,9 @@ void skia_free_func(void*, void* address) { sk_free(address); }
 static void do_deflate(int flush,
                        z_stream* zStream,
                        SkWStream* out,
-                       unsigned char* inBuffer,
+                       const unsigned char* inBuffer,
                        size_t inBufferSize) {
-    zStream->next_in = inBuffer;
+    zStream->next_in = const_cast<unsigned char*>(inBuffer);  // zlib doesn't write to it.
     zStream->avail_in = SkToInt(inBufferSize);
     unsigned char outBuffer[SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE];
     SkDEBUGCODE(int returnValue;)
@@ -104,6 +104,15 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
     }
     const char* buffer = (const char*)void_buffer;
     while (len > 0) {
+        // Writes at least as big as our buffer go straight to zlib, skipping the copy.
+        if (0 == fImpl->fInBufferIndex && len >= sizeof(fImpl->fInBuffer)) {
+            size_t todeflate = std::min(len, (size_t)SK_MaxS32);
+            do_deflate(Z_NO_FLUSH, &fImpl->fZStream, fImpl->fOut,
+                       (const unsigned char*)buffer, todeflate);
+            len -= todeflate;
+            buffer += todeflate;
+            continue;
+        }
         size_t tocopy =
                 std::min(len, sizeof(fImpl->fInBuffer) - fImpl->fInBufferIndex);
         memcpy(fImpl->fInBuffer + fImpl->fInBufferIndex, buffer, tocopy);
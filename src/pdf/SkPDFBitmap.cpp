@@ -8,12 +8,12 @@
 #include "src/pdf/SkPDFBitmap.h"
 
 #include "include/core/SkData.h"
-#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkTLazy.h"
 #include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkJpegInfo.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
@@ -65,6 +65,20 @@ static SkColor get_neighbor_avg_color(const SkPixmap& bm, int xOrig, int yOrig)
                  : SK_ColorTRANSPARENT;
 }
 
+enum class ImageFilter { kNone, kFlate, kDCT };
+
+// CompressionLevel::None writes image and alpha streams without a /FlateDecode filter at all,
+// rather than wrapping them in level-0 deflate blocks.
+static SkWStream* make_image_stream(SkPDFDocument* doc,
+                                    SkTLazy<SkDeflateWStream>* deflateWStream,
+                                    SkWStream* buffer) {
+    SkPDF::Metadata::CompressionLevel level = doc->metadata().fCompressionLevel;
+    if (level == SkPDF::Metadata::CompressionLevel::None) {
+        return buffer;
+    }
+    return deflateWStream->init(buffer, SkToInt(level));
+}
+
 template <typename T>
 static void emit_image_stream(SkPDFDocument* doc,
                               SkPDFIndirectReference ref,
@@ -73,7 +87,7 @@ static void emit_image_stream(SkPDFDocument* doc,
                               const char* colorSpace,
                               SkPDFIndirectReference sMask,
                               int length,
-                              bool isJpeg) {
+                              ImageFilter filter) {
     SkPDFDict pdfDict("XObject");
     pdfDict.insertName("Subtype", "Image");
     pdfDict.insertInt("Width", size.width());
@@ -83,15 +97,22 @@ static void emit_image_stream(SkPDFDocument* doc,
         pdfDict.insertRef("SMask", sMask);
     }
     pdfDict.insertInt("BitsPerComponent", 8);
+    const char* filterName = filter == ImageFilter::kDCT   ? "DCTDecode"
+                           : filter == ImageFilter::kFlate ? "FlateDecode"
+                                                           : nullptr;
     #ifdef SK_PDF_BASE85_BINARY
     auto filters = SkPDFMakeArray();
     filters->appendName("ASCII85Decode");
-    filters->appendName(isJpeg ? "DCTDecode" : "FlateDecode");
+    if (filterName) {
+        filters->appendName(filterName);
+    }
     pdfDict.insertObject("Filter", std::move(filters));
     #else
-    pdfDict.insertName("Filter", isJpeg ? "DCTDecode" : "FlateDecode");
+    if (filterName) {
+        pdfDict.insertName("Filter", filterName);
+    }
     #endif
-    if (isJpeg) {
+    if (filter == ImageFilter::kDCT) {
         pdfDict.insertInt("ColorTransform", 0);
     }
     pdfDict.insertInt("Length", length);
@@ -100,10 +121,11 @@ static void emit_image_stream(SkPDFDocument* doc,
 
 static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectReference ref) {
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkTLazy<SkDeflateWStream> deflateWStream;
+    SkWStream* out = make_image_stream(doc, &deflateWStream, &buffer);
     if (kAlpha_8_SkColorType == pm.colorType()) {
         SkASSERT(pm.rowBytes() == (size_t)pm.width());
-        buffer.write(pm.addr8(), pm.width() * pm.height());
+        out->write(pm.addr8(), pm.width() * pm.height());
     } else {
         SkASSERT(pm.alphaType() == kUnpremul_SkAlphaType);
         SkASSERT(pm.colorType() == kBGRA_8888_SkColorType);
@@ -117,13 +139,15 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
         while (ptr != stop) {
             *dst++ = 0xFF & ((*ptr++) >> SK_BGRA_A32_SHIFT);
             if (dst == bufferStop) {
-                deflateWStream.write(byteBuffer, sizeof(byteBuffer));
+                out->write(byteBuffer, sizeof(byteBuffer));
                 dst = byteBuffer;
             }
         }
-        deflateWStream.write(byteBuffer, dst - byteBuffer);
+        out->write(byteBuffer, dst - byteBuffer);
+    }
+    if (deflateWStream.isValid()) {
+        deflateWStream->finalize();
     }
-    deflateWStream.finalize();
 
     #ifdef SK_PDF_BASE85_BINARY
     SkPDFUtils::Base85Encode(buffer.detachAsStream(), &buffer);
@@ -131,7 +155,8 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
     int length = SkToInt(buffer.bytesWritten());
     emit_image_stream(doc, ref, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
                       pm.info().dimensions(), "DeviceGray", SkPDFIndirectReference(),
-                      length, false);
+                      length,
+                      deflateWStream.isValid() ? ImageFilter::kFlate : ImageFilter::kNone);
 }
 
 static void do_deflated_image(const SkPixmap& pm,
@@ -143,16 +168,17 @@ static void do_deflated_image(const SkPixmap& pm,
         sMask = doc->reserveRef();
     }
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkTLazy<SkDeflateWStream> deflateWStream;
+    SkWStream* out = make_image_stream(doc, &deflateWStream, &buffer);
     const char* colorSpace = "DeviceGray";
     switch (pm.colorType()) {
         case kAlpha_8_SkColorType:
-            fill_stream(&deflateWStream, '\x00', pm.width() * pm.height());
+            fill_stream(out, '\x00', pm.width() * pm.height());
             break;
         case kGray_8_SkColorType:
             SkASSERT(sMask.fValue = -1);
             SkASSERT(pm.rowBytes() == (size_t)pm.width());
-            deflateWStream.write(pm.addr8(), pm.width() * pm.height());
+            out->write(pm.addr8(), pm.width() * pm.height());
             break;
         default:
             colorSpace = "DeviceRGB";
@@ -174,20 +200,23 @@ static void do_deflated_image(const SkPixmap& pm,
                     *dst++ = SkColorGetG(color);
                     *dst++ = SkColorGetB(color);
                     if (dst == bufferStop) {
-                        deflateWStream.write(byteBuffer, sizeof(byteBuffer));
+                        out->write(byteBuffer, sizeof(byteBuffer));
                         dst = byteBuffer;
                     }
                 }
             }
-            deflateWStream.write(byteBuffer, dst - byteBuffer);
+            out->write(byteBuffer, dst - byteBuffer);
+    }
+    if (deflateWStream.isValid()) {
+        deflateWStream->finalize();
     }
-    deflateWStream.finalize();
     #ifdef SK_PDF_BASE85_BINARY
     SkPDFUtils::Base85Encode(buffer.detachAsStream(), &buffer);
     #endif
     int length = SkToInt(buffer.bytesWritten());
     emit_image_stream(doc, ref, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
-                      pm.info().dimensions(), colorSpace, sMask, length, false);
+                      pm.info().dimensions(), colorSpace, sMask, length,
+                      deflateWStream.isValid() ? ImageFilter::kFlate : ImageFilter::kNone);
     if (!isOpaque) {
         do_deflated_alpha(pm, doc, sMask);
     }
@@ -218,7 +247,7 @@ static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
     emit_image_stream(doc, ref,
                       [&data](SkWStream* dst) { dst->write(data->data(), data->size()); },
                       jpegSize, yuv ? "DeviceRGB" : "DeviceGray",
-                      SkPDFIndirectReference(), SkToInt(data->size()), true);
+                      SkPDFIndirectReference(), SkToInt(data->size()), ImageFilter::kDCT);
     return true;
 }
 
@@ -275,14 +304,12 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     SkASSERT(img);
     SkASSERT(doc);
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
+    if (doc->executor()) {
         SkRef(img);
-        doc->incrementJobCount();
-        executor->add([img, encodingQuality, doc, ref]() {
+        doc->executeJob([img, encodingQuality, doc, ref]() {
             serialize_image(img, encodingQuality, doc, ref);
             SkSafeUnref(img);
-            doc->signalJobComplete();
-        });
+        }, img->imageInfo().computeMinByteSize());
         return ref;
     }
     serialize_image(img, encodingQuality, doc, ref);
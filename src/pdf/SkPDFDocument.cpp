@@ -8,6 +8,7 @@
 #include "include/docs/SkPDFDocument.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
 #include "include/private/SkTo.h"
@@ -20,6 +21,7 @@
 #include "src/pdf/SkPDFUtils.h"
 #include "src/utils/SkUTF.h"
 
+#include <algorithm>
 #include <utility>
 
 // For use in SkCanvas::drawAnnotation
@@ -135,68 +137,102 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     wStream->writeText("\n%%EOF");
 }
 
+// PDF wants a tree describing all the pages in the document.  We arbitrary
+// choose 8 (kMaxPageTreeNodeSize) as the number of allowed children.  The
+// internal nodes have type "Pages" with an array of children, a parent pointer,
+// and the number of leaves below the node as "Count."  The leaves have type
+// "Page" and need a parent pointer.
+static constexpr size_t kMaxPageTreeNodeSize = 8;
+
+namespace {
+struct PageTreeNode {
+    std::unique_ptr<SkPDFDict> fNode;
+    SkPDFIndirectReference fReservedRef;
+    int fPageObjectDescendantCount;
+
+    static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
+        std::vector<PageTreeNode> result;
+        const size_t n = vec.size();
+        SkASSERT(n >= 1);
+        const size_t result_len = (n - 1) / kMaxPageTreeNodeSize + 1;
+        SkASSERT(result_len >= 1);
+        SkASSERT(n == 1 || result_len < n);
+        result.reserve(result_len);
+        size_t index = 0;
+        for (size_t i = 0; i < result_len; ++i) {
+            if (n != 1 && index + 1 == n) {  // No need to create a new node.
+                result.push_back(std::move(vec[index++]));
+                continue;
+            }
+            SkPDFIndirectReference parent = doc->reserveRef();
+            auto kids_list = SkPDFMakeArray();
+            int descendantCount = 0;
+            for (size_t j = 0; j < kMaxPageTreeNodeSize && index < n; ++j) {
+                PageTreeNode& node = vec[index++];
+                node.fNode->insertRef("Parent", parent);
+                kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
+                descendantCount += node.fPageObjectDescendantCount;
+            }
+            auto next = SkPDFMakeDict("Pages");
+            next->insertInt("Count", descendantCount);
+            next->insertObject("Kids", std::move(kids_list));
+            result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
+        }
+        return result;
+    }
+};
+}  // namespace
+
+static SkPDFIndirectReference emit_page_tree(SkPDFDocument* doc,
+                                             std::vector<PageTreeNode> currentLayer) {
+    while (currentLayer.size() > 1) {
+        currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
+    }
+    SkASSERT(currentLayer.size() == 1);
+    const PageTreeNode& root = currentLayer[0];
+    return doc->emit(*root.fNode, root.fReservedRef);
+}
+
+// Builds the tree bottom up from the page dictionaries, skipping internal nodes
+// that would have only one child.
 static SkPDFIndirectReference generate_page_tree(
         SkPDFDocument* doc,
         std::vector<std::unique_ptr<SkPDFDict>> pages,
         const std::vector<SkPDFIndirectReference>& pageRefs) {
-    // PDF wants a tree describing all the pages in the document.  We arbitrary
-    // choose 8 (kNodeSize) as the number of allowed children.  The internal
-    // nodes have type "Pages" with an array of children, a parent pointer, and
-    // the number of leaves below the node as "Count."  The leaves are passed
-    // into the method, have type "Page" and need a parent pointer. This method
-    // builds the tree bottom up, skipping internal nodes that would have only
-    // one child.
     SkASSERT(pages.size() > 0);
-    struct PageTreeNode {
-        std::unique_ptr<SkPDFDict> fNode;
-        SkPDFIndirectReference fReservedRef;
-        int fPageObjectDescendantCount;
-
-        static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
-            std::vector<PageTreeNode> result;
-            static constexpr size_t kMaxNodeSize = 8;
-            const size_t n = vec.size();
-            SkASSERT(n >= 1);
-            const size_t result_len = (n - 1) / kMaxNodeSize + 1;
-            SkASSERT(result_len >= 1);
-            SkASSERT(n == 1 || result_len < n);
-            result.reserve(result_len);
-            size_t index = 0;
-            for (size_t i = 0; i < result_len; ++i) {
-                if (n != 1 && index + 1 == n) {  // No need to create a new node.
-                    result.push_back(std::move(vec[index++]));
-                    continue;
-                }
-                SkPDFIndirectReference parent = doc->reserveRef();
-                auto kids_list = SkPDFMakeArray();
-                int descendantCount = 0;
-                for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
-                    PageTreeNode& node = vec[index++];
-                    node.fNode->insertRef("Parent", parent);
-                    kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
-                    descendantCount += node.fPageObjectDescendantCount;
-                }
-                auto next = SkPDFMakeDict("Pages");
-                next->insertInt("Count", descendantCount);
-                next->insertObject("Kids", std::move(kids_list));
-                result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
-            }
-            return result;
-        }
-    };
     std::vector<PageTreeNode> currentLayer;
     currentLayer.reserve(pages.size());
     SkASSERT(pages.size() == pageRefs.size());
     for (size_t i = 0; i < pages.size(); ++i) {
         currentLayer.push_back(PageTreeNode{std::move(pages[i]), pageRefs[i], 1});
     }
-    currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
-    while (currentLayer.size() > 1) {
-        currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
+    return emit_page_tree(doc, PageTreeNode::Layer(std::move(currentLayer), doc));
+}
+
+// When streaming, pages are written as they end, pointing at a parent reserved
+// for every kMaxPageTreeNodeSize of them.  Write those parents and the rest of
+// the tree.
+static SkPDFIndirectReference generate_streamed_page_tree(
+        SkPDFDocument* doc,
+        const std::vector<SkPDFIndirectReference>& leafRefs,
+        const std::vector<SkPDFIndirectReference>& pageRefs) {
+    SkASSERT(pageRefs.size() > 0);
+    SkASSERT(leafRefs.size() == (pageRefs.size() - 1) / kMaxPageTreeNodeSize + 1);
+    std::vector<PageTreeNode> leaves;
+    leaves.reserve(leafRefs.size());
+    for (size_t i = 0; i < leafRefs.size(); ++i) {
+        size_t begin = i * kMaxPageTreeNodeSize;
+        size_t end = std::min(begin + kMaxPageTreeNodeSize, pageRefs.size());
+        auto kids_list = SkPDFMakeArray();
+        for (size_t j = begin; j < end; ++j) {
+            kids_list->appendRef(pageRefs[j]);
+        }
+        auto leaf = SkPDFMakeDict("Pages");
+        leaf->insertInt("Count", SkToInt(end - begin));
+        leaf->insertObject("Kids", std::move(kids_list));
+        leaves.push_back(PageTreeNode{std::move(leaf), leafRefs[i], SkToInt(end - begin)});
     }
-    SkASSERT(currentLayer.size() == 1);
-    const PageTreeNode& root = currentLayer[0];
-    return doc->emit(*root.fNode, root.fReservedRef);
+    return emit_page_tree(doc, std::move(leaves));
 }
 
 template<typename T, typename... Args>
@@ -228,27 +264,130 @@ SkPDFDocument::~SkPDFDocument() {
 }
 
 SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndirectReference ref){
-    SkAutoMutexExclusive lock(fMutex);
-    object.emitObject(this->beginObject(ref));
-    this->endObject();
+    this->emitObject(ref, [&object](SkWStream* stream) { object.emitObject(stream); });
     return ref;
 }
 
-SkWStream* SkPDFDocument::beginObject(SkPDFIndirectReference ref) SK_REQUIRES(fMutex) {
-    begin_indirect_object(&fOffsetMap, ref, this->getStream());
-    return this->getStream();
-};
+thread_local SkPDFDocument::Job* SkPDFDocument::gCurrentJob = nullptr;
 
-void SkPDFDocument::endObject() SK_REQUIRES(fMutex) {
-    end_indirect_object(this->getStream());
-};
+void SkPDFDocument::emitObject(SkPDFIndirectReference ref,
+                               const std::function<void(SkWStream*)>& writeObject) {
+    if (Job* job = gCurrentJob) {
+        job->fObjects.push_back(Job::Object{ref, {}});
+        writeObject(&job->fObjects.back().fData);
+        return;
+    }
+    SkAutoMutexExclusive lock(fMutex);
+    if (fJobs.empty()) {
+        begin_indirect_object(&fOffsetMap, ref, this->getStream());
+        writeObject(this->getStream());
+        end_indirect_object(this->getStream());
+        return;
+    }
+    // Earlier jobs are still running, so this object has to wait its turn behind them.
+    if (!fJobs.back()->fDone) {
+        fJobs.push_back(std::make_unique<Job>());
+        fJobs.back()->fDone = true;
+    }
+    Job* job = fJobs.back().get();
+    job->fObjects.push_back(Job::Object{ref, {}});
+    writeObject(&job->fObjects.back().fData);
+    size_t bytes = job->fObjects.back().fData.bytesWritten();
+    job->fBytes += bytes;
+    fJobBytes += bytes;
+}
+
+void SkPDFDocument::writeFinishedJobs() SK_REQUIRES(fMutex) {
+    SkWStream* stream = this->getStream();
+    while (!fJobs.empty() && fJobs.front()->fDone) {
+        for (Job::Object& object : fJobs.front()->fObjects) {
+            begin_indirect_object(&fOffsetMap, object.fRef, stream);
+            object.fData.writeToAndReset(stream);
+            end_indirect_object(stream);
+        }
+        fJobBytes -= fJobs.front()->fBytes;
+        fJobs.pop_front();
+    }
+}
+
+void SkPDFDocument::executeJob(std::function<void()> fn, size_t inputBytes) {
+    if (!fExecutor || gCurrentJob) {
+        fn();
+        return;
+    }
+    if (size_t limit = fMetadata.fStreamingMemoryLimit) {
+        // Let the executor catch up before handing it more.
+        auto overLimit = [&]() {
+            SkAutoMutexExclusive lock(fMutex);
+            return fJobBytes + inputBytes > limit;
+        };
+        while (fJobCount > 0 && overLimit()) {
+            fSemaphore.wait();
+            --fJobCount;
+        }
+    }
+    Job* job;
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        fJobs.push_back(std::make_unique<Job>());
+        job = fJobs.back().get();
+        job->fBytes = inputBytes;
+        fJobBytes += inputBytes;
+    }
+    fJobCount++;
+    fExecutor->add([this, job, fn = std::move(fn)]() {
+        // fn() may wait on a task group, which can run another PDF job on this thread
+        // in the meantime, so put back whatever job was current rather than clearing it.
+        Job* previousJob = gCurrentJob;
+        gCurrentJob = job;
+        fn();
+        gCurrentJob = previousJob;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            size_t outputBytes = 0;
+            for (const Job::Object& object : job->fObjects) {
+                outputBytes += object.fData.bytesWritten();
+            }
+            fJobBytes = fJobBytes - job->fBytes + outputBytes;
+            job->fBytes = outputBytes;
+            job->fDone = true;
+            this->writeFinishedJobs();
+        }
+        fSemaphore.signal();
+    });
+}
+
+size_t SkPDFDocument::resourceCacheBytes() const {
+    return fImageShaderMap.approxBytesUsed()
+         + fGradientPatternMap.approxBytesUsed()
+         + fPDFBitmapMap.approxBytesUsed()
+         + fStrokeGSMap.approxBytesUsed()
+         + fFillGSMap.approxBytesUsed();
+}
+
+size_t SkPDFDocument::approxBytesUsed() {
+    SkAutoMutexExclusive lock(fMutex);
+    return fJobBytes + this->resourceCacheBytes();
+}
+
+void SkPDFDocument::trimResourceCaches() {
+    // These only let later pages share objects earlier pages already wrote, so in streaming
+    // mode we can forget them whenever they get too big.
+    if (this->resourceCacheBytes() > fMetadata.fStreamingMemoryLimit) {
+        fImageShaderMap.reset();
+        fGradientPatternMap.reset();
+        fPDFBitmapMap.reset();
+        fStrokeGSMap.reset();
+        fFillGSMap.reset();
+    }
+}
 
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         // if this is the first page if the document.
         {
             SkAutoMutexExclusive autoMutexAcquire(fMutex);
@@ -375,7 +514,18 @@ void SkPDFDocument::onEndPage() {
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
-    fPages.emplace_back(std::move(page));
+    fFinishedPageCount++;
+
+    if (fMetadata.fStreamingMemoryLimit) {
+        if ((fPageRefs.size() - 1) % kMaxPageTreeNodeSize == 0) {
+            fPageTreeLeaves.push_back(this->reserveRef());
+        }
+        page->insertRef("Parent", fPageTreeLeaves.back());
+        this->emit(*page, fPageRefs.back());
+        this->trimResourceCaches();
+    } else {
+        fPages.emplace_back(std::move(page));
+    }
 }
 
 void SkPDFDocument::onAbort() {
@@ -547,7 +697,7 @@ static std::vector<const SkPDFFont*> get_fonts(const SkPDFDocument& canon) {
 
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         this->waitForJobs();
         return;
     }
@@ -560,7 +710,9 @@ void SkPDFDocument::onClose(SkWStream* stream) {
         docCatalog->insertObject("OutputIntents", make_srgb_output_intents(this));
     }
 
-    docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    docCatalog->insertRef("Pages", fMetadata.fStreamingMemoryLimit
+                                   ? generate_streamed_page_tree(this, fPageTreeLeaves, fPageRefs)
+                                   : generate_page_tree(this, std::move(fPages), fPageRefs));
 
     if (!fNamedDestinations.empty()) {
         docCatalog->insertRef("Dests", append_destinations(this, fNamedDestinations));
@@ -585,14 +737,11 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     this->waitForJobs();
     {
         SkAutoMutexExclusive autoMutexAcquire(fMutex);
+        SkASSERT(fJobs.empty());
         serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
     }
 }
 
-void SkPDFDocument::incrementJobCount() { fJobCount++; }
-
-void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
-
 void SkPDFDocument::waitForJobs() {
      // fJobCount can increase while we wait.
      while (fJobCount > 0) {
@@ -16,6 +16,8 @@
 #include "src/pdf/SkPDFTag.h"
 
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -101,13 +103,12 @@ public:
 
     template <typename T>
     void emitStream(const SkPDFDict& dict, T writeStream, SkPDFIndirectReference ref) {
-        SkAutoMutexExclusive lock(fMutex);
-        SkWStream* stream = this->beginObject(ref);
-        dict.emitObject(stream);
-        stream->writeText(" stream\n");
-        writeStream(stream);
-        stream->writeText("\nendstream");
-        this->endObject();
+        this->emitObject(ref, [&](SkWStream* stream) {
+            dict.emitObject(stream);
+            stream->writeText(" stream\n");
+            writeStream(stream);
+            stream->writeText("\nendstream");
+        });
     }
 
     const SkPDF::Metadata& metadata() const { return fMetadata; }
@@ -130,9 +131,23 @@ public:
     SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
 
     SkExecutor* executor() const { return fExecutor; }
-    void incrementJobCount();
-    void signalJobComplete();
-    size_t currentPageIndex() { return fPages.size(); }
+
+    /** Run fn on the executor, or right away if there is no executor or we are already
+        inside a job.  Objects emitted by fn are written to the document stream in the order
+        executeJob() was called, interleaved with objects emitted by the caller exactly as if
+        fn had run inline, so the output does not depend on which job finishes first.
+        References fn reserves for itself are the exception; prefer reserving them up front.
+
+        inputBytes estimates the memory fn holds on to until it runs.  In streaming mode we
+        wait for earlier jobs rather than go over Metadata::fStreamingMemoryLimit.
+     */
+    void executeJob(std::function<void()> fn, size_t inputBytes);
+
+    /** The bytes held by jobs not yet written out, and by the canonicalized resources that
+        streaming mode forgets once they pass Metadata::fStreamingMemoryLimit. */
+    size_t approxBytesUsed();
+
+    size_t currentPageIndex() { return fFinishedPageCount; }
     size_t pageCount() { return fPageRefs.size(); }
 
     const SkMatrix& currentPageTransform() const;
@@ -160,6 +175,8 @@ private:
     SkCanvas fCanvas;
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
+    std::vector<SkPDFIndirectReference> fPageTreeLeaves;  // streaming mode only
+    size_t fFinishedPageCount = 0;
 
     sk_sp<SkPDFDevice> fPageDevice;
     std::atomic<int> fNextObjectNumber = {1};
@@ -178,9 +195,26 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
+    // Objects emitted by one job, or by the caller while earlier jobs are still running.
+    // They are held here until every job started before them has been written out.
+    struct Job {
+        struct Object {
+            SkPDFIndirectReference fRef;
+            SkDynamicMemoryWStream fData;
+        };
+        std::vector<Object> fObjects;
+        size_t fBytes = 0;  // inputBytes until the job is done, then the size of fObjects
+        bool fDone = false;
+    };
+    std::deque<std::unique_ptr<Job>> fJobs SK_GUARDED_BY(fMutex);
+    size_t fJobBytes SK_GUARDED_BY(fMutex) = 0;  // sum of fJobs' fBytes
+    static thread_local Job* gCurrentJob;
+
     void waitForJobs();
-    SkWStream* beginObject(SkPDFIndirectReference);
-    void endObject();
+    void emitObject(SkPDFIndirectReference, const std::function<void(SkWStream*)>&);
+    void writeFinishedJobs();
+    size_t resourceCacheBytes() const;
+    void trimResourceCaches();
 };
 
 #endif  // SkPDFDocumentPriv_DEFINED
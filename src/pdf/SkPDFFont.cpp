@@ -280,6 +280,34 @@ static sk_sp<SkData> stream_to_data(std::unique_ptr<SkStreamAsset> stream) {
     return SkData::MakeFromStream(stream.get(), size);
 }
 
+// Subsetting is the slow part of embedding a font, so run it as a document job.
+static SkPDFIndirectReference emit_subset_font_file(const SkPDFFont& font,
+                                                    const SkAdvancedTypefaceMetrics& metrics,
+                                                    std::unique_ptr<SkStreamAsset> fontAsset,
+                                                    int ttcIndex,
+                                                    SkPDFDocument* doc) {
+    SkPDFIndirectReference ref = doc->reserveRef();
+    // Fonts and their metrics live as long as the document, which waits for its jobs.
+    const SkPDFFont* fontPtr = &font;
+    const SkAdvancedTypefaceMetrics* metricsPtr = &metrics;
+    size_t fontSize = fontAsset->getLength();
+    SkStreamAsset* fontAssetPtr = fontAsset.release();
+    doc->executeJob([fontPtr, metricsPtr, fontAssetPtr, ttcIndex, doc, ref]() {
+        sk_sp<SkData> fontData = stream_to_data(std::unique_ptr<SkStreamAsset>(fontAssetPtr));
+        sk_sp<SkData> subsetFontData = SkPDFSubsetFont(fontData, fontPtr->glyphUsage(),
+                                                       doc->metadata().fSubsetter,
+                                                       metricsPtr->fFontName.c_str(), ttcIndex);
+        // If subsetting fails, fall back to original font data.
+        if (subsetFontData) {
+            fontData = std::move(subsetFontData);
+        }
+        std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
+        tmp->insertInt("Length1", SkToInt(fontData->size()));
+        SkPDFStreamOut(std::move(tmp), SkMemoryStream::Make(std::move(fontData)), doc, true, ref);
+    }, fontSize);
+    return ref;
+}
+
 static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     const SkAdvancedTypefaceMetrics* metricsPtr =
         SkPDFFont::GetMetrics(font.typeface(), doc);
@@ -308,25 +336,11 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
                 if (!SkToBool(metrics.fFlags &
                               SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag)) {
                     SkASSERT(font.firstGlyphID() == 1);
-                    sk_sp<SkData> subsetFontData = SkPDFSubsetFont(
-                            stream_to_data(std::move(fontAsset)), font.glyphUsage(),
-                            doc->metadata().fSubsetter,
-                            metrics.fFontName.c_str(), ttcIndex);
-                    if (subsetFontData) {
-                        std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
-                        tmp->insertInt("Length1", SkToInt(subsetFontData->size()));
-                        descriptor->insertRef(
-                                "FontFile2",
-                                SkPDFStreamOut(std::move(tmp),
-                                               SkMemoryStream::Make(std::move(subsetFontData)),
-                                               doc, true));
-                        break;
-                    }
-                    // If subsetting fails, fall back to original font data.
-                    fontAsset = face->openStream(&ttcIndex);
-                    SkASSERT(fontAsset);
-                    SkASSERT(fontAsset->getLength() == fontSize);
-                    if (!fontAsset || fontAsset->getLength() == 0) { break; }
+                    descriptor->insertRef("FontFile2",
+                                          emit_subset_font_file(font, metrics,
+                                                                std::move(fontAsset),
+                                                                ttcIndex, doc));
+                    break;
                 }
                 std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                 tmp->insertInt("Length1", fontSize);
@@ -8,7 +8,6 @@
 #include "src/pdf/SkPDFTypes.h"
 
 #include "include/core/SkData.h"
-#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkStreamPriv.h"
@@ -435,7 +434,8 @@ static void serialize_stream(SkPDFDict* origDict,
     static const size_t kMinimumSavings = strlen("/Filter_/FlateDecode_");
     if (deflate && stream->getLength() > kMinimumSavings) {
         SkDynamicMemoryWStream compressedData;
-        SkDeflateWStream deflateWStream(&compressedData);
+        SkDeflateWStream deflateWStream(&compressedData,
+                                        SkToInt(doc->metadata().fCompressionLevel));
         SkStreamCopy(&deflateWStream, stream);
         deflateWStream.finalize();
         #ifdef SK_PDF_BASE85_BINARY
@@ -469,19 +469,27 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       std::unique_ptr<SkStreamAsset> content,
                                       SkPDFDocument* doc,
                                       bool deflate) {
-    SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
+    return SkPDFStreamOut(std::move(dict), std::move(content), doc, deflate, doc->reserveRef());
+}
+
+SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
+                                      std::unique_ptr<SkStreamAsset> content,
+                                      SkPDFDocument* doc,
+                                      bool deflate,
+                                      SkPDFIndirectReference ref) {
+    if (doc->metadata().fCompressionLevel == SkPDF::Metadata::CompressionLevel::None) {
+        deflate = false;
+    }
+    if (doc->executor()) {
         SkPDFDict* dictPtr = dict.release();
         SkStreamAsset* contentPtr = content.release();
         // Pass ownership of both pointers into a std::function, which should
         // only be executed once.
-        doc->incrementJobCount();
-        executor->add([dictPtr, contentPtr, deflate, doc, ref]() {
+        doc->executeJob([dictPtr, contentPtr, deflate, doc, ref]() {
             serialize_stream(dictPtr, contentPtr, deflate, doc, ref);
             delete dictPtr;
             delete contentPtr;
-            doc->signalJobComplete();
-        });
+        }, contentPtr->getLength());
         return ref;
     }
     serialize_stream(dict.get(), content.get(), deflate, doc, ref);
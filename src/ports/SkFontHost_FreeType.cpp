@@ -15,6 +15,7 @@
 #include "include/private/SkColorData.h"
 #include "include/private/SkMalloc.h"
 #include "include/private/SkMutex.h"
+#include "include/private/SkTArray.h"
 #include "include/private/SkTemplates.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkAdvancedTypefaceMetrics.h"
@@ -133,6 +134,7 @@ public:
         , fLibrary(nullptr)
         , fIsLCDSupported(false)
         , fLightHintingIsYOnly(false)
+        , fFacesAreIndependent(false)
         , fLCDExtra(0)
     {
         if (FT_New_Library(&gFTMemory, &fLibrary)) {
@@ -180,6 +182,15 @@ public:
         }
 #endif
 
+// Faces of one library may be used on different threads at once starting in 2.5.6.
+#if SK_FREETYPE_MINIMUM_RUNTIME_VERSION >= 0x02050600
+        fFacesAreIndependent = true;
+#else
+        if (major > 2 || ((major == 2 && minor > 5) || (major == 2 && minor == 5 && patch >= 6))) {
+            fFacesAreIndependent = true;
+        }
+#endif
+
 // The 'light' hinting is vertical only starting in 2.8.0.
 #if SK_FREETYPE_MINIMUM_RUNTIME_VERSION >= 0x02080000
         fLightHintingIsYOnly = true;
@@ -220,6 +231,7 @@ public:
     bool isLCDSupported() { return fIsLCDSupported; }
     int lcdExtra() { return fLCDExtra; }
     bool lightHintingIsYOnly() { return fLightHintingIsYOnly; }
+    bool facesAreIndependent() { return fFacesAreIndependent; }
 
     // FT_Get_{MM,Var}_{Blend,Design}_Coordinates were added in FreeType 2.7.1.
     // Prior to this there was no way to get the coordinates out of the FT_Face.
@@ -238,6 +250,7 @@ private:
     FT_Library fLibrary;
     bool fIsLCDSupported;
     bool fLightHintingIsYOnly;
+    bool fFacesAreIndependent;
     int fLCDExtra;
 
     // FT_Library_SetLcdFilterWeights was introduced in FreeType 2.4.0.
@@ -297,13 +310,31 @@ static void unref_ft_library() {
 
 ///////////////////////////////////////////////////////////////////////////
 
+#ifndef SK_FREETYPE_FACES_PER_FONT
+    #define SK_FREETYPE_FACES_PER_FONT 4
+#endif
+static_assert(SK_FREETYPE_FACES_PER_FONT >= 1, "");
+
 struct SkFaceRec {
+    // An FT_Face may only be used by one thread at a time. So that scaler contexts of the same
+    // font can generate glyphs concurrently, a font in memory is opened up to
+    // SK_FREETYPE_FACES_PER_FONT times, and each scaler context sticks to one of these faces.
+    struct Face {
+        SkUniqueFTFace fFTFace;
+        SkMutex fMutex;
+        int fScalerCount = 0;  // Guarded by f_t_mutex().
+    };
+
     SkFaceRec* fNext;
-    SkUniqueFTFace fFace;
+    // The first face is opened with the SkFaceRec. The rest are opened as needed, and never move
+    // once opened, so the first may be used without holding f_t_mutex().
+    std::unique_ptr<Face> fFaces[SK_FREETYPE_FACES_PER_FONT];
+    int fFaceCount = 0;  // Guarded by f_t_mutex().
     FT_StreamRec fFTStream;
     std::unique_ptr<SkStreamAsset> fSkStream;
     uint32_t fRefCnt;
     uint32_t fFontID;
+    int fFaceIndex;
 
     // FreeType prior to 2.7.1 does not implement retreiving variation design metrics.
     // Cache the variation design metrics used to create the font if the user specifies them.
@@ -315,7 +346,9 @@ struct SkFaceRec {
     // Manually keep track of when a named variation is requested for 2.6.1 until 2.7.1.
     bool fNamedVariationSpecified;
 
-    SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID);
+    SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID, int faceIndex);
+
+    FT_Face face() const { return fFaces[0]->fFTFace.get(); }
 };
 
 extern "C" {
@@ -338,9 +371,9 @@ extern "C" {
     static void sk_ft_stream_close(FT_Stream) {}
 }
 
-SkFaceRec::SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID)
+SkFaceRec::SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID, int faceIndex)
         : fNext(nullptr), fSkStream(std::move(stream)), fRefCnt(1), fFontID(fontID)
-        , fAxesCount(0), fNamedVariationSpecified(false)
+        , fFaceIndex(faceIndex), fAxesCount(0), fNamedVariationSpecified(false)
 {
     sk_bzero(&fFTStream, sizeof(fFTStream));
     fFTStream.size = fSkStream->getLength();
@@ -350,7 +383,7 @@ SkFaceRec::SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID)
 }
 
 static void ft_face_setup_axes(SkFaceRec* rec, const SkFontData& data) {
-    if (!(rec->fFace->face_flags & FT_FACE_FLAG_MULTIPLE_MASTERS)) {
+    if (!(rec->face()->face_flags & FT_FACE_FLAG_MULTIPLE_MASTERS)) {
         return;
     }
 
@@ -362,16 +395,16 @@ static void ft_face_setup_axes(SkFaceRec* rec, const SkFontData& data) {
 
     SkDEBUGCODE(
         FT_MM_Var* variations = nullptr;
-        if (FT_Get_MM_Var(rec->fFace.get(), &variations)) {
+        if (FT_Get_MM_Var(rec->face(), &variations)) {
             LOG_INFO("INFO: font %s claims variations, but none found.\n",
-                     rec->fFace->family_name);
+                     rec->face()->family_name);
             return;
         }
         SkAutoFree autoFreeVariations(variations);
 
         if (static_cast<FT_UInt>(data.getAxisCount()) != variations->num_axis) {
             LOG_INFO("INFO: font %s has %d variations, but %d were specified.\n",
-                     rec->fFace->family_name, variations->num_axis, data.getAxisCount());
+                     rec->face()->family_name, variations->num_axis, data.getAxisCount());
             return;
         }
     )
@@ -380,9 +413,9 @@ static void ft_face_setup_axes(SkFaceRec* rec, const SkFontData& data) {
     for (int i = 0; i < data.getAxisCount(); ++i) {
         coords[i] = data.getAxis()[i];
     }
-    if (FT_Set_Var_Design_Coordinates(rec->fFace.get(), data.getAxisCount(), coords.get())) {
+    if (FT_Set_Var_Design_Coordinates(rec->face(), data.getAxisCount(), coords.get())) {
         LOG_INFO("INFO: font %s has variations, but specified variations could not be set.\n",
-                 rec->fFace->family_name);
+                 rec->face()->family_name);
         return;
     }
 
@@ -393,29 +426,11 @@ static void ft_face_setup_axes(SkFaceRec* rec, const SkFontData& data) {
     }
 }
 
-// Will return nullptr on failure
+// Opens rec's font once more, adding a face to rec->fFaces. Returns false on failure.
 // Caller must lock f_t_mutex() before calling this function.
-static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
+static bool open_ft_face(SkFaceRec* rec) {
     f_t_mutex().assertHeld();
 
-    const SkFontID fontID = typeface->uniqueID();
-    SkFaceRec* cachedRec = gFaceRecHead;
-    while (cachedRec) {
-        if (cachedRec->fFontID == fontID) {
-            SkASSERT(cachedRec->fFace);
-            cachedRec->fRefCnt += 1;
-            return cachedRec;
-        }
-        cachedRec = cachedRec->fNext;
-    }
-
-    std::unique_ptr<SkFontData> data = typeface->makeFontData();
-    if (nullptr == data || !data->hasStream()) {
-        return nullptr;
-    }
-
-    std::unique_ptr<SkFaceRec> rec(new SkFaceRec(data->detachStream(), fontID));
-
     FT_Open_Args args;
     memset(&args, 0, sizeof(args));
     const void* memoryBase = rec->fSkStream->getMemoryBase();
@@ -428,18 +443,23 @@ static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
         args.stream = &rec->fFTStream;
     }
 
-    {
-        FT_Face rawFace;
-        FT_Error err = FT_Open_Face(gFTLibrary->library(), &args, data->getIndex(), &rawFace);
-        if (err) {
-            SK_TRACEFTR(err, "unable to open font '%x'", fontID);
-            return nullptr;
-        }
-        rec->fFace.reset(rawFace);
+    FT_Face rawFace;
+    FT_Error err = FT_Open_Face(gFTLibrary->library(), &args, rec->fFaceIndex, &rawFace);
+    if (err) {
+        SK_TRACEFTR(err, "unable to open font '%x'", rec->fFontID);
+        return false;
     }
-    SkASSERT(rec->fFace);
+    auto face = std::make_unique<SkFaceRec::Face>();
+    face->fFTFace.reset(rawFace);
 
-    ft_face_setup_axes(rec.get(), *data);
+    // The first face sets up the variation axes; later ones copy what it managed to set.
+    if (rec->fAxesCount > 0) {
+        SkAutoSTMalloc<4, FT_Fixed> coords(rec->fAxesCount);
+        for (int i = 0; i < rec->fAxesCount; ++i) {
+            coords[i] = rec->fAxes[i];
+        }
+        FT_Set_Var_Design_Coordinates(rawFace, rec->fAxesCount, coords.get());
+    }
 
     // FreeType will set the charmap to the "most unicode" cmap if it exists.
     // If there are no unicode cmaps, the charmap is set to nullptr.
@@ -447,10 +467,44 @@ static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
     // because they are effectively private use area only (even if they aren't).
     // This is the last on the fallback list at
     // https://developer.apple.com/fonts/TrueType-Reference-Manual/RM06/Chap6cmap.html
-    if (!rec->fFace->charmap) {
-        FT_Select_Charmap(rec->fFace.get(), FT_ENCODING_MS_SYMBOL);
+    if (!rawFace->charmap) {
+        FT_Select_Charmap(rawFace, FT_ENCODING_MS_SYMBOL);
+    }
+
+    SkASSERT(rec->fFaceCount < SK_FREETYPE_FACES_PER_FONT);
+    rec->fFaces[rec->fFaceCount++] = std::move(face);
+    return true;
+}
+
+// Will return nullptr on failure
+// Caller must lock f_t_mutex() before calling this function.
+static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
+    f_t_mutex().assertHeld();
+
+    const SkFontID fontID = typeface->uniqueID();
+    SkFaceRec* cachedRec = gFaceRecHead;
+    while (cachedRec) {
+        if (cachedRec->fFontID == fontID) {
+            SkASSERT(cachedRec->fFaceCount > 0);
+            cachedRec->fRefCnt += 1;
+            return cachedRec;
+        }
+        cachedRec = cachedRec->fNext;
+    }
+
+    std::unique_ptr<SkFontData> data = typeface->makeFontData();
+    if (nullptr == data || !data->hasStream()) {
+        return nullptr;
     }
 
+    std::unique_ptr<SkFaceRec> rec(
+            new SkFaceRec(data->detachStream(), fontID, data->getIndex()));
+    if (!open_ft_face(rec.get())) {
+        return nullptr;
+    }
+
+    ft_face_setup_axes(rec.get(), *data);
+
     rec->fNext = gFaceRecHead;
     gFaceRecHead = rec.get();
     return rec.release();
@@ -465,7 +519,7 @@ extern /*static*/ void unref_ft_face(SkFaceRec* faceRec) {
     SkFaceRec*  prev = nullptr;
     while (rec) {
         SkFaceRec* next = rec->fNext;
-        if (rec->fFace == faceRec->fFace) {
+        if (rec == faceRec) {
             if (--rec->fRefCnt == 0) {
                 if (prev) {
                     prev->fNext = next;
@@ -482,23 +536,68 @@ extern /*static*/ void unref_ft_face(SkFaceRec* faceRec) {
     SkDEBUGFAIL("shouldn't get here, face not in list");
 }
 
+// Picks the face of rec for a new scaler context to use, preferring one no other scaler context
+// uses, and opening another if all are in use. Fonts read from streams are opened just once, as
+// the faces would share the stream's position.
+// Caller must lock f_t_mutex() before calling this function.
+static SkFaceRec::Face* acquire_ft_face(SkFaceRec* rec) {
+    f_t_mutex().assertHeld();
+
+    SkFaceRec::Face* face = rec->fFaces[0].get();
+    for (int i = 1; i < rec->fFaceCount; ++i) {
+        if (rec->fFaces[i]->fScalerCount < face->fScalerCount) {
+            face = rec->fFaces[i].get();
+        }
+    }
+    if (face->fScalerCount > 0 &&
+        rec->fFaceCount < SK_FREETYPE_FACES_PER_FONT &&
+        rec->fSkStream->getMemoryBase() != nullptr &&
+        gFTLibrary->facesAreIndependent() &&
+        open_ft_face(rec)) {
+        face = rec->fFaces[rec->fFaceCount - 1].get();
+    }
+    face->fScalerCount += 1;
+    return face;
+}
+
+// Caller must lock f_t_mutex() before calling this function.
+static void release_ft_face(SkFaceRec::Face* face) {
+    f_t_mutex().assertHeld();
+    SkASSERT(face->fScalerCount > 0);
+    face->fScalerCount -= 1;
+}
+
+// The lock to hold while using face. Before FreeType 2.5.6 faces of the same library could not be
+// used concurrently, so they all share f_t_mutex().
+static SkMutex& face_mutex(SkFaceRec::Face* face) {
+    return gFTLibrary->facesAreIndependent() ? face->fMutex : f_t_mutex();
+}
+
 class AutoFTAccess {
 public:
     AutoFTAccess(const SkTypeface_FreeType* tf) : fFaceRec(nullptr) {
-        f_t_mutex().acquire();
-        SkASSERT_RELEASE(ref_ft_library());
-        fFaceRec = ref_ft_face(tf);
+        {
+            SkAutoMutexExclusive ac(f_t_mutex());
+            SkASSERT_RELEASE(ref_ft_library());
+            fFaceRec = ref_ft_face(tf);
+        }
+        if (fFaceRec) {
+            face_mutex(fFaceRec->fFaces[0].get()).acquire();
+        }
     }
 
     ~AutoFTAccess() {
+        if (fFaceRec) {
+            face_mutex(fFaceRec->fFaces[0].get()).release();
+        }
+        SkAutoMutexExclusive ac(f_t_mutex());
         if (fFaceRec) {
             unref_ft_face(fFaceRec);
         }
         unref_ft_library();
-        f_t_mutex().release();
     }
 
-    FT_Face face() { return fFaceRec ? fFaceRec->fFace.get() : nullptr; }
+    FT_Face face() { return fFaceRec ? fFaceRec->face() : nullptr; }
     int getAxesCount() { return fFaceRec ? fFaceRec->fAxesCount : 0; }
     SkFixed* getAxes() { return fFaceRec ? fFaceRec->fAxes.get() : nullptr; }
     bool isNamedVariationSpecified() {
@@ -534,7 +633,8 @@ private:
     using UnrefFTFace = SkFunctionWrapper<decltype(unref_ft_face), unref_ft_face>;
     std::unique_ptr<SkFaceRec, UnrefFTFace> fFaceRec;
 
-    FT_Face   fFace;  // Borrowed face from gFaceRecHead.
+    SkFaceRec::Face* fSharedFace;  // The face of fFaceRec we use, maybe with other scalers.
+    FT_Face   fFace;  // Borrowed from fSharedFace, used under face_mutex(fSharedFace).
     FT_Size   fFTSize;  // The size on the fFace for this scaler.
     FT_Int    fStrikeIndex;
 
@@ -556,9 +656,8 @@ private:
     void getBBoxForCurrentGlyph(const SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock f_t_mutex() before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock face_mutex(fSharedFace) before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph, SkGlyphID gid);
     bool shouldSubpixelBitmap(const SkGlyph&, const SkMatrix&);
@@ -862,14 +961,20 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
                                                    const SkScalerContextEffects& effects,
                                                    const SkDescriptor* desc)
     : SkScalerContext_FreeType_Base(std::move(typeface), effects, desc)
+    , fSharedFace(nullptr)
     , fFace(nullptr)
     , fFTSize(nullptr)
     , fStrikeIndex(-1)
 {
-    SkAutoMutexExclusive  ac(f_t_mutex());
-    SkASSERT_RELEASE(ref_ft_library());
+    {
+        SkAutoMutexExclusive  ac(f_t_mutex());
+        SkASSERT_RELEASE(ref_ft_library());
 
-    fFaceRec.reset(ref_ft_face(static_cast<SkTypeface_FreeType*>(this->getTypeface())));
+        fFaceRec.reset(ref_ft_face(static_cast<SkTypeface_FreeType*>(this->getTypeface())));
+        if (fFaceRec) {
+            fSharedFace = acquire_ft_face(fFaceRec.get());
+        }
+    }
 
     // load the font file
     if (nullptr == fFaceRec) {
@@ -877,6 +982,9 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
         return;
     }
 
+    SkAutoMutexExclusive  ac(face_mutex(fSharedFace));
+    FT_Face face = fSharedFace->fFTFace.get();
+
     fLCDIsVert = SkToBool(fRec.fFlags & SkScalerContext::kLCD_Vertical_Flag);
 
     // compute the flags we send to Load_Glyph
@@ -950,11 +1058,11 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
     }
 
     using DoneFTSize = SkFunctionWrapper<decltype(FT_Done_Size), FT_Done_Size>;
-    std::unique_ptr<std::remove_pointer_t<FT_Size>, DoneFTSize> ftSize([this]() -> FT_Size {
+    std::unique_ptr<std::remove_pointer_t<FT_Size>, DoneFTSize> ftSize([face]() -> FT_Size {
         FT_Size size;
-        FT_Error err = FT_New_Size(fFaceRec->fFace.get(), &size);
+        FT_Error err = FT_New_Size(face, &size);
         if (err != 0) {
-            SK_TRACEFTR(err, "FT_New_Size(%s) failed.", fFaceRec->fFace->family_name);
+            SK_TRACEFTR(err, "FT_New_Size(%s) failed.", face->family_name);
             return nullptr;
         }
         return size;
@@ -966,7 +1074,7 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
 
     FT_Error err = FT_Activate_Size(ftSize.get());
     if (err != 0) {
-        SK_TRACEFTR(err, "FT_Activate_Size(%s) failed.", fFaceRec->fFace->family_name);
+        SK_TRACEFTR(err, "FT_Activate_Size(%s) failed.", face->family_name);
         return;
     }
 
@@ -974,11 +1082,11 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
     FT_F26Dot6 scaleX = SkScalarToFDot6(fScale.fX);
     FT_F26Dot6 scaleY = SkScalarToFDot6(fScale.fY);
 
-    if (FT_IS_SCALABLE(fFaceRec->fFace)) {
-        err = FT_Set_Char_Size(fFaceRec->fFace.get(), scaleX, scaleY, 72, 72);
+    if (FT_IS_SCALABLE(face)) {
+        err = FT_Set_Char_Size(face, scaleX, scaleY, 72, 72);
         if (err != 0) {
             SK_TRACEFTR(err, "FT_Set_CharSize(%s, %f, %f) failed.",
-                        fFaceRec->fFace->family_name, fScale.fX, fScale.fY);
+                        face->family_name, fScale.fX, fScale.fY);
             return;
         }
 
@@ -986,33 +1094,33 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
         // FreeType currently does not allow requesting sizes less than 1, this allow for scaling.
         // Don't do this at all sizes as that will interfere with hinting.
         if (fScale.fX < 1 || fScale.fY < 1) {
-            SkScalar upem = fFaceRec->fFace->units_per_EM;
-            FT_Size_Metrics& ftmetrics = fFaceRec->fFace->size->metrics;
+            SkScalar upem = face->units_per_EM;
+            FT_Size_Metrics& ftmetrics = face->size->metrics;
             SkScalar x_ppem = upem * SkFT_FixedToScalar(ftmetrics.x_scale) / 64.0f;
             SkScalar y_ppem = upem * SkFT_FixedToScalar(ftmetrics.y_scale) / 64.0f;
             fMatrix22Scalar.preScale(fScale.x() / x_ppem, fScale.y() / y_ppem);
         }
 
-    } else if (FT_HAS_FIXED_SIZES(fFaceRec->fFace)) {
-        fStrikeIndex = chooseBitmapStrike(fFaceRec->fFace.get(), scaleY);
+    } else if (FT_HAS_FIXED_SIZES(face)) {
+        fStrikeIndex = chooseBitmapStrike(face, scaleY);
         if (fStrikeIndex == -1) {
             LOG_INFO("No glyphs for font \"%s\" size %f.\n",
-                     fFaceRec->fFace->family_name, fScale.fY);
+                     face->family_name, fScale.fY);
             return;
         }
 
-        err = FT_Select_Size(fFaceRec->fFace.get(), fStrikeIndex);
+        err = FT_Select_Size(face, fStrikeIndex);
         if (err != 0) {
             SK_TRACEFTR(err, "FT_Select_Size(%s, %d) failed.",
-                        fFaceRec->fFace->family_name, fStrikeIndex);
+                        face->family_name, fStrikeIndex);
             fStrikeIndex = -1;
             return;
         }
 
         // Adjust the matrix to reflect the actually chosen scale.
         // It is likely that the ppem chosen was not the one requested, this allows for scaling.
-        fMatrix22Scalar.preScale(fScale.x() / fFaceRec->fFace->size->metrics.x_ppem,
-                                 fScale.y() / fFaceRec->fFace->size->metrics.y_ppem);
+        fMatrix22Scalar.preScale(fScale.x() / face->size->metrics.x_ppem,
+                                 fScale.y() / face->size->metrics.y_ppem);
 
         // FreeType does not provide linear metrics for bitmap fonts.
         linearMetrics = false;
@@ -1025,7 +1133,7 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
         // Force this flag off for bitmap only fonts.
         fLoadGlyphFlags &= ~FT_LOAD_NO_BITMAP;
     } else {
-        LOG_INFO("Unknown kind of font \"%s\" size %f.\n", fFaceRec->fFace->family_name, fScale.fY);
+        LOG_INFO("Unknown kind of font \"%s\" size %f.\n", face->family_name, fScale.fY);
         return;
     }
 
@@ -1035,21 +1143,25 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
     fMatrix22.yy = SkScalarToFixed(fMatrix22Scalar.getScaleY());
 
 #ifdef FT_COLOR_H
-    FT_Palette_Select(fFaceRec->fFace.get(), 0, nullptr);
+    FT_Palette_Select(face, 0, nullptr);
 #endif
 
     fFTSize = ftSize.release();
-    fFace = fFaceRec->fFace.get();
+    fFace = face;
     fDoLinearMetrics = linearMetrics;
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
-    SkAutoMutexExclusive  ac(f_t_mutex());
-
     if (fFTSize != nullptr) {
+        SkAutoMutexExclusive  ac(face_mutex(fSharedFace));
         FT_Done_Size(fFTSize);
     }
 
+    SkAutoMutexExclusive  ac(f_t_mutex());
+
+    if (fSharedFace != nullptr) {
+        release_ft_face(fSharedFace);
+    }
     fFaceRec = nullptr;
 
     unref_ft_library();
@@ -1059,7 +1171,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     this face with other context (at different sizes).
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    f_t_mutex().assertHeld();
+    face_mutex(fSharedFace).assertHeld();
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         return err;
@@ -1080,7 +1192,7 @@ bool SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
         return false;
     }
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(face_mutex(fSharedFace));
 
     if (this->setupSize()) {
         glyph->zeroMetrics();
@@ -1185,7 +1297,7 @@ bool SkScalerContext_FreeType::shouldSubpixelBitmap(const SkGlyph& glyph, const
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(face_mutex(fSharedFace));
 
     glyph->fMaskFormat = fRec.fMaskFormat;
 
@@ -1337,7 +1449,7 @@ void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(face_mutex(fSharedFace));
 
     if (this->setupSize()) {
         sk_bzero(glyph.fImage, glyph.imageSize());
@@ -1370,7 +1482,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 bool SkScalerContext_FreeType::generatePath(SkGlyphID glyphID, SkPath* path) {
     SkASSERT(path);
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(face_mutex(fSharedFace));
 
     // FT_IS_SCALABLE is documented to mean the face contains outline glyphs.
     if (!FT_IS_SCALABLE(fFace) || this->setupSize()) {
@@ -1411,7 +1523,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkFontMetrics* metrics) {
         return;
     }
 
-    SkAutoMutexExclusive ac(f_t_mutex());
+    SkAutoMutexExclusive ac(face_mutex(fSharedFace));
 
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
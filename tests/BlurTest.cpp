@@ -32,9 +32,11 @@
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/private/SkFloatBits.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkBlurPriv.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkMathPriv.h"
 #include "src/effects/SkEmbossMaskFilter.h"
@@ -46,6 +48,7 @@
 #include <string.h>
 #include <initializer_list>
 #include <utility>
+#include <vector>
 
 #define WRITE_CSV 0
 
@@ -743,3 +746,99 @@ DEF_TEST(zero_blur, reporter) {
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
 
+
+// A scalar implementation of SkMaskBlurFilter's three pass box blur of one line, as it was before
+// it blurred sixteen lines at a time.
+static std::vector<uint8_t> box_blur_line(int window, const std::vector<uint8_t>& src) {
+    int border = (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
+    int srcW = (int)src.size(),
+        dstW = srcW + 2 * border;
+    int noChangeCount = std::max(0, 2 * border + 1 - srcW);
+    uint64_t divisor = (window & 1) == 1 ? window * window * window
+                                         : window * window * (window + 1);
+    uint64_t weight = (uint64_t)round(1.0 / divisor * (1ull << 32));
+
+    std::vector<uint8_t> dst(dstW);
+    auto run = [&](auto srcAt, auto dstAt, int count) {
+        std::vector<uint32_t> b0(window - 1), b1(window - 1),
+                              b2((window & 1) == 1 ? window - 1 : window);
+        uint32_t sum0 = 0, sum1 = 0, sum2 = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t leadingEdge = srcAt(i);
+            sum0 += leadingEdge;
+            sum1 += sum0;
+            sum2 += sum1;
+            dst[dstAt(i)] = (uint8_t)((weight * sum2 + (1ull << 31)) >> 32);
+            sum2 -= b2[i % b2.size()]; b2[i % b2.size()] = sum1;
+            sum1 -= b1[i % b1.size()]; b1[i % b1.size()] = sum0;
+            sum0 -= b0[i % b0.size()]; b0[i % b0.size()] = leadingEdge;
+        }
+    };
+    int forward = std::min(dstW, srcW + noChangeCount);
+    run([&](int i) { return i < srcW ? src[i] : 0; }, [](int i) { return i; }, forward);
+    run([&](int i) { return src[srcW - 1 - i]; }, [&](int i) { return dstW - 1 - i; },
+        dstW - forward);
+    return dst;
+}
+
+DEF_TEST(BlurMaskFilter_LargeSigma, reporter) {
+    SkRandom rand;
+    for (SkISize size : {SkISize{1, 1}, SkISize{17, 5}, SkISize{40, 33}, SkISize{100, 16}}) {
+        for (double sigma : {2.0, 7.5, 40.0}) {
+            int w = size.width(),
+                h = size.height();
+            std::vector<uint8_t> a8(w * h);
+            for (auto& v : a8) {
+                v = rand.nextBool() ? 0xFF : rand.nextU() & 0xFF;
+            }
+
+            // Blur the same coverage from A8 and ARGB32 masks.
+            SkMask src[2];
+            for (int i = 0; i < 2; i++) {
+                src[i].fBounds.setWH(w, h);
+                src[i].fFormat = i == 0 ? SkMask::kA8_Format : SkMask::kARGB32_Format;
+                src[i].fRowBytes = w * (i == 0 ? 1 : 4) + 3;
+                src[i].fImage = SkMask::AllocImage(src[i].computeImageSize());
+                for (int y = 0; y < h; y++) {
+                    for (int x = 0; x < w; x++) {
+                        if (i == 0) {
+                            *src[i].getAddr8(x, y) = a8[y * w + x];
+                        } else {
+                            *src[i].getAddr32(x, y) = SkPackARGB32(a8[y * w + x], 0, 0, 0);
+                        }
+                    }
+                }
+            }
+
+            // Blur the rows into columns of tmp, then the columns of tmp into dst.
+            int window = std::max(1, (int)floor(sigma * 3 * sqrt(2 * SK_DoublePI) / 4 + 0.5));
+            std::vector<std::vector<uint8_t>> rows, tmp;
+            for (int y = 0; y < h; y++) {
+                rows.push_back(box_blur_line(window, {&a8[y * w], &a8[y * w + w]}));
+            }
+            for (size_t x = 0; x < rows[0].size(); x++) {
+                std::vector<uint8_t> column;
+                for (const auto& row : rows) {
+                    column.push_back(row[x]);
+                }
+                tmp.push_back(box_blur_line(window, column));
+            }
+
+            for (const SkMask& s : src) {
+                SkMask dst;
+                SkMaskBlurFilter{sigma, sigma}.blur(s, &dst);
+                REPORTER_ASSERT(reporter, dst.fBounds.width()  == (int)tmp.size());
+                REPORTER_ASSERT(reporter, dst.fBounds.height() == (int)tmp[0].size());
+                for (int y = 0; y < dst.fBounds.height(); y++) {
+                    for (int x = 0; x < dst.fBounds.width(); x++) {
+                        REPORTER_ASSERT(reporter,
+                                        dst.fImage[y * dst.fRowBytes + x] == tmp[x][y],
+                                        "%dx%d sigma %g at (%d, %d)", w, h, sigma, x, y);
+                    }
+                }
+                SkMask::FreeImage(dst.fImage);
+                SkMask::FreeImage(s.fImage);
+            }
+        }
+    }
+}
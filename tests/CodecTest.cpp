@@ -19,6 +19,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageEncoder.h"
 #include "include/core/SkImageGenerator.h"
@@ -52,7 +53,9 @@
 #include "png.h"
 
 #include <setjmp.h>
+#include <atomic>
 #include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <utility>
@@ -1016,6 +1019,203 @@ DEF_TEST(Codec_jpeg_rewind, r) {
     REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
 }
 
+// Decoding straight from a memory backed stream must match decoding through the
+// codecs' own read buffers.
+static void check_memory_stream(skiatest::Reporter* r, const char* path, size_t length) {
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+    data = SkData::MakeSubset(data.get(), 0, std::min(length, data->size()));
+
+    std::unique_ptr<SkCodec> memoryCodec(SkCodec::MakeFromStream(
+            std::make_unique<SkMemoryStream>(data)));
+    std::unique_ptr<SkCodec> streamCodec(SkCodec::MakeFromStream(
+            std::make_unique<NotAssetMemStream>(data)));
+    if (!memoryCodec || !streamCodec) {
+        ERRORF(r, "Unable to create codecs for '%s'.", path);
+        return;
+    }
+
+    SkImageInfo info = memoryCodec->getInfo().makeColorType(kN32_SkColorType)
+                                             .makeAlphaType(kPremul_SkAlphaType);
+    for (bool incremental : { false, true }) {
+        SkBitmap fromMemory, fromStream;
+        fromMemory.allocPixels(info);
+        fromStream.allocPixels(info);
+        fromMemory.eraseColor(SK_ColorTRANSPARENT);
+        fromStream.eraseColor(SK_ColorTRANSPARENT);
+
+        SkCodec::Result memoryResult, streamResult;
+        if (incremental) {
+            memoryResult = memoryCodec->startIncrementalDecode(info, fromMemory.getPixels(),
+                                                               fromMemory.rowBytes());
+            streamResult = streamCodec->startIncrementalDecode(info, fromStream.getPixels(),
+                                                               fromStream.rowBytes());
+            if (SkCodec::kSuccess == memoryResult && SkCodec::kSuccess == streamResult) {
+                memoryResult = memoryCodec->incrementalDecode();
+                streamResult = streamCodec->incrementalDecode();
+            }
+        } else {
+            SkCodec::Options options;
+            options.fZeroInitialized = SkCodec::kYes_ZeroInitialized;
+            memoryResult = memoryCodec->getPixels(fromMemory.pixmap(), &options);
+            streamResult = streamCodec->getPixels(fromStream.pixmap(), &options);
+        }
+        REPORTER_ASSERT(r, memoryResult == streamResult, "%s: %s vs %s", path,
+                        SkCodec::ResultToString(memoryResult),
+                        SkCodec::ResultToString(streamResult));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(fromMemory, fromStream), "%s", path);
+    }
+}
+
+DEF_TEST(Codec_memoryStream, r) {
+    for (const char* path : { "images/mandrill_512.png", "images/randPixels.gif",
+                              "images/test640x479.gif" }) {
+        check_memory_stream(r, path, SIZE_MAX);
+        check_memory_stream(r, path, 20000);
+    }
+}
+
+namespace {
+// Passes work on to a thread pool, counting the tasks it is given.
+class CountingExecutor final : public SkExecutor {
+public:
+    CountingExecutor() : fExecutor(SkExecutor::MakeFIFOThreadPool(4)) {}
+
+    void add(std::function<void(void)> work) override {
+        fTaskCount++;
+        fExecutor->add(std::move(work));
+    }
+    void borrow() override { fExecutor->borrow(); }
+
+    int taskCount() const { return fTaskCount; }
+    void reset() { fTaskCount = 0; }
+
+private:
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::atomic<int>            fTaskCount{0};
+};
+}  // namespace
+
+DEF_TEST(Codec_jpeg_executor, r) {
+    // This image has a restart marker at the start of every MCU row (a restart interval of 18
+    // MCUs, one row of its 275 pixel width), so it can be split into bands.
+    const char* path = "images/icc-v2-gbr.jpg";
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+
+    CountingExecutor executor;
+    for (SkColorType colorType : { kRGBA_8888_SkColorType, kBGRA_8888_SkColorType,
+                                   kRGB_565_SkColorType }) {
+        for (float scale : { 1.0f, 0.5f, 0.25f }) {
+            std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(data));
+            if (!codec) {
+                ERRORF(r, "Unable to create codec '%s'.", path);
+                return;
+            }
+
+            SkImageInfo info = codec->getInfo().makeDimensions(codec->getScaledDimensions(scale))
+                                               .makeColorType(colorType);
+            SkBitmap serial, parallel;
+            serial.allocPixels(info);
+            parallel.allocPixels(info);
+
+            SkCodec::Result result = codec->getPixels(serial.pixmap());
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+
+            SkCodec::Options options;
+            options.fExecutor = &executor;
+            executor.reset();
+            result = codec->getPixels(info, parallel.getPixels(), parallel.rowBytes(), &options);
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+            // Otherwise the decode fell back to the serial path.
+            REPORTER_ASSERT(r, executor.taskCount() > 1,
+                            "colorType %d scale %g: %d tasks", colorType, scale,
+                            executor.taskCount());
+
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(serial, parallel),
+                            "colorType %d scale %g", colorType, scale);
+        }
+    }
+}
+
+// Compares getResampledPixels() at 1/factor of the full size to a box filter of a
+// full size decode.
+static void check_resampled(skiatest::Reporter* r, const char* path, int factor) {
+    std::unique_ptr<SkCodec> codec(SkCodec::MakeFromStream(GetResourceAsStream(path)));
+    if (!codec) {
+        ERRORF(r, "Unable to create codec '%s'.", path);
+        return;
+    }
+
+    SkImageInfo info = codec->getInfo().makeColorType(kRGBA_8888_SkColorType)
+                                       .makeAlphaType(kPremul_SkAlphaType);
+    SkBitmap full;
+    full.allocPixels(info);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(full.pixmap()));
+
+    SkBitmap resampled;
+    resampled.allocPixels(info.makeWH(info.width() / factor, info.height() / factor));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getResampledPixels(resampled.pixmap()));
+
+    for (int y = 0; y < resampled.height(); y++) {
+        for (int x = 0; x < resampled.width(); x++) {
+            const uint8_t* actual = static_cast<const uint8_t*>(resampled.getAddr(x, y));
+            for (int c = 0; c < 4; c++) {
+                int sum = 0;
+                for (int j = 0; j < factor; j++) {
+                    for (int i = 0; i < factor; i++) {
+                        sum += static_cast<const uint8_t*>(
+                                full.getAddr(x * factor + i, y * factor + j))[c];
+                    }
+                }
+                const int expected = (sum + factor * factor / 2) / (factor * factor);
+                if (SkTAbs(expected - actual[c]) > 1) {
+                    ERRORF(r, "%s: (%d, %d) channel %d is %d, expected %d",
+                           path, x, y, c, actual[c], expected);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(Codec_getResampledPixels, r) {
+    check_resampled(r, "images/mandrill_512.png", 4);
+    check_resampled(r, "images/mandrill_512.png", 8);
+    // Bottom-up scanline order.
+    check_resampled(r, "images/randPixels.bmp", 2);
+
+    // A size JPEG can decode to natively needs no further resampling.
+    const char* path = "images/mandrill_512_q075.jpg";
+    std::unique_ptr<SkCodec> codec(SkCodec::MakeFromStream(GetResourceAsStream(path)));
+    if (!codec) {
+        ERRORF(r, "Unable to create codec '%s'.", path);
+        return;
+    }
+    SkImageInfo info = codec->getInfo().makeWH(128, 128).makeColorType(kRGBA_8888_SkColorType);
+    SkBitmap scaled, resampled;
+    scaled.allocPixels(info);
+    resampled.allocPixels(info);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(scaled.pixmap()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getResampledPixels(resampled.pixmap()));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(scaled, resampled));
+
+    // Arbitrary sizes, up and down.
+    for (SkISize size : { SkISize{100, 77}, SkISize{1, 1}, SkISize{700, 3} }) {
+        resampled.allocPixels(info.makeDimensions(size));
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getResampledPixels(resampled.pixmap()));
+    }
+
+    // Unpremul would average unweighted colors.
+    resampled.allocPixels(info.makeAlphaType(kUnpremul_SkAlphaType));
+    REPORTER_ASSERT(r, SkCodec::kInvalidConversion ==
+                       codec->getResampledPixels(resampled.pixmap()));
+}
+
 static void check_color_xform(skiatest::Reporter* r, const char* path) {
     std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromStream(GetResourceAsStream(path)));
 
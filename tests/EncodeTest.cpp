@@ -12,6 +12,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
@@ -332,6 +333,130 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngFastFilterSelection, r) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+
+    for (auto filters : { SkPngEncoder::FilterFlag::kAll, SkPngEncoder::FilterFlag::kAvg,
+                          SkPngEncoder::FilterFlag::kUp | SkPngEncoder::FilterFlag::kPaeth }) {
+        SkPngEncoder::Options options;
+        options.fFilterFlags = filters;
+        SkDynamicMemoryWStream libpng;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&libpng, src, options));
+
+        options.fFastFilterSelection = true;
+        SkDynamicMemoryWStream fast;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&fast, src, options));
+
+        sk_sp<SkData> data0 = libpng.detachAsData();
+        sk_sp<SkData> data1 = fast.detachAsData();
+        // The estimate should cost us very little in file size.
+        REPORTER_ASSERT(r, data1->size() < data0->size() * 1.02,
+                        "%zu vs %zu", data1->size(), data0->size());
+
+        SkBitmap bm0, bm1;
+        SkImage::MakeFromEncoded(data0)->asLegacyBitmap(&bm0);
+        SkImage::MakeFromEncoded(data1)->asLegacyBitmap(&bm1);
+        REPORTER_ASSERT(r, almost_equals(bm0, bm1, 0));
+    }
+}
+
+DEF_TEST(Encode_PngParallel, r) {
+    // Big enough to be split into several independently deflated runs.
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (auto filters : { SkPngEncoder::FilterFlag::kAll, SkPngEncoder::FilterFlag::kSub,
+                          SkPngEncoder::FilterFlag::kPaeth, SkPngEncoder::FilterFlag::kZero }) {
+        for (int zlibLevel : { 0, 1, 6 }) {
+            SkPngEncoder::Options options;
+            options.fFilterFlags = filters;
+            options.fZLibLevel = zlibLevel;
+
+            SkDynamicMemoryWStream serial;
+            REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, src, options));
+
+            // Encode in uneven pieces, so runs also end wherever encodeRows() calls do.
+            options.fExecutor = executor.get();
+            SkDynamicMemoryWStream parallel;
+            auto encoder = SkPngEncoder::Make(&parallel, src, options);
+            REPORTER_ASSERT(r, encoder);
+            for (int rows : { 1, 200, 150, 161 }) {
+                REPORTER_ASSERT(r, encoder->encodeRows(rows));
+            }
+            encoder.reset();
+
+            SkBitmap bm0, bm1;
+            auto img0 = SkImage::MakeFromEncoded(serial.detachAsData());
+            auto img1 = SkImage::MakeFromEncoded(parallel.detachAsData());
+            REPORTER_ASSERT(r, img0 && img1);
+            if (img0 && img1) {
+                img0->asLegacyBitmap(&bm0);
+                img1->asLegacyBitmap(&bm1);
+                REPORTER_ASSERT(r, almost_equals(bm0, bm1, 0),
+                                "filters %d level %d", (int)filters, zlibLevel);
+            }
+        }
+    }
+}
+
+// Returns the largest IDAT chunk in |data|, and counts them in |count|.
+static size_t largest_idat_chunk(const SkData* data, int* count) {
+    const uint8_t* bytes = data->bytes();
+    size_t largest = 0;
+    *count = 0;
+    for (size_t offset = 8; offset + 12 <= data->size(); ) {
+        size_t length = (size_t)bytes[offset]     << 24 | (size_t)bytes[offset + 1] << 16 |
+                        (size_t)bytes[offset + 2] <<  8 | (size_t)bytes[offset + 3];
+        if (0 == memcmp(bytes + offset + 4, "IDAT", 4)) {
+            largest = std::max(largest, length);
+            (*count)++;
+        }
+        offset += length + 12;
+    }
+    return largest;
+}
+
+DEF_TEST(Encode_PngIDATChunks, r) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+
+    // Stored deflate output is bigger than the image, so it needs many chunks either way.
+    auto executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (SkExecutor* e : { (SkExecutor*)nullptr, executor.get() }) {
+        SkPngEncoder::Options options;
+        options.fZLibLevel = 0;
+        options.fFastFilterSelection = true;
+        options.fExecutor = e;
+        SkDynamicMemoryWStream stream;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&stream, src, options));
+        sk_sp<SkData> data = stream.detachAsData();
+
+        int count;
+        size_t largest = largest_idat_chunk(data.get(), &count);
+        REPORTER_ASSERT(r, largest <= 64 * 1024, "%zu byte IDAT", largest);
+        REPORTER_ASSERT(r, count > 1);
+
+        SkBitmap decoded;
+        auto image = SkImage::MakeFromEncoded(data);
+        REPORTER_ASSERT(r, image && image->asLegacyBitmap(&decoded));
+        REPORTER_ASSERT(r, almost_equals(bitmap, decoded, 0));
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
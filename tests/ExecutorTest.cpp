@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkExecutor.h"
+#include "include/private/SkSemaphore.h"
+#include "include/private/SkTDArray.h"
+#include "src/core/SkTaskGroup.h"
+#include "tests/Test.h"
+
+#include <atomic>
+
+DEF_TEST(Executor_WorkStealing_Batch, r) {
+    auto pool = SkExecutor::MakeWorkStealingThreadPool(4);
+
+    std::atomic<int> sum{0};
+    SkTaskGroup tasks(*pool);
+    tasks.batch(10000, [&](int i) { sum.fetch_add(i, std::memory_order_relaxed); });
+    tasks.wait();
+    REPORTER_ASSERT(r, sum.load() == 10000 * 9999 / 2);
+}
+
+DEF_TEST(Executor_WorkStealing_Nested, r) {
+    // Tasks that add work and wait on it from inside the pool, which only finishes if waiting
+    // threads borrow work (from their own lists first).
+    auto pool = SkExecutor::MakeWorkStealingThreadPool(2);
+
+    std::atomic<int> count{0};
+    SkTaskGroup outer(*pool);
+    outer.batch(16, [&](int) {
+        SkTaskGroup inner(*pool);
+        inner.batch(64, [&](int) { count.fetch_add(1, std::memory_order_relaxed); });
+        inner.wait();
+    });
+    outer.wait();
+    REPORTER_ASSERT(r, count.load() == 16 * 64);
+}
+
+DEF_TEST(Executor_WorkStealing_Priority, r) {
+    auto pool = SkExecutor::MakeWorkStealingThreadPool(1, false);
+
+    // Keep the only thread busy while we queue up work of each priority.
+    SkSemaphore started, unblock, done;
+    pool->add([&] {
+        started.signal();
+        unblock.wait();
+    });
+    started.wait();
+
+    SkTDArray<SkExecutor::Priority> order;
+    for (auto priority : {SkExecutor::Priority::kLow,
+                          SkExecutor::Priority::kNormal,
+                          SkExecutor::Priority::kHigh}) {
+        pool->addWithPriority(priority, [&order, &done, priority] {
+            order.push_back(priority);
+            done.signal();
+        });
+    }
+    unblock.signal();
+    for (int i = 0; i < 3; i++) {
+        done.wait();
+    }
+
+    REPORTER_ASSERT(r, order.count() == 3);
+    REPORTER_ASSERT(r, order[0] == SkExecutor::Priority::kHigh);
+    REPORTER_ASSERT(r, order[1] == SkExecutor::Priority::kNormal);
+    REPORTER_ASSERT(r, order[2] == SkExecutor::Priority::kLow);
+}
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkStream.h"
@@ -13,6 +14,9 @@
 #include "src/core/SkEndian.h"
 #include "src/core/SkFontStream.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
@@ -272,4 +276,60 @@ DEF_TEST(FontHost, reporter) {
     test_symbolfont(reporter);
 }
 
+static std::unique_ptr<SkScalerContext> make_scaler_context(sk_sp<SkTypeface> typeface,
+                                                            SkScalar size) {
+    SkFont font(typeface, size);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    return typeface->createScalerContext(SkScalerContextEffects{}, &strikeSpec.descriptor());
+}
+
+// Renders the first glyphCount glyphs, returning all their pixels end to end.
+static std::vector<uint8_t> render_glyphs(SkScalerContext* scalerContext, int glyphCount) {
+    std::vector<uint8_t> pixels;
+    SkArenaAlloc alloc{4096};
+    for (int id = 0; id < glyphCount; id++) {
+        SkGlyph glyph{SkPackedGlyphID{SkTo<SkGlyphID>(id)}};
+        scalerContext->getMetrics(&glyph);
+        if (glyph.setImage(&alloc, scalerContext) && !glyph.isEmpty()) {
+            const uint8_t* image = static_cast<const uint8_t*>(glyph.image());
+            pixels.insert(pixels.end(), image, image + glyph.imageSize());
+        }
+    }
+    return pixels;
+}
+
+// Scaler contexts of one typeface may rasterize glyphs on several threads at once, and should
+// produce just what they do one at a time.
+DEF_TEST(FontHost_ConcurrentScalerContexts, reporter) {
+    sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+    if (!typeface) {
+        return;
+    }
+    static constexpr int kThreadCount = 4;
+    const int glyphCount = std::min(typeface->countGlyphs(), 128);
+
+    // All the scaler contexts are alive at once, as they would be in different strikes.
+    std::unique_ptr<SkScalerContext> scalerContexts[kThreadCount];
+    std::vector<uint8_t> expected[kThreadCount];
+    for (int i = 0; i < kThreadCount; i++) {
+        scalerContexts[i] = make_scaler_context(typeface, 10 + i);
+        expected[i] = render_glyphs(scalerContexts[i].get(), glyphCount);
+    }
+
+    // Make our own executor so the --threads parameter doesn't mess things up.
+    auto executor = SkExecutor::MakeFIFOThreadPool(kThreadCount);
+    std::vector<uint8_t> actual[kThreadCount];
+    for (int tries = 0; tries < 10; tries++) {
+        SkTaskGroup(*executor).batch(kThreadCount, [&](int i) {
+            actual[i] = render_glyphs(scalerContexts[i].get(), glyphCount);
+        });
+        for (int i = 0; i < kThreadCount; i++) {
+            REPORTER_ASSERT(reporter, actual[i] == expected[i]);
+        }
+    }
+}
+
 // need tests for SkStrSearch
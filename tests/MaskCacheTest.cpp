@@ -5,6 +5,9 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPath.h"
 #include "src/core/SkCachedData.h"
 #include "src/core/SkMaskCache.h"
 #include "src/core/SkResourceCache.h"
@@ -102,3 +105,89 @@ DEF_TEST(RectsMaskCache, reporter) {
     check_data(reporter, data, 1, kNotInCache, kLocked);
     data->unref();
 }
+
+DEF_TEST(PathMaskCache, reporter) {
+    SkResourceCache cache(1024);
+
+    SkPath path;
+    path.addCircle(10, 10, 8);
+    SkMatrix matrix = SkMatrix::Translate(0.25f, 0);
+    SkMask mask;
+
+    SkCachedData* data = SkMaskCache::FindAndRef(path, matrix, &mask, &cache);
+    REPORTER_ASSERT(reporter, nullptr == data);
+
+    size_t size = 20 * 20;
+    data = cache.newCachedData(size);
+    memset(data->writable_data(), 0xff, size);
+    mask.fBounds.setXYWH(1, 1, 20, 20);
+    mask.fRowBytes = 20;
+    mask.fFormat = SkMask::kA8_Format;
+    SkMaskCache::Add(path, matrix, mask, data, &cache);
+    check_data(reporter, data, 2, kInCache, kLocked);
+
+    data->unref();
+    check_data(reporter, data, 1, kInCache, kUnlocked);
+
+    // The fill type and the matrix are part of the key.
+    {
+        SkPath evenOdd = path;
+        evenOdd.setFillType(SkPathFillType::kEvenOdd);
+        REPORTER_ASSERT(reporter, !SkMaskCache::FindAndRef(evenOdd, matrix, &mask, &cache));
+    }
+    REPORTER_ASSERT(reporter, !SkMaskCache::FindAndRef(path, SkMatrix::I(), &mask, &cache));
+
+    sk_bzero(&mask, sizeof(mask));
+    data = SkMaskCache::FindAndRef(path, matrix, &mask, &cache);
+    REPORTER_ASSERT(reporter, data);
+    REPORTER_ASSERT(reporter, data->size() == size);
+    REPORTER_ASSERT(reporter, mask.fBounds == SkIRect::MakeXYWH(1, 1, 20, 20));
+    REPORTER_ASSERT(reporter, data->data() == (const void*)mask.fImage);
+    check_data(reporter, data, 2, kInCache, kLocked);
+    data->unref();
+
+    // Editing the path changes its generation ID, which purges its masks.
+    path.lineTo(20, 20);
+    REPORTER_ASSERT(reporter, !SkMaskCache::FindAndRef(path, matrix, &mask, &cache));
+    REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() == 0);
+}
+
+// Cached masks are reused across translations, but must match drawing without the cache.
+DEF_TEST(PathMaskCache_Draw, reporter) {
+    SkPath path;
+    path.moveTo(2, 2).lineTo(30, 8).lineTo(12, 28).close();
+    path.addCircle(16, 16, 6);
+    SkPath volatilePath = path;
+    volatilePath.setIsVolatile(true);
+
+    auto draw = [](const SkPath& path, SkScalar dx, SkScalar dy) {
+        SkBitmap bm;
+        bm.allocN32Pixels(100, 100);
+        bm.eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(bm);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        canvas.translate(dx, dy);
+        canvas.drawPath(path, paint);
+        return bm;
+    };
+    auto equal = [](const SkBitmap& a, const SkBitmap& b) {
+        return 0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize());
+    };
+
+    // The first draw of a path doesn't cache its mask, but is rounded just like the cached ones.
+    REPORTER_ASSERT(reporter, equal(draw(path, 40.3f, 50.1f), draw(volatilePath, 40.25f, 50)));
+
+    for (int i = 0; i < 2; i++) {  // The second time around, every mask comes from the cache.
+        REPORTER_ASSERT(reporter, equal(draw(path, 10, 20), draw(volatilePath, 10, 20)));
+        REPORTER_ASSERT(reporter, equal(draw(path, 40, 50), draw(volatilePath, 40, 50)));
+        // Translations of cached masks are rounded to a quarter pixel.
+        REPORTER_ASSERT(reporter, equal(draw(path, 40.3f, 50.1f),
+                                        draw(volatilePath, 40.25f, 50)));
+    }
+
+    // The mask follows edits to the path.
+    path.lineTo(90, 30);
+    volatilePath.lineTo(90, 30);
+    REPORTER_ASSERT(reporter, equal(draw(path, 10, 20), draw(volatilePath, 10, 20)));
+}
@@ -167,4 +167,35 @@ DEF_TEST(SkPDF_DeflateWStream, r) {
     REPORTER_ASSERT(r, !emptyDeflateWStream.writeText("FOO"));
 }
 
+// Large writes bypass SkDeflateWStream's buffer; mix them with small ones at every level.
+DEF_TEST(SkPDF_DeflateWStream_Levels, r) {
+    SkRandom random(654321);
+    constexpr size_t kSize = 100000;
+    SkAutoTMalloc<uint8_t> buffer(kSize);
+    for (size_t j = 0; j < kSize; ++j) {
+        buffer[j] = "0123 4.5 m re f\n"[random.nextULessThan(16)];
+    }
+    for (int level : {-1, 0, 1, 6, 9}) {
+        SkDynamicMemoryWStream dynamicMemoryWStream;
+        {
+            SkDeflateWStream deflateWStream(&dynamicMemoryWStream, level);
+            size_t j = 0;
+            for (size_t writeSize : {10, 5000, 4086, 20000, 1, 4096}) {
+                REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], writeSize));
+                j += writeSize;
+            }
+            REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], kSize - j));
+            REPORTER_ASSERT(r, deflateWStream.bytesWritten() == kSize);
+        }
+        std::unique_ptr<SkStreamAsset> compressed(dynamicMemoryWStream.detachAsStream());
+        std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, compressed.get()));
+        REPORTER_ASSERT(r, decompressed && decompressed->getLength() == kSize, "level %d", level);
+        if (decompressed && decompressed->getLength() == kSize) {
+            SkAutoTMalloc<uint8_t> result(kSize);
+            decompressed->read(result.get(), kSize);
+            REPORTER_ASSERT(r, 0 == memcmp(result.get(), buffer.get(), kSize), "level %d", level);
+        }
+    }
+}
+
 #endif
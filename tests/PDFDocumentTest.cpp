@@ -6,16 +6,23 @@
  */
 #include "tests/Test.h"
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
+#include "include/effects/SkGradientShader.h"
 #include "src/core/SkOSFile.h"
+#include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/utils/SkOSPath.h"
 #include "tools/Resources.h"
 
 #include "tools/ToolUtils.h"
 
+#include <algorithm>
+
 static void test_empty(skiatest::Reporter* reporter) {
     SkDynamicMemoryWStream stream;
 
@@ -255,3 +262,139 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+static sk_sp<SkData> make_multipage_pdf(SkExecutor* executor) {
+    SkBitmap opaque;
+    opaque.allocN32Pixels(64, 64);
+    opaque.eraseColor(SK_ColorBLUE);
+    opaque.setImmutable();
+    // One font is embedded as Type 3, the other as a subset TrueType font.
+    SkFont type3(ToolUtils::create_portable_typeface(), 12);
+    SkFont trueType(MakeResourceAsTypeface("fonts/Roboto-Regular.ttf"), 12);
+
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (int i = 0; i < 20; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        for (int line = 0; line < 40; ++line) {
+            canvas->drawString(SkStringPrintf("page %d, line %d", i, line),
+                               36, 36 + 18 * line, line % 2 ? type3 : trueType, SkPaint());
+        }
+        canvas->drawRect({300, 300, 400, 300.0f + i}, SkPaint());
+        canvas->drawBitmap(opaque, 400, 36);
+        doc->endPage();
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+// With an executor, objects finish in any order but must still be written in serial order.
+DEF_TEST(SkPDF_executor_matches_serial, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_matches_serial, r);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    sk_sp<SkData> serial = make_multipage_pdf(nullptr);
+    sk_sp<SkData> threaded = make_multipage_pdf(executor.get());
+    REPORTER_ASSERT(r, serial->size() > 0);
+    REPORTER_ASSERT(r, serial->equals(threaded.get()));
+}
+
+// Draws a page that needs its own gradient, graphic state and image, so a document that
+// kept every page's resources would grow steadily.
+static void draw_streaming_page(SkCanvas* canvas, int i, const SkFont& font) {
+    SkPaint paint;
+    const SkPoint pts[] = {{0, 0}, {612, 792}};
+    const SkColor colors[] = {SK_ColorWHITE, SkColorSetRGB(i & 0xFF, (i >> 8) & 0xFF, 0x80)};
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+    canvas->drawPaint(paint);
+    paint.setShader(nullptr);
+    paint.setAlphaf(0.25f + (i % 97) / 200.0f);
+    canvas->drawRect({36, 36, 576, 100}, paint);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);
+    bitmap.eraseColor(SkColorSetRGB(0x40, i & 0xFF, (i >> 8) & 0xFF));
+    canvas->drawBitmap(bitmap, 500, 700);
+
+    canvas->drawString(SkStringPrintf("Page %d", i), 36, 150, font, SkPaint());
+}
+
+DEF_TEST(SkPDF_streaming_page_tree, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming_page_tree, r);
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+    for (int pageCount : {1, 8, 9, 100}) {
+        SkPDF::Metadata metadata;
+        metadata.fStreamingMemoryLimit = 1 << 20;
+        SkDynamicMemoryWStream stream;
+        auto doc = SkPDF::MakeDocument(&stream, metadata);
+        for (int i = 0; i < pageCount; ++i) {
+            draw_streaming_page(doc->beginPage(612, 792), i, font);
+            doc->endPage();
+        }
+        doc->close();
+        sk_sp<SkData> data = stream.detachAsData();
+        SkString rootCount = SkStringPrintf("/Count %d", pageCount);
+        REPORTER_ASSERT(r, contains(data->bytes(), data->size(), rootCount.c_str()),
+                        "%d pages", pageCount);
+        REPORTER_ASSERT(r, contains(data->bytes(), data->size(), "%%EOF"));
+    }
+}
+
+#ifdef SK_SUPPORT_PDF
+// In streaming mode, the memory the document holds should stay within its limit, however many
+// pages there are.
+DEF_TEST(SkPDF_streaming_memory_is_flat, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming_memory_is_flat, r);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+
+    constexpr size_t kLimit = 256 << 10;
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor.get();
+    metadata.fStreamingMemoryLimit = kLimit;
+    SkNullWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    auto pdf = static_cast<SkPDFDocument*>(doc.get());
+
+    // Unwritten jobs and resource caches may each run a little past the limit before they are
+    // cut back. Keeping every page's resources would pass 3x the limit well before the end.
+    constexpr int kPageCount = 10000;
+    size_t maxBytes = 0;
+    for (int i = 0; i < kPageCount; ++i) {
+        draw_streaming_page(doc->beginPage(612, 792), i, font);
+        doc->endPage();
+        maxBytes = std::max(maxBytes, pdf->approxBytesUsed());
+    }
+    doc->close();
+    REPORTER_ASSERT(r, maxBytes > 0);
+    REPORTER_ASSERT(r, maxBytes <= 3 * kLimit, "held %zu bytes", maxBytes);
+}
+#endif
+
+// CompressionLevel::None should leave every stream, images and soft masks included, unfiltered.
+DEF_TEST(SkPDF_compression_none, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_compression_none, r);
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    bitmap.eraseColor(0x80FF0000);
+    bitmap.erase(SK_ColorBLUE, SkIRect::MakeWH(32, 32));
+    sk_sp<SkImage> image = SkImage::MakeFromBitmap(bitmap);
+
+    for (auto level : {SkPDF::Metadata::CompressionLevel::Default,
+                       SkPDF::Metadata::CompressionLevel::None}) {
+        SkPDF::Metadata metadata;
+        metadata.fCompressionLevel = level;
+        SkDynamicMemoryWStream stream;
+        auto doc = SkPDF::MakeDocument(&stream, metadata);
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawImage(image, 10, 10);
+        canvas->drawRect(SkRect::MakeXYWH(100, 100, 200, 200), SkPaint());
+        doc->close();
+        sk_sp<SkData> pdf = stream.detachAsData();
+
+        REPORTER_ASSERT(r, contains(pdf->bytes(), pdf->size(), "/SMask"));
+        bool deflated = contains(pdf->bytes(), pdf->size(), "/FlateDecode");
+        REPORTER_ASSERT(r, deflated == (level != SkPDF::Metadata::CompressionLevel::None));
+    }
+}
@@ -11,7 +11,10 @@
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontStyle.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
@@ -961,3 +964,228 @@ DEF_TEST(Picture_fillsBBH, r) {
                         "results.size() == %d, want %d\n", (int)results.size(), n);
     }
 }
+
+// Drawing into a tile clips paths differently than drawing into a larger device, so we compare
+// against drawing each tile clipped on one canvas, allowing for a little antialiasing difference.
+static bool pixels_nearly_equal(const SkBitmap& a, const SkBitmap& b) {
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            const SkPMColor pa = *a.getAddr32(x, y),
+                            pb = *b.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                if (SkTAbs((int)((pa >> shift) & 0xFF) - (int)((pb >> shift) & 0xFF)) > 1) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+DEF_TEST(Picture_playbackTiled, r) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    SkCanvas* c = recorder.beginRecording({0,0, 300,200}, &factory);
+    SkRandom rand;
+    for (int i = 0; i < 200; i++) {
+        SkPaint paint;
+        paint.setColor(rand.nextU() | 0x80000000);
+        paint.setAntiAlias(i % 2);
+        const SkRect rect = SkRect::MakeXYWH(rand.nextRangeScalar(-20, 300),
+                                             rand.nextRangeScalar(-20, 200),
+                                             rand.nextRangeScalar(  1,  60),
+                                             rand.nextRangeScalar(  1,  60));
+        if (i % 3) {
+            c->drawRect(rect, paint);
+        } else {
+            c->drawOval(rect, paint);
+        }
+    }
+    sk_sp<SkPicture> pic = recorder.finishRecordingAsPicture();
+
+    const SkMatrix scale = SkMatrix::Scale(0.75f, 1.5f);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (const SkMatrix* matrix : { (const SkMatrix*)nullptr, &scale }) {
+        for (SkISize tileSize : { SkISize{64, 64}, SkISize{37, 100}, SkISize{1000, 1000} }) {
+            SkBitmap expected;
+            expected.allocN32Pixels(257, 193);
+            expected.eraseColor(SK_ColorWHITE);
+            SkCanvas canvas(expected);
+            for (int y = 0; y < expected.height(); y += tileSize.height()) {
+                for (int x = 0; x < expected.width(); x += tileSize.width()) {
+                    SkAutoCanvasRestore acr(&canvas, true);
+                    canvas.clipRect(SkRect::MakeXYWH(x, y, tileSize.width(), tileSize.height()));
+                    canvas.drawPicture(pic, matrix, nullptr);
+                }
+            }
+
+            SkBitmap serial, parallel;
+            for (SkBitmap* bm : { &serial, &parallel }) {
+                bm->allocN32Pixels(257, 193);
+                bm->eraseColor(SK_ColorWHITE);
+            }
+            REPORTER_ASSERT(r, pic->playbackTiled(serial.pixmap(), matrix, nullptr, tileSize));
+            REPORTER_ASSERT(r, pic->playbackTiled(parallel.pixmap(), matrix, executor.get(),
+                                                  tileSize));
+
+            REPORTER_ASSERT(r, pixels_nearly_equal(expected, serial),
+                            "tiles %dx%d differ", tileSize.width(), tileSize.height());
+            REPORTER_ASSERT(r, 0 == memcmp(serial.getPixels(), parallel.getPixels(),
+                                           serial.computeByteSize()));
+        }
+    }
+
+    SkBitmap bm;
+    bm.allocN32Pixels(10, 10);
+    REPORTER_ASSERT(r, !pic->playbackTiled(bm.pixmap(), nullptr, nullptr, {0, 64}));
+    REPORTER_ASSERT(r, !pic->playbackTiled(SkPixmap(), nullptr, nullptr));
+}
+
+DEF_TEST(Picture_MakeFromMappedData, r) {
+    SkPictureRecorder nestedRecorder;
+    nestedRecorder.beginRecording(50, 50)->drawCircle(25, 25, 20, SkPaint());
+    sk_sp<SkPicture> nested = nestedRecorder.finishRecordingAsPicture();
+
+    SkBitmap bm;
+    make_bm(&bm, 16, 16, SK_ColorGREEN, true);
+
+    SkPictureRecorder recorder;
+    SkCanvas* c = recorder.beginRecording(200, 100);
+    SkRandom rand;
+    for (int i = 0; i < 50; i++) {
+        SkPaint paint;
+        paint.setColor(rand.nextU() | 0xFF000000);
+        paint.setAntiAlias(true);
+        SkPath path;
+        path.moveTo(rand.nextRangeScalar(0, 200), rand.nextRangeScalar(0, 100));
+        path.quadTo(rand.nextRangeScalar(0, 200), rand.nextRangeScalar(0, 100),
+                    rand.nextRangeScalar(0, 200), rand.nextRangeScalar(0, 100));
+        c->drawPath(path, paint);
+    }
+    c->save();
+        c->translate(120, 40);
+        c->drawPicture(nested);
+    c->restore();
+    c->drawImage(SkImage::MakeFromBitmap(bm), 10, 60);
+    sk_sp<SkPicture> pic = recorder.finishRecordingAsPicture();
+
+    sk_sp<SkData> data = pic->serialize();
+    sk_sp<SkPicture> copied = SkPicture::MakeFromData(data.get()),
+                     mapped = SkPicture::MakeFromMappedData(data);
+    REPORTER_ASSERT(r, copied && mapped);
+    // The mapped picture keeps the serialized data alive, as it reads its ops from there.
+    REPORTER_ASSERT(r, !data->unique());
+    REPORTER_ASSERT(r, mapped->cullRect() == pic->cullRect());
+    REPORTER_ASSERT(r, mapped->approximateOpCount() > 50);
+
+    auto draw = [](const SkPicture* picture) {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(200, 100);
+        bitmap.eraseColor(SK_ColorWHITE);
+        SkCanvas(bitmap).drawPicture(picture);
+        return bitmap;
+    };
+    const SkBitmap expected = draw(copied.get());
+    // Mapped pictures can be serialized again, too.
+    sk_sp<SkPicture> reserialized = SkPicture::MakeFromData(mapped->serialize().get());
+    for (const SkPicture* picture : { mapped.get(), reserialized.get() }) {
+        const SkBitmap actual = draw(picture);
+        REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                       expected.computeByteSize()));
+    }
+
+    // Misaligned data can't be read in place, so it's copied instead.
+    sk_sp<SkData> padded = SkData::MakeUninitialized(data->size() + 1);
+    memcpy(padded->writable_data() + 1, data->data(), data->size());
+    sk_sp<SkData> misaligned = SkData::MakeSubset(padded.get(), 1, data->size());
+    padded.reset();
+    mapped = SkPicture::MakeFromMappedData(misaligned);
+    REPORTER_ASSERT(r, mapped && misaligned->unique());
+    if (mapped) {
+        const SkBitmap actual = draw(mapped.get());
+        REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                       expected.computeByteSize()));
+    }
+
+    REPORTER_ASSERT(r, !SkPicture::MakeFromMappedData(nullptr));
+    REPORTER_ASSERT(r, !SkPicture::MakeFromMappedData(SkData::MakeWithCopy(data->data(), 20)));
+}
+
+DEF_TEST(Picture_computeDamageDrawables, r) {
+    class RectDrawable final : public SkDrawable {
+        SkRect onGetBounds() override { return SkRect::MakeXYWH(50, 60, 70, 80); }
+        void onDraw(SkCanvas* canvas) override { canvas->drawRect(this->getBounds(), SkPaint()); }
+    };
+
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording({0,0, 300,200});
+    canvas->drawRect({0,0, 10,10}, SkPaint());
+    canvas->drawDrawable(sk_make_sp<RectDrawable>().get());
+    canvas->drawRect({200,0, 210,10}, SkPaint());
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    // A drawable may draw differently each time, even within the same picture.
+    REPORTER_ASSERT(r, picture->computeDamage(*picture) == SkRect::MakeXYWH(50, 60, 70, 80));
+}
+
+DEF_TEST(Picture_playbackDamage, r) {
+    auto record = [](SkColor changed) {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        SkCanvas* c = recorder.beginRecording({0,0, 300,200}, &factory);
+        SkRandom rand;
+        for (int i = 0; i < 100; i++) {
+            SkPaint paint;
+            paint.setColor(i == 50 ? changed : rand.nextU() | 0xFF000000);
+            paint.setAntiAlias(true);
+            c->drawOval(SkRect::MakeXYWH(rand.nextRangeScalar(0, 240),
+                                         rand.nextRangeScalar(0, 140),
+                                         rand.nextRangeScalar(1,  60),
+                                         rand.nextRangeScalar(1,  60)), paint);
+        }
+        return recorder.finishRecordingAsPicture();
+    };
+    sk_sp<SkPicture> before = record(SK_ColorBLUE),
+                     after  = record(SK_ColorRED);
+
+    REPORTER_ASSERT(r, after->computeDamage(*after).isEmpty());
+    REPORTER_ASSERT(r, after->computeDamage(*record(SK_ColorRED)).isEmpty());
+    const SkRect damage = after->computeDamage(*before);
+    REPORTER_ASSERT(r, !damage.isEmpty() && damage != after->cullRect());
+
+    const SkMatrix scale = SkMatrix::Scale(0.75f, 1.5f);
+    for (const SkMatrix* matrix : { (const SkMatrix*)nullptr, &scale }) {
+        auto draw = [matrix](const SkPicture* picture) {
+            SkBitmap bitmap;
+            bitmap.allocN32Pixels(300, 300);
+            bitmap.eraseColor(SK_ColorTRANSPARENT);
+            SkCanvas(bitmap).drawPicture(picture, matrix, nullptr);
+            return bitmap;
+        };
+        const SkBitmap full = draw(after.get());
+        SkBitmap actual = draw(before.get());
+
+        REPORTER_ASSERT(r, before->playbackDamage(actual.pixmap(), matrix, *before).isEmpty());
+        const SkIRect redrawn = after->playbackDamage(actual.pixmap(), matrix, *before);
+        REPORTER_ASSERT(r, !redrawn.isEmpty() && actual.bounds().contains(redrawn));
+
+        // Outside what was redrawn, the pictures must draw the same...
+        const SkBitmap previous = draw(before.get());
+        for (int y = 0; y < full.height(); y++) {
+            for (int x = 0; x < full.width(); x++) {
+                if (!redrawn.contains(x, y)) {
+                    REPORTER_ASSERT(r, *full.getAddr32(x, y) == *previous.getAddr32(x, y));
+                    REPORTER_ASSERT(r, *full.getAddr32(x, y) == *actual.getAddr32(x, y));
+                }
+            }
+        }
+        // ... and inside, we draw as if clipped to it, like playbackTiled().
+        SkBitmap expected = previous;
+        SkCanvas canvas(expected);
+        canvas.clipRect(SkRect::Make(redrawn));
+        canvas.clear(SK_ColorTRANSPARENT);
+        canvas.drawPicture(after, matrix, nullptr);
+        REPORTER_ASSERT(r, pixels_nearly_equal(expected, actual));
+    }
+}
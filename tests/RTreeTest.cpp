@@ -6,6 +6,7 @@
  */
 
 #include "include/utils/SkRandom.h"
+#include "src/core/SkPackedRTree.h"
 #include "src/core/SkRTree.h"
 #include "tests/Test.h"
 
@@ -43,8 +44,9 @@ static bool verify_query(SkRect query, SkRect rects[], const std::vector<int>& f
     return found == expected;
 }
 
+template <typename Tree>
 static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rects[],
-                        const SkRTree& tree) {
+                        const Tree& tree) {
     for (size_t i = 0; i < NUM_QUERIES; ++i) {
         std::vector<int> hits;
         SkRect query = random_rect(rand);
@@ -53,11 +55,12 @@ static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rec
     }
 }
 
-DEF_TEST(RTree, reporter) {
+template <typename Tree>
+static void test_rtree(skiatest::Reporter* reporter) {
     int expectedDepthMin = -1;
     int tmp = NUM_RECTS;
     while (tmp > 0) {
-        tmp -= static_cast<int>(pow(static_cast<double>(SkRTree::kMaxChildren),
+        tmp -= static_cast<int>(pow(static_cast<double>(Tree::kMaxChildren),
                                     static_cast<double>(expectedDepthMin + 1)));
         ++expectedDepthMin;
     }
@@ -65,7 +68,7 @@ DEF_TEST(RTree, reporter) {
     int expectedDepthMax = -1;
     tmp = NUM_RECTS;
     while (tmp > 0) {
-        tmp -= static_cast<int>(pow(static_cast<double>(SkRTree::kMinChildren),
+        tmp -= static_cast<int>(pow(static_cast<double>(Tree::kMinChildren),
                                     static_cast<double>(expectedDepthMax + 1)));
         ++expectedDepthMax;
     }
@@ -73,7 +76,7 @@ DEF_TEST(RTree, reporter) {
     SkRandom rand;
     SkAutoTMalloc<SkRect> rects(NUM_RECTS);
     for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
-        SkRTree rtree;
+        Tree rtree;
         REPORTER_ASSERT(reporter, 0 == rtree.getCount());
 
         for (int j = 0; j < NUM_RECTS; j++) {
@@ -81,7 +84,7 @@ DEF_TEST(RTree, reporter) {
         }
 
         rtree.insert(rects.get(), NUM_RECTS);
-        SkASSERT(rects);  // SkRTree doesn't take ownership of rects.
+        SkASSERT(rects);  // The tree doesn't take ownership of rects.
 
         run_queries(reporter, rand, rects, rtree);
         REPORTER_ASSERT(reporter, NUM_RECTS == rtree.getCount());
@@ -89,3 +92,42 @@ DEF_TEST(RTree, reporter) {
                                   expectedDepthMax >= rtree.getDepth());
     }
 }
+
+DEF_TEST(RTree, reporter) {
+    test_rtree<SkRTree>(reporter);
+}
+
+DEF_TEST(PackedRTree, reporter) {
+    test_rtree<SkPackedRTree>(reporter);
+}
+
+template <typename Tree>
+static size_t bytes_used(int numRects) {
+    SkRandom rand;
+    SkAutoTMalloc<SkRect> rects(numRects);
+    for (int i = 0; i < numRects; ++i) {
+        rects[i] = random_rect(rand);
+    }
+    Tree tree;
+    if (numRects > 0) {
+        tree.insert(rects.get(), numRects);
+    }
+    return tree.bytesUsed();
+}
+
+DEF_TEST(PackedRTree_bytesUsed, reporter) {
+    // Nodes are reserved exactly: one full leaf costs no more than a single rect, ...
+    REPORTER_ASSERT(reporter, bytes_used<SkPackedRTree>(0) < bytes_used<SkPackedRTree>(1));
+    REPORTER_ASSERT(reporter, bytes_used<SkPackedRTree>(1) ==
+                              bytes_used<SkPackedRTree>(SkPackedRTree::kMaxChildren));
+    REPORTER_ASSERT(reporter, bytes_used<SkPackedRTree>(SkPackedRTree::kMaxChildren) <
+                              bytes_used<SkPackedRTree>(SkPackedRTree::kMaxChildren + 1));
+
+    // ... and a big tree costs a little over the 20 bytes of bounds and index per rect, less
+    // than SkRTree's pointer-linked nodes.
+    constexpr int kNumRects = 10000;
+    size_t packed = bytes_used<SkPackedRTree>(kNumRects),
+           rtree  = bytes_used<SkRTree>(kNumRects);
+    REPORTER_ASSERT(reporter, packed <= kNumRects * 22, "%zu bytes", packed);
+    REPORTER_ASSERT(reporter, packed < rtree, "%zu vs %zu bytes", packed, rtree);
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "tests/Test.h"
+
+#include "include/effects/SkImageFilters.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDiff.h"
+#include "src/core/SkRecorder.h"
+
+static const int W = 1920, H = 1080;
+static const SkRect kCull = SkRect::MakeWH(W, H);
+
+// A toolbar with three buttons, the second of which can be changed.
+struct Scene {
+    SkColor  buttonColor = SK_ColorBLUE;
+    SkScalar buttonX     = 100;
+    bool     extraButton = false;
+    sk_sp<SkImageFilter> buttonFilter;
+};
+
+static void record_scene(SkRecord* record, const Scene& scene) {
+    SkRecorder canvas(record, W, H);
+    SkPaint paint;
+    canvas.drawRect(SkRect::MakeWH(W, 50), paint);
+
+    canvas.save();
+    if (scene.buttonFilter) {
+        SkPaint layerPaint;
+        layerPaint.setImageFilter(scene.buttonFilter);
+        canvas.saveLayer(nullptr, &layerPaint);
+    }
+    canvas.translate(10, 10);
+    paint.setColor(SK_ColorRED);
+    canvas.drawRect(SkRect::MakeXYWH(0, 0, 30, 30), paint);
+    paint.setColor(scene.buttonColor);
+    canvas.drawRect(SkRect::MakeXYWH(scene.buttonX, 0, 30, 30), paint);
+    if (scene.extraButton) {
+        canvas.drawOval(SkRect::MakeXYWH(150, 0, 30, 30), paint);
+    }
+    paint.setColor(SK_ColorGREEN);
+    canvas.drawRect(SkRect::MakeXYWH(200, 0, 30, 30), paint);
+    if (scene.buttonFilter) {
+        canvas.restore();
+    }
+    canvas.restore();
+
+    canvas.drawRect(SkRect::MakeXYWH(0, 500, 100, 100), SkPaint());
+}
+
+static SkRect diff(const Scene& before, const Scene& after) {
+    SkRecord a, b;
+    record_scene(&a, before);
+    record_scene(&b, after);
+    return SkRecordDiff(a, kCull, b, kCull);
+}
+
+DEF_TEST(RecordDiff_Same, r) {
+    REPORTER_ASSERT(r, diff(Scene(), Scene()).isEmpty());
+
+    Scene blurred;
+    blurred.buttonFilter = SkImageFilters::Blur(5, 5, nullptr);
+    REPORTER_ASSERT(r, diff(blurred, blurred).isEmpty());
+}
+
+DEF_TEST(RecordDiff_ChangedOp, r) {
+    Scene recolored;
+    recolored.buttonColor = SK_ColorYELLOW;
+    REPORTER_ASSERT(r, diff(Scene(), recolored) == SkRect::MakeXYWH(110, 10, 30, 30));
+
+    // Both where the button was, and where it is now.
+    Scene moved;
+    moved.buttonX = 120;
+    REPORTER_ASSERT(r, diff(Scene(), moved) == SkRect::MakeXYWH(110, 10, 50, 30));
+}
+
+DEF_TEST(RecordDiff_InsertedOp, r) {
+    Scene extra;
+    extra.extraButton = true;
+    REPORTER_ASSERT(r, diff(Scene(), extra) == SkRect::MakeXYWH(160, 10, 30, 30));
+    REPORTER_ASSERT(r, diff(extra, Scene()) == SkRect::MakeXYWH(160, 10, 30, 30));
+}
+
+DEF_TEST(RecordDiff_ChangedState, r) {
+    SkRecord a, b;
+    for (SkScalar dx : { 10, 20 }) {
+        SkRecorder canvas(dx == 10 ? &a : &b, W, H);
+        canvas.translate(dx, 0);
+        canvas.drawRect(SkRect::MakeWH(30, 30), SkPaint());
+        canvas.drawRect(SkRect::MakeXYWH(100, 0, 30, 30), SkPaint());
+    }
+    // The draws are equal, but they're drawn with different matrices, so they all move.
+    REPORTER_ASSERT(r, SkRecordDiff(a, kCull, b, kCull) == SkRect::MakeXYWH(10, 0, 140, 30));
+}
+
+DEF_TEST(RecordDiff_LayerEffects, r) {
+    Scene before, after;
+    before.buttonFilter = after.buttonFilter = SkImageFilters::Blur(5, 5, nullptr);
+    after.buttonColor = SK_ColorYELLOW;
+
+    // The blur spreads the change beyond the button.
+    SkRect damage = diff(before, after);
+    REPORTER_ASSERT(r, damage.contains(SkRect::MakeXYWH(110, 10, 30, 30).makeOutset(10, 10)));
+    REPORTER_ASSERT(r, !SkRect::Intersects(damage, SkRect::MakeXYWH(0, 500, 100, 100)));
+
+    // Effects compare by identity, so an equivalent filter still redraws the whole layer.
+    after = before;
+    after.buttonFilter = SkImageFilters::Blur(5, 5, nullptr);
+    damage = diff(before, after);
+    REPORTER_ASSERT(r, damage.contains(SkRect::MakeXYWH(10, 10, 230, 30)));
+}
+
+DEF_TEST(RecordDiff_DifferentCull, r) {
+    SkRecord a, b;
+    record_scene(&a, Scene());
+    record_scene(&b, Scene());
+    REPORTER_ASSERT(r, SkRecordDiff(a, kCull, b, SkRect::MakeWH(W, H + 10))
+                       == SkRect::MakeWH(W, H + 10));
+}
+
+DEF_TEST(RecordDiff_BackdropLayer, r) {
+    const sk_sp<SkImageFilter> blur = SkImageFilters::Blur(5, 5, nullptr);
+    struct Frosted {
+        SkColor beneath   = SK_ColorBLUE;
+        SkColor above     = SK_ColorRED;
+        SkRect  bounds    = SkRect::MakeWH(200, 200);
+        bool    hasBounds = true;
+    };
+    // A rect, a layer blurring part of it, and a rect drawn after that.
+    auto record = [&](SkRecord* record, const Frosted& scene) {
+        SkRecorder canvas(record, W, H);
+        SkPaint paint;
+        paint.setColor(scene.beneath);
+        canvas.drawRect(SkRect::MakeWH(100, 100), paint);
+        canvas.save();
+        canvas.translate(50, 50);
+        canvas.saveLayer({scene.hasBounds ? &scene.bounds : nullptr, nullptr, blur.get(), 0});
+        canvas.restore();
+        canvas.restore();
+        paint.setColor(scene.above);
+        canvas.drawRect(SkRect::MakeXYWH(300, 300, 10, 10), paint);
+    };
+    auto diff = [&](const Frosted& before, const Frosted& after) {
+        SkRecord a, b;
+        record(&a, before);
+        record(&b, after);
+        return SkRecordDiff(a, kCull, b, kCull);
+    };
+
+    Frosted before;
+    REPORTER_ASSERT(r, diff(before, before).isEmpty());
+
+    // Changing what's beneath the layer changes what it blurs.
+    Frosted after = before;
+    after.beneath = SK_ColorYELLOW;
+    REPORTER_ASSERT(r, diff(before, after) == SkRect::MakeWH(250, 250));
+
+    // Changing what's drawn after it doesn't.
+    after = before;
+    after.above = SK_ColorYELLOW;
+    REPORTER_ASSERT(r, diff(before, after) == SkRect::MakeXYWH(300, 300, 10, 10));
+
+    // A layer that changed draws where it was and where it is, though nothing is drawn in it.
+    after = before;
+    after.bounds = SkRect::MakeXYWH(100, 0, 200, 200);
+    REPORTER_ASSERT(r, diff(before, after) == SkRect::MakeXYWH(50, 50, 300, 200));
+
+    // Without bounds, it may fill the whole clip.
+    before.hasBounds = false;
+    after = before;
+    after.beneath = SK_ColorYELLOW;
+    REPORTER_ASSERT(r, diff(before, after) == kCull);
+}
@@ -8,14 +8,19 @@
 #include "tests/RecordTestUtils.h"
 #include "tests/Test.h"
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkTextBlob.h"
 #include "include/effects/SkImageFilters.h"
+#include "include/utils/SkNoDrawCanvas.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordOpts.h"
 #include "src/core/SkRecorder.h"
 #include "src/core/SkRecords.h"
+#include "src/core/SkTextBlobPriv.h"
 
 static const int W = 1920, H = 1080;
 
@@ -347,6 +352,203 @@ DEF_TEST(RecordOpts_MergeSvgOpacityAndFilterLayers, r) {
     index += 4;
 }
 
+static sk_sp<SkImage> make_batch_image(SkColor color) {
+    auto surface = SkSurface::MakeRasterN32Premul(8, 8);
+    surface->getCanvas()->clear(color);
+    return surface->makeImageSnapshot();
+}
+
+DEF_TEST(RecordOpts_BatchImageRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    sk_sp<SkImage> red  = make_batch_image(SK_ColorRED),
+                   blue = make_batch_image(SK_ColorBLUE);
+    SkPaint paint;
+    paint.setAlphaf(0.5f);
+    SkPaint other;
+    other.setAlphaf(0.25f);
+
+    recorder.drawImageRect(red,  SkRect::MakeXYWH( 0, 0, 10, 10), &paint);
+    recorder.drawImageRect(blue, SkRect::MakeXYWH(10, 0, 10, 10), &paint);
+    recorder.drawImageRect(red,  SkRect::MakeXYWH(20, 0, 10, 10), &paint);
+    recorder.drawImageRect(blue, SkRect::MakeXYWH(30, 0, 10, 10), &other);  // Different paint.
+    recorder.drawRect(SkRect::MakeWH(10, 10), paint);                       // Breaks the run.
+    recorder.drawImageRect(red,  SkRect::MakeXYWH(40, 0, 10, 10), nullptr);
+    recorder.drawImageRect(blue, SkRect::MakeXYWH(50, 0, 10, 10), nullptr);
+
+    SkRecordBatchDraws(&record);
+
+    auto set = assert_type<SkRecords::DrawEdgeAAImageSet>(r, record, 0);
+    REPORTER_ASSERT(r, set->count == 3);
+    REPORTER_ASSERT(r, set->paint && set->paint->getAlphaf() == 0.5f);
+    REPORTER_ASSERT(r, set->set[1].fImage == blue);
+    REPORTER_ASSERT(r, set->set[2].fDstRect == SkRect::MakeXYWH(20, 0, 10, 10));
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 2);
+    assert_type<SkRecords::DrawImageRect>(r, record, 3);
+    assert_type<SkRecords::DrawRect>(r, record, 4);
+    set = assert_type<SkRecords::DrawEdgeAAImageSet>(r, record, 5);
+    REPORTER_ASSERT(r, set->count == 2);
+    REPORTER_ASSERT(r, !set->paint);
+    assert_type<SkRecords::NoOp>(r, record, 6);
+
+    // Image filters apply to each draw as a whole, so those draws are left alone.
+    SkRecord filtered;
+    SkRecorder filteredRecorder(&filtered, W, H);
+    SkPaint blur;
+    blur.setImageFilter(SkImageFilters::Blur(2, 2, nullptr));
+    filteredRecorder.drawImageRect(red,  SkRect::MakeXYWH( 0, 0, 10, 10), &blur);
+    filteredRecorder.drawImageRect(blue, SkRect::MakeXYWH(10, 0, 10, 10), &blur);
+    SkRecordBatchDraws(&filtered);
+    REPORTER_ASSERT(r, 2 == count_instances_of_type<SkRecords::DrawImageRect>(filtered));
+}
+
+DEF_TEST(RecordOpts_BatchImageRectsDrawsTheSame, r) {
+    sk_sp<SkImage> red  = make_batch_image(SK_ColorRED),
+                   blue = make_batch_image(SK_ColorBLUE);
+
+    auto draw = [&](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setAlphaf(0.75f);
+        paint.setFilterQuality(kLow_SkFilterQuality);
+        for (int i = 0; i < 16; i++) {
+            const SkRect src = SkRect::MakeXYWH(i % 4, 0, 4, 8),
+                         dst = SkRect::MakeXYWH(i * 6.5f, i * 3.25f, 13, 11);
+            canvas->drawImageRect(i & 1 ? blue : red, src, dst, &paint);
+        }
+    };
+
+    SkPictureRecorder recorder;
+    draw(recorder.beginRecording(SkRect::MakeWH(128, 64), nullptr,
+                                 SkPictureRecorder::kBatchDraws_RecordFlag));
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    REPORTER_ASSERT(r, picture->approximateOpCount() == 1);
+
+    auto expected = SkSurface::MakeRasterN32Premul(128, 64),
+         actual   = SkSurface::MakeRasterN32Premul(128, 64);
+    draw(expected->getCanvas());
+    actual->getCanvas()->drawPicture(picture);
+
+    SkBitmap a, b;
+    a.allocPixels(SkImageInfo::MakeN32Premul(128, 64));
+    b.allocPixels(SkImageInfo::MakeN32Premul(128, 64));
+    expected->readPixels(a.pixmap(), 0, 0);
+    actual  ->readPixels(b.pixmap(), 0, 0);
+    REPORTER_ASSERT(r, 0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()));
+}
+
+// Batching is opt-in, and skipped when recording with a BBH: a batch is one entry in the BBH, so
+// playing back part of the picture would draw every image in it.
+DEF_TEST(RecordOpts_BatchDrawsKeepBBHCulling, r) {
+    struct CountingCanvas : public SkNoDrawCanvas {
+        CountingCanvas() : SkNoDrawCanvas(W, H) {}
+
+        void onDrawImageRect(const SkImage*, const SkRect*, const SkRect&, const SkPaint*,
+                             SrcRectConstraint) override {
+            fImages++;
+        }
+        void onDrawEdgeAAImageSet(const ImageSetEntry[], int count, const SkPoint[],
+                                  const SkMatrix[], const SkPaint*, SrcRectConstraint) override {
+            fImages += count;
+        }
+
+        int fImages = 0;
+    };
+
+    sk_sp<SkImage> red = make_batch_image(SK_ColorRED);
+    auto record = [&](SkBBHFactory* factory) {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(W, H), factory,
+                                                   SkPictureRecorder::kBatchDraws_RecordFlag);
+        for (int i = 0; i < 16; i++) {
+            canvas->drawImageRect(red, SkRect::MakeXYWH(i * 100, 0, 50, 50), nullptr);
+        }
+        return recorder.finishRecordingAsPicture();
+    };
+
+    // Without a BBH the images are batched, and SkRecordOptimize() alone leaves them be.
+    REPORTER_ASSERT(r, record(nullptr)->approximateOpCount() == 1);
+    {
+        SkRecord plain;
+        SkRecorder recorder(&plain, W, H);
+        recorder.drawImageRect(red, SkRect::MakeXYWH(  0, 0, 50, 50), nullptr);
+        recorder.drawImageRect(red, SkRect::MakeXYWH(100, 0, 50, 50), nullptr);
+        SkRecordOptimize(&plain);
+        REPORTER_ASSERT(r, 2 == count_instances_of_type<SkRecords::DrawImageRect>(plain));
+    }
+
+    // With one, drawing a single image's area only draws that image.
+    SkRTreeFactory factory;
+    sk_sp<SkPicture> picture = record(&factory);
+    REPORTER_ASSERT(r, picture->approximateOpCount() == 16);
+
+    CountingCanvas canvas;
+    canvas.clipRect(SkRect::MakeXYWH(310, 10, 20, 20));
+    picture->playback(&canvas);
+    REPORTER_ASSERT(r, canvas.fImages == 1, "%d", canvas.fImages);
+}
+
+static sk_sp<SkTextBlob> make_batch_blob(SkGlyphID glyph) {
+    SkFont font;
+    SkTextBlobBuilder builder;
+    const auto& run = builder.allocRunPosH(font, 2, 5);
+    run.glyphs[0] = run.glyphs[1] = glyph;
+    run.pos[0] = 0;
+    run.pos[1] = 10;
+    const auto& full = builder.allocRunPos(font, 1);
+    full.glyphs[0] = glyph;
+    full.points()[0] = {20, 7};
+    return builder.make();
+}
+
+DEF_TEST(RecordOpts_BatchTextBlobs, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    recorder.drawTextBlob(make_batch_blob(1), 100, 200, paint);
+    recorder.drawTextBlob(make_batch_blob(2), 300, 400, paint);
+    paint.setColor(SK_ColorRED);
+    recorder.drawTextBlob(make_batch_blob(3),   0,   0, paint);
+
+    SkRecordBatchDraws(&record);
+
+    auto draw = assert_type<SkRecords::DrawTextBlob>(r, record, 0);
+    REPORTER_ASSERT(r, draw->x == 0 && draw->y == 0);
+    REPORTER_ASSERT(r, draw->paint.getColor() == SK_ColorBLUE);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::DrawTextBlob>(r, record, 2);
+
+    struct Expected {
+        SkTextBlobRunIterator::GlyphPositioning positioning;
+        SkGlyphID glyph;
+        SkPoint   pos;
+    };
+    const Expected expected[] = {
+        {SkTextBlobRunIterator::kHorizontal_Positioning, 1, {100, 205}},
+        {SkTextBlobRunIterator::kFull_Positioning,       1, {120, 207}},
+        {SkTextBlobRunIterator::kHorizontal_Positioning, 2, {300, 405}},
+        {SkTextBlobRunIterator::kFull_Positioning,       2, {320, 407}},
+    };
+    int i = 0;
+    for (SkTextBlobRunIterator it(draw->blob.get()); !it.done(); it.next(), i++) {
+        if (i >= (int)SK_ARRAY_COUNT(expected)) {
+            break;
+        }
+        REPORTER_ASSERT(r, it.positioning() == expected[i].positioning);
+        REPORTER_ASSERT(r, it.glyphs()[0] == expected[i].glyph);
+        if (it.positioning() == SkTextBlobRunIterator::kHorizontal_Positioning) {
+            REPORTER_ASSERT(r, it.pos()[0] == expected[i].pos.x());
+            REPORTER_ASSERT(r, it.offset().y() == expected[i].pos.y());
+        } else {
+            REPORTER_ASSERT(r, it.points()[0] == expected[i].pos);
+        }
+    }
+    REPORTER_ASSERT(r, i == (int)SK_ARRAY_COUNT(expected));
+}
+
 static void do_draw(SkCanvas* canvas, SkColor color, bool doLayer) {
     canvas->drawColor(SK_ColorWHITE);
 
@@ -9,6 +9,8 @@
 #include "include/core/SkFont.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkTo.h"
@@ -134,4 +136,96 @@ SHAPER_TEST(vai)
 //SHAPER_TEST(tamil)
 #undef SHAPER_TEST
 
+namespace {
+sk_sp<SkData> shape_to_blob_data(const SkShaper* shaper, const SkData* text, SkPoint offset,
+                                 SkScalar width, bool useIterators) {
+    const char* utf8 = (const char*)text->data();
+    SkFont font(SkTypeface::MakeDefault());
+    SkTextBlobBuilderRunHandler handler(utf8, offset);
+    if (useIterators) {
+        constexpr SkFourByteTag latn = SkSetFourByteTag('l','a','t','n');
+        auto fontIterator = SkShaper::TrivialFontRunIterator(font, text->size());
+        auto bidiIterator = SkShaper::TrivialBiDiRunIterator(0, text->size());
+        auto scriptIterator = SkShaper::TrivialScriptRunIterator(latn, text->size());
+        auto languageIterator = SkShaper::TrivialLanguageRunIterator("en-US", text->size());
+        shaper->shape(utf8, text->size(), fontIterator, bidiIterator, scriptIterator,
+                      languageIterator, width, &handler);
+    } else {
+        shaper->shape(utf8, text->size(), font, true, width, &handler);
+    }
+    sk_sp<SkTextBlob> blob = handler.makeBlob();
+    return blob ? blob->serialize(SkSerialProcs()) : SkData::MakeEmpty();
+}
+}  // namespace
+
+DEF_TEST(Shaper_cache, r) {
+    auto data = GetResourceAsData("text/english.txt");
+    if (!data) {
+        ERRORF(r, "Could not get resource text/english.txt.");
+        return;
+    }
+
+    sk_sp<SkShaperCache> cache = SkShaperCache::Make();
+    std::unique_ptr<SkShaper> shaper = SkShaper::Make(),
+                              cached = SkShaper::MakeCached(SkShaper::Make(), cache);
+
+    for (bool useIterators : {false, true}) {
+        auto expected = shape_to_blob_data(shaper.get(), data.get(), {0, 0}, 400, useIterators);
+        SkShaperCache::Stats before = cache->stats();
+
+        // The first time misses, and after that the result comes from the cache, wherever the
+        // text is put.
+        for (SkPoint offset : {SkPoint{0, 0}, SkPoint{0, 0}, SkPoint{10, 20}}) {
+            auto actual = shape_to_blob_data(cached.get(), data.get(), offset, 400, useIterators);
+            auto expectedHere = offset.isZero()
+                    ? expected
+                    : shape_to_blob_data(shaper.get(), data.get(), offset, 400, useIterators);
+            REPORTER_ASSERT(r, actual->equals(expectedHere.get()));
+        }
+        SkShaperCache::Stats after = cache->stats();
+        REPORTER_ASSERT(r, after.fMisses == before.fMisses + 1);
+        REPORTER_ASSERT(r, after.fHits == before.fHits + 2);
+        REPORTER_ASSERT(r, after.fCount == before.fCount + 1);
+
+        // A different width is a different result.
+        auto narrow = shape_to_blob_data(cached.get(), data.get(), {0, 0}, 200, useIterators);
+        REPORTER_ASSERT(r, narrow->equals(
+                shape_to_blob_data(shaper.get(), data.get(), {0, 0}, 200, useIterators).get()));
+        REPORTER_ASSERT(r, cache->stats().fMisses == after.fMisses + 1);
+    }
+
+    cache->purgeAll();
+    REPORTER_ASSERT(r, cache->stats().fCount == 0);
+    REPORTER_ASSERT(r, cache->stats().fBytesUsed == 0);
+}
+
+DEF_TEST(Shaper_cache_budget, r) {
+    auto data = GetResourceAsData("text/english.txt");
+    if (!data) {
+        ERRORF(r, "Could not get resource text/english.txt.");
+        return;
+    }
+
+    // Find out how big one result is, and allow for two and a half of them.
+    sk_sp<SkShaperCache> probe = SkShaperCache::Make();
+    std::unique_ptr<SkShaper> shaper = SkShaper::MakeCached(SkShaper::Make(), probe);
+    shape_to_blob_data(shaper.get(), data.get(), {0, 0}, 400, false);
+    size_t resultSize = probe->stats().fBytesUsed;
+    REPORTER_ASSERT(r, resultSize > 0);
+
+    sk_sp<SkShaperCache> cache = SkShaperCache::Make(resultSize * 5 / 2);
+    shaper = SkShaper::MakeCached(SkShaper::Make(), cache);
+    for (SkScalar width : {400, 401, 402, 403}) {
+        shape_to_blob_data(shaper.get(), data.get(), {0, 0}, width, false);
+        REPORTER_ASSERT(r, cache->stats().fBytesUsed <= resultSize * 5 / 2);
+    }
+    REPORTER_ASSERT(r, cache->stats().fCount == 2);
+
+    // The oldest were dropped; the newest are still there.
+    shape_to_blob_data(shaper.get(), data.get(), {0, 0}, 403, false);
+    REPORTER_ASSERT(r, cache->stats().fHits == 1);
+    shape_to_blob_data(shaper.get(), data.get(), {0, 0}, 400, false);
+    REPORTER_ASSERT(r, cache->stats().fHits == 1);
+}
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
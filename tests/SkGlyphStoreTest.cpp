@@ -0,0 +1,127 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkStream.h"
+#include "src/core/SkGlyphStore.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeSpec.h"
+#include "src/utils/SkOSPath.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstdio>
+#include <vector>
+
+static SkStrikeSpec make_strike_spec(const char* family) {
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(ToolUtils::create_portable_typeface(family, SkFontStyle()));
+    font.setSize(24);
+    return SkStrikeSpec::MakeMask(font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                  SkScalerContextFlags::kNone, SkMatrix::I());
+}
+
+static const SkGlyphID kGlyphIDs[] = { 3, 4, 5, 6 };
+
+// The images of kGlyphIDs end to end, after their widths and heights.
+static std::vector<uint8_t> draw_glyphs(SkStrike* strike) {
+    SkPackedGlyphID packedIDs[SK_ARRAY_COUNT(kGlyphIDs)];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kGlyphIDs); i++) {
+        packedIDs[i] = SkPackedGlyphID{kGlyphIDs[i]};
+    }
+    const SkGlyph* glyphs[SK_ARRAY_COUNT(kGlyphIDs)];
+    strike->prepareImages(SkMakeSpan(packedIDs), glyphs);
+
+    std::vector<uint8_t> pixels;
+    for (const SkGlyph* glyph : glyphs) {
+        pixels.push_back(glyph->width());
+        pixels.push_back(glyph->height());
+        if (const uint8_t* image = static_cast<const uint8_t*>(glyph->image())) {
+            pixels.insert(pixels.end(), image, image + glyph->imageSize());
+        }
+    }
+    return pixels;
+}
+
+DEF_TEST(SkGlyphStore_RoundTrip, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "glyph_store_test");
+    std::remove(path.c_str());
+
+    SkStrikeSpec serif = make_strike_spec("serif"),
+                 sans  = make_strike_spec("sans-serif");
+
+    // The first run draws the glyphs, and saves them when it purges the cache.
+    std::vector<uint8_t> expected;
+    {
+        SkStrikeCache cache;
+        cache.setGlyphStore(SkGlyphStore::Make(path.c_str()));
+        expected = draw_glyphs(serif.findOrCreateStrike(&cache).get());
+        cache.purgeAll();
+        REPORTER_ASSERT(reporter, cache.glyphStore()->countStrikes() == 1);
+        REPORTER_ASSERT(reporter, sk_exists(path.c_str()));
+    }
+
+    // The next starts with them.
+    SkStrikeCache cache;
+    cache.setGlyphStore(SkGlyphStore::Make(path.c_str()));
+    REPORTER_ASSERT(reporter, cache.glyphStore()->countStrikes() == 1);
+
+    sk_sp<SkStrike> strike = serif.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(reporter,
+                    strike->fScalerCache.countCachedGlyphs() == SK_ARRAY_COUNT(kGlyphIDs));
+    REPORTER_ASSERT(reporter, draw_glyphs(strike.get()) == expected);
+
+    // Other typefaces don't match the saved strike.
+    REPORTER_ASSERT(reporter, sans.findOrCreateStrike(&cache)->fScalerCache.countCachedGlyphs()
+                              == 0);
+
+    std::remove(path.c_str());
+}
+
+DEF_TEST(SkGlyphStore_BadFile, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "glyph_store_bad_test");
+    SkStrikeSpec serif = make_strike_spec("serif");
+
+    {
+        std::remove(path.c_str());
+        SkStrikeCache cache;
+        cache.setGlyphStore(SkGlyphStore::Make(path.c_str()));
+        draw_glyphs(serif.findOrCreateStrike(&cache).get());
+        cache.purgeAll();
+    }
+    // Read a copy, rather than mapping the file we're about to overwrite.
+    SkFILEStream goodStream{path.c_str()};
+    sk_sp<SkData> good = SkData::MakeFromStream(&goodStream, goodStream.getLength());
+    REPORTER_ASSERT(reporter, good && good->size() > 16);
+    if (!good || good->size() <= 16) {
+        return;
+    }
+
+    // Truncated files, and files that aren't glyph stores, are ignored.
+    for (size_t size : { good->size() / 2, good->size() - 4, (size_t)4, (size_t)0 }) {
+        {
+            SkFILEWStream stream{path.c_str()};
+            stream.write(good->data(), size);
+        }
+        SkStrikeCache cache;
+        cache.setGlyphStore(SkGlyphStore::Make(path.c_str()));
+        REPORTER_ASSERT(reporter, cache.glyphStore()->countStrikes() == 0);
+        REPORTER_ASSERT(reporter,
+                        serif.findOrCreateStrike(&cache)->fScalerCache.countCachedGlyphs() == 0);
+    }
+
+    std::remove(path.c_str());
+}
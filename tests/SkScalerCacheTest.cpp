@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkTypeface.h"
 #include "src/core/SkScalerCache.h"
@@ -13,7 +14,9 @@
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 
 class Barrier {
 public:
@@ -83,3 +86,62 @@ DEF_TEST(SkScalerCacheMultiThread, Reporter) {
         SkTaskGroup(*executor).batch(kThreadCount, perThread);
     }
 }
+
+DEF_TEST(SkScalerCache_PrepareImagesBatch, reporter) {
+    sk_sp<SkTypeface> typeface = ToolUtils::create_portable_typeface("serif", SkFontStyle());
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(typeface);
+    font.setSize(24);
+
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    auto make_cache = [&]() {
+        return std::make_unique<SkScalerCache>(
+                strikeSpec.descriptor(),
+                typeface->createScalerContext(SkScalerContextEffects{}, &strikeSpec.descriptor()));
+    };
+
+    // Every glyph is repeated.
+    static constexpr int kGlyphCount = 256;
+    int uniqueCount = std::min(typeface->countGlyphs(), kGlyphCount / 2);
+    SkPackedGlyphID packedIDs[kGlyphCount];
+    for (int i = 0; i < kGlyphCount; i++) {
+        packedIDs[i] = SkPackedGlyphID{SkTo<SkGlyphID>(i % uniqueCount)};
+    }
+
+    // One at a time.
+    auto expectedCache = make_cache();
+    const SkGlyph* expected[kGlyphCount];
+    for (int i = 0; i < kGlyphCount; i++) {
+        expectedCache->prepareImages(SkMakeSpan(&packedIDs[i], 1), &expected[i]);
+    }
+
+    auto cache = make_cache();
+    const SkGlyph* glyphs[kGlyphCount];
+    auto [span, delta] = cache->prepareImages(SkMakeSpan(packedIDs), glyphs);
+    REPORTER_ASSERT(reporter, span.size() == kGlyphCount);
+    REPORTER_ASSERT(reporter, delta > 0);
+    REPORTER_ASSERT(reporter, cache->countCachedGlyphs() == uniqueCount);
+
+    for (int i = 0; i < kGlyphCount; i++) {
+        const SkGlyph* glyph = glyphs[i];
+        REPORTER_ASSERT(reporter, glyph->getPackedID() == packedIDs[i]);
+        REPORTER_ASSERT(reporter, glyph == glyphs[i % uniqueCount]);
+        REPORTER_ASSERT(reporter, glyph->setImageHasBeenCalled());
+        REPORTER_ASSERT(reporter, glyph->iRect() == expected[i]->iRect());
+        REPORTER_ASSERT(reporter, glyph->advanceX() == expected[i]->advanceX());
+        if (glyph->image() != nullptr && expected[i]->image() != nullptr) {
+            REPORTER_ASSERT(reporter, glyph->imageSize() == expected[i]->imageSize());
+            REPORTER_ASSERT(reporter, 0 == memcmp(glyph->image(), expected[i]->image(),
+                                                  glyph->imageSize()));
+        } else {
+            REPORTER_ASSERT(reporter, glyph->image() == expected[i]->image());
+        }
+    }
+
+    // Everything is cached now, so asking again adds nothing.
+    auto [_, again] = cache->prepareImages(SkMakeSpan(packedIDs), glyphs);
+    REPORTER_ASSERT(reporter, again == 0);
+}
@@ -7,9 +7,12 @@
 
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -51,3 +54,72 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+static std::vector<SkStrikeSpec> make_strike_specs(int count) {
+    sk_sp<SkTypeface> typeface =
+            ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setTypeface(typeface);
+
+    std::vector<SkStrikeSpec> specs;
+    SkPaint defaultPaint;
+    for (int i = 0; i < count; i++) {
+        font.setSize(8 + i);
+        specs.push_back(SkStrikeSpec::MakeMask(
+                font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I()));
+    }
+    return specs;
+}
+
+DEF_TEST(SkStrikeCache_Sharded, Reporter) {
+    std::vector<SkStrikeSpec> specs = make_strike_specs(64);
+
+    SkStrikeCache cache{4};
+    REPORTER_ASSERT(Reporter, cache.shardCount() == 4);
+
+    // Strikes are found again, whichever shard they landed in.
+    for (const SkStrikeSpec& spec : specs) {
+        sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+        REPORTER_ASSERT(Reporter, spec.findOrCreateStrike(&cache) == strike);
+    }
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 64);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() > 0);
+
+    // Lowering the limits purges every shard that's over its share, not just the one last used.
+    cache.setCacheCountLimit(16);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 16);
+    size_t limit = cache.getTotalMemoryUsed() / 2;
+    cache.setCacheSizeLimit(limit);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() <= limit);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
+
+DEF_TEST(SkStrikeCache_ShardedThreads, Reporter) {
+    std::vector<SkStrikeSpec> specs = make_strike_specs(64);
+
+    // Keep the count limit small enough that the threads keep purging each other's strikes.
+    SkStrikeCache cache{4};
+    cache.setCacheCountLimit(32);
+
+    SkTaskGroup().batch(8, [&](int thread) {
+        for (int i = 0; i < 256; i++) {
+            const SkStrikeSpec& spec = specs[(thread * 7 + i) % specs.size()];
+            sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+            SkGlyphID glyphID = 3;
+            const SkGlyph* glyph;
+            strike->metrics(SkSpan<const SkGlyphID>{&glyphID, 1}, &glyph);
+        }
+    });
+
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 32);
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
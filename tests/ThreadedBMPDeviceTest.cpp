@@ -0,0 +1,288 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkSurface.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/effects/SkImageFilters.h"
+#include "include/utils/SkRandom.h"
+#include "src/core/SkDraw.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+
+static void draw_scene(SkCanvas* canvas) {
+    SkPaint paint;
+    canvas->drawColor(SK_ColorWHITE);
+
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect({10, 10, 700, 90}, paint);
+
+    paint.setAntiAlias(true);
+    paint.setColor(0x8000FF00);
+    canvas->drawCircle(300, 300, 220.5f, paint);
+
+    SkPath path;
+    path.moveTo(20, 600);
+    path.cubicTo(200, 100, 500, 900, 780, 300);
+    path.lineTo(600, 700);
+    path.close();
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(7);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawPath(path, paint);
+    paint.setStyle(SkPaint::kFill_Style);
+
+    // An inverse fill has no bounds to limit it, so every band draws it.
+    SkPath inverse;
+    inverse.addCircle(640, 640, 90);
+    inverse.setFillType(SkPathFillType::kInverseWinding);
+    canvas->save();
+    canvas->clipRect({520, 420, 790, 790});
+    paint.setColor(0x60FF8000);
+    canvas->drawPath(inverse, paint);
+    canvas->restore();
+
+    const SkPoint pts[] = {{0, 0}, {800, 800}};
+    const SkColor colors[] = {SK_ColorYELLOW, SK_ColorMAGENTA};
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+    canvas->save();
+    canvas->clipRRect(SkRRect::MakeRectXY({250, 250, 770, 770}, 60, 60), true);
+    canvas->rotate(10);
+    canvas->drawRRect(SkRRect::MakeRectXY({200, 200, 760, 640}, 30, 30), paint);
+    canvas->restore();
+    paint.setShader(nullptr);
+
+    SkBitmap bm;
+    bm.allocN32Pixels(40, 30);
+    bm.eraseColor(0xFF336699);
+    bm.setImmutable();
+    canvas->drawImageRect(SkImage::MakeFromBitmap(bm), SkRect::MakeXYWH(500, 20, 290, 230),
+                          nullptr);
+
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    paint.setColor(SK_ColorBLACK);
+    canvas->drawOval({100, 500, 500, 780}, paint);
+    canvas->restore();
+
+    const SkPoint points[] = {{5, 795}, {790, 5}, {400, 400}};
+    paint.setStrokeWidth(0);
+    canvas->drawPoints(SkCanvas::kPolygon_PointMode, 3, points, paint);
+}
+
+static void check_matches_serial(skiatest::Reporter* reporter, const SkImageInfo& info,
+                                 SkScalar dx) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    auto serial   = SkSurface::MakeRaster(info);
+    auto threaded = SkSurface::MakeRasterThreaded(info, executor.get());
+    REPORTER_ASSERT(reporter, serial && threaded);
+
+    for (SkSurface* surface : {serial.get(), threaded.get()}) {
+        surface->getCanvas()->translate(dx, 0);
+        draw_scene(surface->getCanvas());
+    }
+
+    // Reading back must rasterize any deferred draws without an explicit flush.
+    SkBitmap a, b;
+    a.allocPixels(info);
+    b.allocPixels(info);
+    REPORTER_ASSERT(reporter, serial->readPixels(a, 0, 0));
+    REPORTER_ASSERT(reporter, threaded->readPixels(b, 0, 0));
+    for (int y = 0; y < info.height(); y++) {
+        if (0 != memcmp(a.getAddr32(0, y), b.getAddr32(0, y), info.minRowBytes())) {
+            ERRORF(reporter, "Threaded raster output differs from serial at row %d", y);
+            break;
+        }
+    }
+}
+
+DEF_TEST(ThreadedBMPDevice_MatchesSerial, reporter) {
+    check_matches_serial(reporter, SkImageInfo::MakeN32Premul(800, 800), 0);
+}
+
+// Devices wider than 8191 are drawn through SkDrawTiler; straddle its first tile edge.
+DEF_TEST(ThreadedBMPDevice_MatchesSerial_Large, reporter) {
+    check_matches_serial(reporter, SkImageInfo::MakeN32Premul(8600, 800), 7800);
+}
+
+// Small antialiased paths are drawn through masks rounded to a quarter pixel, which are cached
+// from a path's second draw on. Every band a path straddles must draw it the same way, even
+// while the first of them is the path's first draw.
+DEF_TEST(ThreadedBMPDevice_CachedPathMask, reporter) {
+    SkPath path;
+    path.moveTo(0, 0).lineTo(40, 10).lineTo(15, 45).close();
+    path.addCircle(20, 20, 9);
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(200, 256);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    auto threaded = SkSurface::MakeRasterThreaded(info, executor.get());
+    auto serial   = SkSurface::MakeRaster(info);
+    REPORTER_ASSERT(reporter, serial && threaded);
+
+    SkBitmap bitmaps[2];
+    SkSurface* surfaces[2] = {threaded.get(), serial.get()};
+    for (int i = 0; i < 2; i++) {
+        SkCanvas* canvas = surfaces[i]->getCanvas();
+        canvas->drawColor(SK_ColorWHITE);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        // Straddle the boundary between the first two bands, at 128 rows.
+        for (SkScalar dx : {10.3f, 60.6f, 110.1f}) {
+            canvas->save();
+            canvas->translate(dx, 105.4f);
+            canvas->drawPath(path, paint);
+            canvas->restore();
+        }
+
+        bitmaps[i].allocPixels(info);
+        REPORTER_ASSERT(reporter, surfaces[i]->readPixels(bitmaps[i], 0, 0));
+    }
+
+    for (int y = 0; y < info.height(); y++) {
+        if (0 != memcmp(bitmaps[0].getAddr32(0, y), bitmaps[1].getAddr32(0, y),
+                        info.minRowBytes())) {
+            ERRORF(reporter, "Threaded path mask differs from serial at row %d", y);
+            break;
+        }
+    }
+}
+
+// Huge paths skip the queue and are scan converted in bands, with their edges chopped at band
+// boundaries. That rounds a little differently than one scan conversion, but shouldn't depend on
+// how many threads draw the bands, and draws queued around the path must still land in order.
+DEF_TEST(ThreadedBMPDevice_BigPath, reporter) {
+    // A ragged coastline around the middle of the canvas.
+    SkRandom rand;
+    SkPath path;
+    for (int i = 0; i < SkDraw::kMinBandedPathPoints; i++) {
+        SkScalar angle  = i * 2 * SK_ScalarPI / SkDraw::kMinBandedPathPoints,
+                 radius = rand.nextRangeScalar(330, 370);
+        SkPoint pt = {400 + radius * SkScalarCos(angle), 400 + radius * SkScalarSin(angle)};
+        i == 0 ? path.moveTo(pt) : path.lineTo(pt);
+    }
+    path.close();
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(800, 800);
+    std::unique_ptr<SkExecutor> oneThread  = SkExecutor::MakeFIFOThreadPool(1),
+                                fourThreads = SkExecutor::MakeFIFOThreadPool(4);
+    auto serial   = SkSurface::MakeRaster(info);
+    auto threaded = SkSurface::MakeRasterThreaded(info, fourThreads.get());
+    auto onebyone = SkSurface::MakeRasterThreaded(info, oneThread.get());
+    REPORTER_ASSERT(reporter, serial && threaded && onebyone);
+
+    SkBitmap bitmaps[3];
+    SkSurface* surfaces[3] = {serial.get(), threaded.get(), onebyone.get()};
+    for (int i = 0; i < 3; i++) {
+        SkCanvas* canvas = surfaces[i]->getCanvas();
+        SkPaint paint;
+        canvas->drawColor(SK_ColorWHITE);
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect({100, 0, 700, 800}, paint);
+        paint.setAntiAlias(true);
+        paint.setColor(0xC00000FF);
+        canvas->drawPath(path, paint);
+        paint.setColor(0x8000FF00);
+        canvas->drawCircle(400, 400, 200, paint);
+
+        bitmaps[i].allocPixels(info);
+        REPORTER_ASSERT(reporter, surfaces[i]->readPixels(bitmaps[i], 0, 0));
+    }
+
+    // Chopping an edge can move where it crosses a sample by one sample, i.e. by at most a
+    // quarter of the path's 0xC0 alpha in any channel, and only along edges.
+    int differentPixels = 0;
+    for (int y = 0; y < info.height(); y++) {
+        for (int x = 0; x < info.width(); x++) {
+            SkColor a = bitmaps[0].getColor(x, y),
+                    b = bitmaps[1].getColor(x, y);
+            if (a == b) {
+                continue;
+            }
+            differentPixels++;
+            int diff = std::max({abs((int)SkColorGetR(a) - (int)SkColorGetR(b)),
+                                 abs((int)SkColorGetG(a) - (int)SkColorGetG(b)),
+                                 abs((int)SkColorGetB(a) - (int)SkColorGetB(b))});
+            if (diff > 0xC0 / 4) {
+                ERRORF(reporter, "Banded path differs at (%d, %d): %08x vs %08x", x, y, a, b);
+                return;
+            }
+        }
+    }
+    REPORTER_ASSERT(reporter, differentPixels < info.width() * info.height() / 32,
+                    "%d", differentPixels);
+
+    for (int y = 0; y < info.height(); y++) {
+        if (0 != memcmp(bitmaps[1].getAddr32(0, y), bitmaps[2].getAddr32(0, y),
+                        info.minRowBytes())) {
+            ERRORF(reporter, "Banded path depends on thread count at row %d", y);
+            break;
+        }
+    }
+}
+
+// Large blurs split their rows and columns across the executor, and must match a serial blur
+// exactly, whether it's one thread or many that run the strips.
+DEF_TEST(ThreadedBMPDevice_BlurImageFilter, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(600, 500);
+    std::unique_ptr<SkExecutor> oneThread   = SkExecutor::MakeFIFOThreadPool(1),
+                                fourThreads = SkExecutor::MakeFIFOThreadPool(4);
+    auto serial   = SkSurface::MakeRaster(info);
+    auto threaded = SkSurface::MakeRasterThreaded(info, fourThreads.get());
+    auto onebyone = SkSurface::MakeRasterThreaded(info, oneThread.get());
+    REPORTER_ASSERT(reporter, serial && threaded && onebyone);
+
+    SkBitmap bitmaps[3];
+    SkSurface* surfaces[3] = {serial.get(), threaded.get(), onebyone.get()};
+    for (int i = 0; i < 3; i++) {
+        SkCanvas* canvas = surfaces[i]->getCanvas();
+        for (SkScalar sigma : {3.0f, 20.0f}) {
+            SkPaint layerPaint;
+            layerPaint.setImageFilter(SkImageFilters::Blur(sigma, sigma / 2, nullptr));
+            canvas->saveLayer(nullptr, &layerPaint);
+            draw_scene(canvas);
+            canvas->restore();
+        }
+
+        bitmaps[i].allocPixels(info);
+        REPORTER_ASSERT(reporter, surfaces[i]->readPixels(bitmaps[i], 0, 0));
+    }
+
+    for (int i = 1; i < 3; i++) {
+        for (int y = 0; y < info.height(); y++) {
+            if (0 != memcmp(bitmaps[0].getAddr32(0, y), bitmaps[i].getAddr32(0, y),
+                            info.minRowBytes())) {
+                ERRORF(reporter, "Threaded blur differs from serial at row %d", y);
+                break;
+            }
+        }
+    }
+}
+
+DEF_TEST(ThreadedBMPDevice_Snapshot, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(600, 300);
+    auto surface = SkSurface::MakeRasterThreaded(info, nullptr);
+    REPORTER_ASSERT(reporter, surface);
+
+    surface->getCanvas()->clear(SK_ColorGREEN);
+    sk_sp<SkImage> before = surface->makeImageSnapshot();
+
+    // Drawing after the snapshot copies on write; the snapshot must keep the old contents.
+    surface->getCanvas()->clear(SK_ColorBLUE);
+    sk_sp<SkImage> after = surface->makeImageSnapshot();
+
+    SkPixmap pm;
+    REPORTER_ASSERT(reporter, before->peekPixels(&pm));
+    REPORTER_ASSERT(reporter, pm.getColor(599, 299) == SK_ColorGREEN);
+    REPORTER_ASSERT(reporter, after->peekPixels(&pm));
+    REPORTER_ASSERT(reporter, pm.getColor(599, 299) == SK_ColorBLUE);
+}
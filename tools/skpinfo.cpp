@@ -11,6 +11,7 @@
 #include "src/core/SkFontDescriptor.h"
 #include "src/core/SkPictureCommon.h"
 #include "src/core/SkPictureData.h"
+#include "src/core/SkPicturePriv.h"
 #include "tools/flags/CommandLineFlags.h"
 
 static DEFINE_string2(input, i, "", "skp on which to report");
@@ -74,6 +75,9 @@ int main(int argc, char** argv) {
         // reading the file.
         return kSuccess;
     }
+    if (!SkPicturePriv::SkipPictureDataPadding(&stream, info.getVersion())) {
+        return kTruncatedFile;
+    }
 
     for (;;) {
         uint32_t tag;